@@ -56,7 +56,7 @@ allocator_boundary_tags::allocator_boundary_tags(
     size_t size)
 {
     size_t total_size = size + sizeof(block_metadata);
-    debug_with_guard(std::format("[*] allocating {} bytes", total_size));
+    debug_with_guard("[*] allocating {} bytes", total_size);
 
     auto& metadata = get_allocator_metadata();
 
@@ -79,8 +79,11 @@ allocator_boundary_tags::allocator_boundary_tags(
 
     if (block == nullptr)
     {
-        error_with_guard(std::format(
-            "[!] out of memory: requested {} bytes", total_size));
+        // Fires on every call once the arena is exhausted, don't let logging become the bottleneck
+        static log_rate_limiter out_of_memory_limiter(10, 10, "allocator_boundary_tags out of memory");
+        error_with_guard(out_of_memory_limiter, [total_size] {
+            return "[!] out of memory: requested " + std::to_string(total_size) + " bytes";
+        });
         throw std::bad_alloc();
     }
 
@@ -88,8 +91,7 @@ allocator_boundary_tags::allocator_boundary_tags(
 
     if (free_block_size < total_size + sizeof(block_metadata))
     {
-        warning_with_guard(std::format(
-            "[*] changing block size to {} bytes", free_block_size));
+        warning_with_guard("[*] changing block size to {} bytes", free_block_size);
         total_size = free_block_size;
     }
 
@@ -126,12 +128,10 @@ allocator_boundary_tags::allocator_boundary_tags(
         free_block->prev_->next_ = free_block;
     }
 
-    debug_with_guard(std::format(
-        "[+] allocated {} bytes at {:p}",
-        total_size, static_cast<void*>(free_block + 1)));
-    information_with_guard(std::format(
-        "[*] available memory: {}", get_available_memory()));
-    debug_with_guard(print_blocks());
+    debug_with_guard("[+] allocated {} bytes at {:p}",
+        total_size, static_cast<void*>(free_block + 1));
+    information_with_guard("[*] available memory: {}", get_available_memory());
+    debug_with_guard([this] { return print_blocks(); });
 
     return free_block + 1;
 }
@@ -146,7 +146,7 @@ inline void allocator_boundary_tags::set_first_block(void *block)
 void allocator_boundary_tags::do_deallocate_sm(
     void *at)
 {
-    debug_with_guard(std::format("[*] deallocating block {:p}", at));
+    debug_with_guard("[*] deallocating block {:p}", at);
 
     auto& metadata = get_allocator_metadata();
 
@@ -157,12 +157,11 @@ void allocator_boundary_tags::do_deallocate_sm(
 
     if (block->tm_ptr_ != _trusted_memory)
     {
-        error_with_guard(std::format(
-            "[!] block doesn't belong to this allocator: {:p}", at));
+        error_with_guard("[!] block doesn't belong to this allocator: {:p}", at);
         throw std::logic_error("unknown block");
     }
 
-    debug_with_guard(get_dump(static_cast<char*>(at), block->block_size_));
+    debug_with_guard([at, block] { return get_dump(static_cast<char*>(at), block->block_size_); });
 
     //Because this!
     // void *block_2 = static_cast<char *>(at) - occupied_block_metadata_size;
@@ -197,9 +196,8 @@ void allocator_boundary_tags::do_deallocate_sm(
 
 
     debug_with_guard("[+] block deallocated successfully");
-    information_with_guard(std::format(
-        "[*] available memory: {}", get_available_memory()));
-    debug_with_guard(print_blocks());
+    information_with_guard("[*] available memory: {}", get_available_memory());
+    debug_with_guard([this] { return print_blocks(); });
 }
 
 inline void allocator_boundary_tags::set_fit_mode(
@@ -220,8 +218,7 @@ inline void allocator_boundary_tags::set_fit_mode(
             break;
     }
 
-    debug_with_guard(std::format(
-        "[*] setting fit mode: {}", fit_mode_string));
+    debug_with_guard("[*] setting fit mode: {}", fit_mode_string);
 
     auto& metadata = get_allocator_metadata();
     std::lock_guard lock(metadata.mutex_);
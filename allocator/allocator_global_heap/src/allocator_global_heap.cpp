@@ -52,23 +52,25 @@ allocator_global_heap &allocator_global_heap::operator=(allocator_global_heap &&
 
 void* allocator_global_heap::do_allocate_sm(const size_t size)
 {
-    debug_with_guard("Starting allocation of size " + std::to_string(size));
+    debug_with_guard([size] { return "Starting allocation of size " + std::to_string(size); });
     try
     {
         void* ptr = ::operator new(size);
-        std::ostringstream oss;
-        oss << "0x" << std::hex << reinterpret_cast<std::uintptr_t>(ptr);
-        debug_with_guard("Successfully allocated memory at " + oss.str() + " of size " + std::to_string(size));
+        debug_with_guard([ptr, size] {
+            std::ostringstream oss;
+            oss << "0x" << std::hex << reinterpret_cast<std::uintptr_t>(ptr);
+            return "Successfully allocated memory at " + oss.str() + " of size " + std::to_string(size);
+        });
         return ptr;
     }
     catch (const std::bad_alloc& e)
     {
-        error_with_guard("Failed to allocate memory of size " + std::to_string(size) + ": " + std::string(e.what()));
+        error_with_guard([&e, size] { return "Failed to allocate memory of size " + std::to_string(size) + ": " + std::string(e.what()); });
         throw;
     }
     catch (const std::exception& e)
     {
-        error_with_guard("Unexpected exception during memory allocation: " + std::string(e.what()));
+        error_with_guard([&e] { return "Unexpected exception during memory allocation: " + std::string(e.what()); });
         throw;
     }
 }
@@ -81,11 +83,14 @@ void allocator_global_heap::do_deallocate_sm(void* at)
         return;
     }
     
-    std::ostringstream oss;
-    oss << "0x" << std::hex << reinterpret_cast<std::uintptr_t>(at);
-    debug_with_guard("Starting deallocation of memory at " + oss.str());
+    auto address = [at] {
+        std::ostringstream oss;
+        oss << "0x" << std::hex << reinterpret_cast<std::uintptr_t>(at);
+        return oss.str();
+    };
+    debug_with_guard([&address] { return "Starting deallocation of memory at " + address(); });
     ::operator delete(at);
-    debug_with_guard("Successfully deallocated memory at " + oss.str());
+    debug_with_guard([&address] { return "Successfully deallocated memory at " + address(); });
 }
 
 bool allocator_global_heap::do_is_equal(const std::pmr::memory_resource& other) const noexcept
@@ -0,0 +1,471 @@
+#include <big_int.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// usage: mp_os_arthmtc_bg_intgr_benchmarks [largest operand in limbs = 1000000]
+
+namespace
+{
+    big_int random_big_int(size_t limbs, std::mt19937& generator)
+    {
+        std::vector<unsigned int> digits(limbs);
+        for (auto& digit : digits)
+        {
+            digit = static_cast<unsigned int>(generator());
+        }
+        digits.back() |= 1u << 31;
+        return big_int(digits);
+    }
+
+    /** Repeats the operation until it has run for at least 200 ms and returns seconds per call
+     */
+    template<class F>
+    double measure(F&& operation)
+    {
+        using clock = std::chrono::steady_clock;
+
+        size_t iterations = 0;
+        auto started = clock::now();
+        std::chrono::duration<double> elapsed{};
+        do
+        {
+            operation();
+            ++iterations;
+            elapsed = clock::now() - started;
+        }
+        while (elapsed.count() < 0.2);
+
+        return elapsed.count() / static_cast<double>(iterations);
+    }
+
+    void print_time(std::optional<double> seconds)
+    {
+        if (seconds)
+        {
+            std::cout << std::setw(16) << std::fixed << std::setprecision(2) << *seconds * 1e6;
+        }
+        else
+        {
+            std::cout << std::setw(16) << "-";
+        }
+    }
+
+    struct counting_resource : std::pmr::memory_resource
+    {
+        size_t allocations = 0;
+
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    /** One step of a modular loop, five operations: x = (x * y + z) mod m, acc += x * y, acc -= z
+     */
+    void allocations(size_t largest)
+    {
+        // Counts every allocation, the per-thread scratch of the in-place functions included; it outlives
+        // that scratch, which is only released at thread exit
+        static counting_resource counter;
+        std::pmr::memory_resource* previous = std::pmr::set_default_resource(&counter);
+
+        std::mt19937 generator(40);
+        constexpr size_t steps = 2000;
+
+        std::cout << "allocations per operation in a loop of " << steps << " modular steps" << std::endl;
+        std::cout << std::setw(10) << "limbs" << std::setw(16) << "operators" << std::setw(16) << "in-place"
+                  << std::setw(16) << "operators, us" << std::setw(16) << "in-place, us" << std::endl;
+
+        for (size_t size = 4; size <= std::min<size_t>(largest, 4096); size *= 8)
+        {
+            const big_int m = random_big_int(size, generator);
+            const big_int y = random_big_int(size, generator) % m;
+            const big_int z = random_big_int(size, generator) % m;
+            const big_int start = random_big_int(size, generator) % m;
+
+            auto run = [&](auto&& step) {
+                const size_t before = counter.allocations;
+                const auto started = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < steps; ++i)
+                {
+                    step();
+                }
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+                return std::pair(static_cast<double>(counter.allocations - before) / (5 * steps), elapsed.count() / (5 * steps));
+            };
+
+            big_int x = start;
+            big_int acc;
+            const auto [operator_allocations, operator_time] = run([&] {
+                x = (x * y + z) % m;
+                acc += x * y;
+                acc -= z;
+            });
+
+            big_int t;
+            big_int q;
+            x = start;
+            acc = big_int();
+            const auto [in_place_allocations, in_place_time] = run([&] {
+                mul(t, x, y);
+                add(t, t, z);
+                divmod(q, x, t, m);
+                addmul(acc, x, y);
+                sub(acc, acc, z);
+            });
+
+            std::cout << std::setw(10) << size << std::setw(16) << std::setprecision(3) << operator_allocations
+                      << std::setw(16) << in_place_allocations;
+            print_time(operator_time);
+            print_time(in_place_time);
+            std::cout << std::endl;
+        }
+
+        std::pmr::set_default_resource(previous);
+    }
+
+    void linear(size_t largest)
+    {
+        std::mt19937 generator(41);
+
+        std::cout << "in-place linear operations, n and n limbs" << std::endl;
+        std::cout << std::setw(10) << "limbs" << std::setw(16) << "+=, us" << std::setw(16) << "-=, us"
+                  << std::setw(16) << "^=, us" << std::setw(16) << "<<= >>= 7, us" << std::setw(16) << "+=, ns/limb" << std::endl;
+
+        for (size_t size = 16; size <= largest; size *= 4)
+        {
+            big_int accumulator = random_big_int(size, generator);
+            const big_int operand = random_big_int(size, generator);
+
+            // None of the loops allocates once the accumulator has grown its carry limb
+            const double adding = measure([&] { accumulator += operand; });
+            const double subtracting = measure([&] { accumulator -= operand; });
+            const double masking = measure([&] { accumulator ^= operand; });
+            const double shifting = measure([&] {
+                accumulator <<= 7;
+                accumulator >>= 7;
+            });
+
+            std::cout << std::setw(10) << size;
+            print_time(adding);
+            print_time(subtracting);
+            print_time(masking);
+            print_time(shifting);
+            std::cout << std::setw(16) << std::setprecision(3) << adding * 1e9 / static_cast<double>(size) << std::endl;
+        }
+    }
+
+    void multiplication(size_t largest)
+    {
+        std::mt19937 generator(42);
+
+        std::cout << "multiplication, n x n limbs; exponent is the local slope of log(time) over log(n) for the "
+                     "fastest rule: ~1.46 for Toom-3, just above 1 for the transform" << std::endl;
+        std::cout << std::setw(10) << "limbs" << std::setw(16) << "trivial, us" << std::setw(16) << "Karatsuba, us"
+                  << std::setw(16) << "NTT, us" << std::setw(12) << "exponent" << std::endl;
+
+        double previous = 0;
+        size_t previous_size = 0;
+        for (size_t size = 8; size <= largest; size = size < 64 ? size * 2 : size * 3 / 2)
+        {
+            const big_int lhs = random_big_int(size, generator);
+            const big_int rhs = random_big_int(size, generator);
+
+            auto time = [&](big_int::multiplication_rule rule) {
+                return measure([&] {
+                    big_int product(lhs);
+                    product.multiply_assign(rhs, rule);
+                });
+            };
+
+            // Slower rules are skipped once they only confirm their asymptotics
+            std::optional<double> trivial;
+            std::optional<double> karatsuba;
+            std::optional<double> transform;
+            if (size <= 4096)
+            {
+                trivial = time(big_int::multiplication_rule::trivial);
+            }
+            if (size <= 100000)
+            {
+                karatsuba = time(big_int::multiplication_rule::Karatsuba);
+            }
+            if (size >= 256)
+            {
+                transform = time(big_int::multiplication_rule::SchonhageStrassen);
+            }
+
+            std::cout << std::setw(10) << size;
+            print_time(trivial);
+            print_time(karatsuba);
+            print_time(transform);
+
+            double fastest = std::min({trivial.value_or(INFINITY), karatsuba.value_or(INFINITY), transform.value_or(INFINITY)});
+            if (previous_size != 0)
+            {
+                std::cout << std::setw(12) << std::setprecision(3)
+                          << std::log(fastest / previous) / std::log(static_cast<double>(size) / static_cast<double>(previous_size));
+            }
+            std::cout << std::endl;
+
+            previous = fastest;
+            previous_size = size;
+        }
+    }
+
+    void division(size_t largest)
+    {
+        std::mt19937 generator(43);
+
+        std::cout << "division, 2n / n limbs" << std::endl;
+        std::cout << std::setw(10) << "limbs" << std::setw(16) << "trivial, us" << std::setw(16) << "B-Z, us"
+                  << std::setw(16) << "Newton, us" << std::setw(12) << "exponent" << std::endl;
+
+        double previous = 0;
+        size_t previous_size = 0;
+        for (size_t size = 8; size <= largest / 2; size = size < 64 ? size * 2 : size * 3 / 2)
+        {
+            const big_int dividend = random_big_int(2 * size, generator);
+            const big_int divisor = random_big_int(size, generator);
+
+            auto time = [&](big_int::division_rule rule) {
+                return measure([&] {
+                    big_int quotient(dividend);
+                    quotient.divide_assign(divisor, rule);
+                });
+            };
+
+            std::optional<double> trivial;
+            std::optional<double> recursive;
+            std::optional<double> newton;
+            if (size <= 8192)
+            {
+                trivial = time(big_int::division_rule::trivial);
+            }
+            if (size >= 32)
+            {
+                recursive = time(big_int::division_rule::BurnikelZiegler);
+            }
+            if (size >= 256)
+            {
+                newton = time(big_int::division_rule::Newton);
+            }
+
+            std::cout << std::setw(10) << size;
+            print_time(trivial);
+            print_time(recursive);
+            print_time(newton);
+
+            double fastest = std::min({trivial.value_or(INFINITY), recursive.value_or(INFINITY), newton.value_or(INFINITY)});
+            if (previous_size != 0)
+            {
+                std::cout << std::setw(12) << std::setprecision(3)
+                          << std::log(fastest / previous) / std::log(static_cast<double>(size) / static_cast<double>(previous_size));
+            }
+            std::cout << std::endl;
+
+            previous = fastest;
+            previous_size = size;
+        }
+    }
+
+    void conversion(size_t largest)
+    {
+        std::mt19937 generator(44);
+
+        std::cout << "radix conversion, n limbs" << std::endl;
+        std::cout << std::setw(10) << "limbs" << std::setw(12) << "digits" << std::setw(16) << "to_string, us"
+                  << std::setw(16) << "parse, us" << std::setw(16) << "hex out, us" << std::setw(12) << "exponent" << std::endl;
+
+        double previous = 0;
+        size_t previous_size = 0;
+        for (size_t size = 16; size <= largest; size *= 4)
+        {
+            const big_int value = random_big_int(size, generator);
+            const std::string decimal = value.to_string();
+
+            const double printing = measure([&] { value.to_string(); });
+            const double parsing = measure([&] { big_int parsed(decimal); });
+            const double hexadecimal = measure([&] { value.to_string(16); });
+
+            std::cout << std::setw(10) << size << std::setw(12) << decimal.size();
+            print_time(printing);
+            print_time(parsing);
+            print_time(hexadecimal);
+
+            if (previous_size != 0)
+            {
+                std::cout << std::setw(12) << std::setprecision(3)
+                          << std::log(printing / previous) / std::log(static_cast<double>(size) / static_cast<double>(previous_size));
+            }
+            std::cout << std::endl;
+
+            previous = printing;
+            previous_size = size;
+        }
+    }
+
+    void modular_power(size_t largest)
+    {
+        std::mt19937 generator(45);
+
+        std::cout << "modular exponentiation, n-limb odd modulus, base and exponent" << std::endl;
+        std::cout << std::setw(10) << "limbs" << std::setw(16) << "* and %, us" << std::setw(16) << "pow_mod, us"
+                  << std::setw(16) << "context, us" << std::endl;
+
+        for (size_t size = 8; size <= std::min<size_t>(largest, 512); size *= 2)
+        {
+            const big_int modulus = random_big_int(size, generator) | big_int(1);
+            const big_int base = random_big_int(size, generator) % modulus;
+            const big_int exponent = random_big_int(size, generator);
+            const montgomery_context context(modulus);
+
+            // The square-and-multiply loop that pow_mod replaces
+            std::optional<double> chained;
+            if (size <= 128)
+            {
+                const std::string bits = exponent.to_string(2);
+                chained = measure([&] {
+                    big_int result(1);
+                    for (char bit : bits)
+                    {
+                        result = result * result % modulus;
+                        if (bit == '1')
+                        {
+                            result = result * base % modulus;
+                        }
+                    }
+                });
+            }
+
+            std::cout << std::setw(10) << size;
+            print_time(chained);
+            print_time(measure([&] { base.pow_mod(exponent, modulus); }));
+            print_time(measure([&] { context.pow(base, exponent); }));
+            std::cout << std::endl;
+        }
+    }
+
+    void greatest_common_divisor(size_t largest)
+    {
+        std::mt19937 generator(47);
+
+        std::cout << "greatest common divisor, n x n limbs" << std::endl;
+        std::cout << std::setw(10) << "limbs" << std::setw(16) << "Euclid, us" << std::setw(16) << "gcd, us"
+                  << std::setw(16) << "extended, us" << std::endl;
+
+        for (size_t size = 4; size <= std::min<size_t>(largest, 16384); size *= 4)
+        {
+            const big_int a = random_big_int(size, generator);
+            const big_int b = random_big_int(size, generator);
+
+            // The remainder loop that fraction used to reduce by
+            std::optional<double> euclid;
+            if (size <= 1024)
+            {
+                euclid = measure([&] {
+                    big_int first(a), second(b);
+                    while (second != big_int(0))
+                    {
+                        big_int remainder = first % second;
+                        first = second;
+                        second = remainder;
+                    }
+                });
+            }
+
+            big_int x, y;
+            std::cout << std::setw(10) << size;
+            print_time(euclid);
+            print_time(measure([&] { big_int::gcd(a, b); }));
+            print_time(measure([&] { big_int::gcd_extended(a, b, x, y); }));
+            std::cout << std::endl;
+        }
+    }
+
+    void parallel_multiplication(size_t largest)
+    {
+        std::mt19937 generator(46);
+
+        std::cout << "Schonhage-Strassen n x n limbs on a thread pool, " << std::thread::hardware_concurrency()
+                  << " hardware threads" << std::endl;
+        std::cout << std::setw(10) << "limbs" << std::setw(16) << "1 thread, us" << std::setw(16) << "4 threads, us"
+                  << std::setw(16) << "16 threads, us" << std::setw(12) << "speedup 4" << std::setw(12) << "speedup 16" << std::endl;
+
+        big_int_thread_pool four(3);
+        big_int_thread_pool sixteen(15);
+        for (size_t size = big_int::default_parallel_threshold; size <= largest; size *= 4)
+        {
+            const big_int a = random_big_int(size, generator);
+            const big_int b = random_big_int(size, generator);
+
+            auto time = [&](big_int_thread_pool* pool) {
+                return measure([&] {
+                    big_int product(a);
+                    if (pool == nullptr)
+                    {
+                        product.multiply_assign(b, big_int::multiplication_rule::SchonhageStrassen);
+                    }
+                    else
+                    {
+                        product.multiply_assign(b, big_int::multiplication_rule::SchonhageStrassen, *pool);
+                    }
+                });
+            };
+
+            const double serial = time(nullptr);
+            const double on_four = time(&four);
+            const double on_sixteen = time(&sixteen);
+
+            std::cout << std::setw(10) << size;
+            print_time(serial);
+            print_time(on_four);
+            print_time(on_sixteen);
+            std::cout << std::setw(12) << std::setprecision(2) << serial / on_four
+                      << std::setw(12) << std::setprecision(2) << serial / on_sixteen << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t largest = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    allocations(largest);
+    std::cout << std::endl;
+    linear(largest);
+    std::cout << std::endl;
+    multiplication(largest);
+    std::cout << std::endl;
+    division(largest);
+    std::cout << std::endl;
+    conversion(largest);
+    std::cout << std::endl;
+    modular_power(largest);
+    std::cout << std::endl;
+    greatest_common_divisor(largest);
+    std::cout << std::endl;
+    parallel_multiplication(largest);
+
+    return 0;
+}
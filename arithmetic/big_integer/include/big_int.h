@@ -11,6 +11,8 @@
 #include <concepts>
 #include <pp_allocator.h>
 #include <not_implemented.h>
+#include "small_digit_vector.h"
+#include "big_int_thread_pool.h"
 
 namespace __detail
 {
@@ -46,11 +48,15 @@ namespace __detail
     }
 }
 
+class montgomery_context;
+
 class big_int
 {
     // Call optimise after every operation!!!
     bool _sign; // 1 +  0 -
-    std::vector<unsigned int, pp_allocator<unsigned int>> _digits;
+    small_digit_vector _digits;
+
+    friend class montgomery_context;
 
 public:
 
@@ -75,6 +81,14 @@ private:
     multiplication_rule decide_mult(size_t rhs) const noexcept;
     division_rule decide_div(size_t rhs) const noexcept;
 
+    /** this += (sign ? 1 : -1) * digits * BASE^shift for a normalised nonzero range that is not inside _digits
+     */
+    void accumulate(const unsigned int* digits, size_t size, bool sign, size_t shift);
+
+    /** The reductions behind gcd and gcd_extended
+     */
+    struct euclid;
+
 public:
 
     using value_type = unsigned int;
@@ -95,6 +109,19 @@ public:
 
     explicit operator bool() const noexcept; //false if 0 , else true
 
+    /** The number of bits of |this|, 0 for zero
+     */
+    size_t bit_width() const noexcept;
+
+    /** The number of zero bits below the lowest one of |this|, 0 for zero
+     */
+    size_t countr_zero() const noexcept;
+
+    /** The top 64 bits of |this|, from its highest one down, padded with zeros for shorter numbers:
+     *  |this| is leading_bits() * 2^(bit_width() - 64) up to the bits below them
+     */
+    unsigned long long leading_bits() const noexcept;
+
     big_int& operator++() &;
     big_int operator++(int);
 
@@ -119,6 +146,18 @@ public:
 
     big_int& multiply_assign(const big_int& other, multiplication_rule rule = multiplication_rule::trivial) &;
 
+    /** multiply_assign with the products of this call split between the pool's threads whatever their size.
+     *  Only the SchonhageStrassen rule has independent parts to share
+     */
+    big_int& multiply_assign(const big_int& other, multiplication_rule rule, big_int_thread_pool& pool) &;
+
+    static constexpr size_t default_parallel_threshold = 16384;
+
+    /** From now on, on every thread, products whose shorter operand has at least threshold limbs are split
+     *  between the pool's threads. The pool must outlive its use; nullptr, the initial setting, turns this off
+     */
+    static void parallel_multiplication(big_int_thread_pool* pool, size_t threshold = default_parallel_threshold);
+
     big_int& operator/=(const big_int& other) &;
 
     big_int& divide_assign(const big_int& other, division_rule rule = division_rule::trivial) &;
@@ -160,11 +199,46 @@ public:
     big_int operator|(const big_int& other) const;
     big_int operator^(const big_int& other) const;
 
+    /** Allocation-free forms of the operators. Results are written into caller-owned objects, reusing their digit
+     *  buffers and per-thread scratch, so a loop over the same variables stops allocating once they have reached
+     *  their largest size. Outputs may be the same objects as inputs; quotient and remainder must differ.
+     *  Without a rule the algorithm is chosen as by operator*= and operator/=
+     */
+    friend void add(big_int& out, const big_int& a, const big_int& b);
+    friend void sub(big_int& out, const big_int& a, const big_int& b);
+    friend void mul(big_int& out, const big_int& a, const big_int& b);
+    friend void mul(big_int& out, const big_int& a, const big_int& b, multiplication_rule rule);
+
+    /** out += a * b
+     */
+    friend void addmul(big_int& out, const big_int& a, const big_int& b);
+
+    /** The quotient and remainder of a / b as operator/ and operator% give them
+     */
+    friend void divmod(big_int& quotient, big_int& remainder, const big_int& a, const big_int& b);
+    friend void divmod(big_int& quotient, big_int& remainder, const big_int& a, const big_int& b, division_rule rule);
+
+    /** this^exponent mod modulus, in [0, modulus) also for a negative this. An odd modulus goes through
+     *  a montgomery_context; build one directly when several powers share the modulus
+     */
+    big_int pow_mod(const big_int& exponent, const big_int& modulus) const;
+
+    /** The greatest common divisor of |a| and |b|, zero only for two zeros. Lehmer's algorithm, and for long
+     *  numbers half-gcd, which finds the remainders halfway down Euclid's sequence from the leading halves
+     */
+    static big_int gcd(const big_int& a, const big_int& b);
+
+    /** gcd(a, b), also setting x and y so that a * x + b * y is equal to it
+     */
+    static big_int gcd_extended(const big_int& a, const big_int& b, big_int& x, big_int& y);
+
     friend std::ostream &operator<<(std::ostream &stream, big_int const &value);
 
     friend std::istream &operator>>(std::istream &stream, big_int &value);
 
-    std::string to_string() const;
+    /** Digits in the given radix (2 to 36, lowercase letters above 9); the string constructor accepts the same
+     */
+    std::string to_string(unsigned int radix = 10) const;
 };
 
 // Реализация шаблонного конструктора из вектора
@@ -212,4 +286,41 @@ big_int::big_int(Num d, pp_allocator<unsigned int> allocator)
 
 big_int operator""_bi(unsigned long long n);
 
+/** Arithmetic modulo a fixed odd number in Montgomery form, x * R mod n for R = 2^(32k) and k the limb count of n
+ *  rounded up to even. Products are reduced by multiply-and-shift instead of division, and R^2 mod n and -1/n mod R
+ *  are computed once, so keep the context for as long as the modulus is in use
+ */
+class montgomery_context final
+{
+    big_int _modulus;
+    small_digit_vector _digits; // the modulus padded to k limbs
+    small_digit_vector _square; // R^2 mod n
+    small_digit_vector _inverse; // -1/n mod R, only its low 64 bits for short moduli
+
+    /** value mod n in [0, n) as k limbs
+     */
+    void residue(unsigned int* out, const big_int& value) const;
+
+    void assign(big_int& out, const unsigned int* digits) const;
+
+public:
+
+    /** Throws std::invalid_argument unless modulus is odd and positive
+     */
+    explicit montgomery_context(const big_int& modulus);
+
+    const big_int& modulus() const noexcept;
+
+    big_int to_montgomery(const big_int& value) const;
+    big_int from_montgomery(const big_int& value) const;
+
+    /** out = a * b / R mod n, which for the Montgomery forms of a and b is the Montgomery form of their product
+     */
+    void multiply(big_int& out, const big_int& a, const big_int& b) const;
+
+    /** base^exponent mod n in [0, n) for an ordinary base and a non-negative exponent
+     */
+    big_int pow(const big_int& base, const big_int& exponent) const;
+};
+
 #endif //MP_OS_BIG_INT_H
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef MP_OS_BIG_INT_THREAD_POOL_H
+#define MP_OS_BIG_INT_THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/** Worker threads for splitting one operation into parts that run at the same time, see
+ *  big_int::parallel_multiplication. The thread that calls run works on the parts as well.
+ *  A pool runs one job at a time: a run that finds it busy, e.g. one made from inside a part, runs serially
+ */
+class big_int_thread_pool final
+{
+    std::vector<std::thread> _workers;
+
+    std::mutex _busy;
+
+    std::mutex _mutex;
+    std::condition_variable _started;
+    std::condition_variable _finished;
+
+    void (*_task)(void*, size_t) = nullptr;
+    void* _context = nullptr;
+    size_t _count = 0;
+    size_t _next = 0;
+    size_t _pending = 0;
+    size_t _generation = 0;
+    bool _stopping = false;
+
+    void work();
+
+    /** Runs parts of the current job until none is left unclaimed; lock holds _mutex
+     */
+    void take_parts(std::unique_lock<std::mutex>& lock);
+
+    void run_parts(size_t count, void (*task)(void*, size_t), void* context);
+
+public:
+
+    /** threads workers besides the calling one; by default one per remaining hardware thread
+     */
+    explicit big_int_thread_pool(size_t threads = std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
+    big_int_thread_pool(const big_int_thread_pool&) = delete;
+    big_int_thread_pool& operator=(const big_int_thread_pool&) = delete;
+
+    ~big_int_thread_pool();
+
+    /** Threads that work on a job, the caller included
+     */
+    size_t concurrency() const noexcept;
+
+    /** Calls part(i) for every i in [0, count) and returns when all calls have; part must not throw
+     */
+    template<class F>
+    void run(size_t count, F&& part)
+    {
+        using function = std::remove_reference_t<F>;
+        run_parts(count, [](void* context, size_t i) { (*static_cast<function*>(context))(i); },
+                  const_cast<void*>(static_cast<const void*>(&part)));
+    }
+};
+
+#endif //MP_OS_BIG_INT_THREAD_POOL_H
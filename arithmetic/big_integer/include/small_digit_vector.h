@@ -0,0 +1,357 @@
+#ifndef MP_OS_SMALL_DIGIT_VECTOR_H
+#define MP_OS_SMALL_DIGIT_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <vector>
+#include <pp_allocator.h>
+
+/** Limb storage of big_int. A number of up to inline_capacity limbs is kept inside the object; a longer one
+ *  moves to a std::vector from the allocator and stays there while it is modified in place, so a value that
+ *  shrinks and grows again does not reallocate. Copies and moves of short numbers never allocate.
+ *  The inline limbs share the space of the vector, but the allocator and the size are kept beside them,
+ *  so the object is 16 bytes larger than a std::vector (48 bytes rather than 32 on 64-bit targets)
+ */
+class small_digit_vector final
+{
+public:
+
+    using value_type = unsigned int;
+    using allocator_type = pp_allocator<unsigned int>;
+    using heap_vector = std::vector<unsigned int, pp_allocator<unsigned int>>;
+    using iterator = unsigned int*;
+    using const_iterator = const unsigned int*;
+
+    // As many limbs as fit in the space of the vector they stand in for
+    static constexpr size_t inline_capacity = sizeof(heap_vector) / sizeof(unsigned int);
+
+private:
+
+    static constexpr unsigned int heap_marker = ~0u;
+
+    allocator_type _allocator;
+    unsigned int _inline_size = 0;
+
+    union
+    {
+        unsigned int _inline[inline_capacity];
+        heap_vector _heap;
+    };
+
+    bool on_heap() const noexcept
+    {
+        return _inline_size == heap_marker;
+    }
+
+    /** Moves the inline limbs to a vector with room for capacity of them
+     */
+    void spill(size_t capacity)
+    {
+        heap_vector heap(_allocator);
+        heap.reserve(std::max(capacity, 2 * inline_capacity));
+        heap.assign(_inline, _inline + _inline_size);
+
+        new (&_heap) heap_vector(std::move(heap));
+        _inline_size = heap_marker;
+    }
+
+    void release() noexcept
+    {
+        if (on_heap())
+        {
+            _heap.~heap_vector();
+            _inline_size = 0;
+        }
+    }
+
+public:
+
+    explicit small_digit_vector(const allocator_type& allocator = allocator_type()) noexcept : _allocator(allocator) {}
+
+    small_digit_vector(size_t count, unsigned int value, const allocator_type& allocator = allocator_type()) : _allocator(allocator)
+    {
+        assign(count, value);
+    }
+
+    template<std::forward_iterator It>
+    small_digit_vector(It first, It last, const allocator_type& allocator = allocator_type()) : _allocator(allocator)
+    {
+        assign(first, last);
+    }
+
+    /** Takes over the vector's buffer, whatever its length
+     */
+    explicit small_digit_vector(heap_vector&& digits) noexcept : _allocator(digits.get_allocator()), _inline_size(heap_marker)
+    {
+        new (&_heap) heap_vector(std::move(digits));
+    }
+
+    small_digit_vector(const small_digit_vector& other, const allocator_type& allocator) : _allocator(allocator)
+    {
+        assign(other.begin(), other.end());
+    }
+
+    small_digit_vector(const small_digit_vector& other) : small_digit_vector(other, other._allocator) {}
+
+    small_digit_vector(small_digit_vector&& other) noexcept : _allocator(other._allocator), _inline_size(other._inline_size)
+    {
+        if (other.on_heap())
+        {
+            new (&_heap) heap_vector(std::move(other._heap));
+        }
+        else
+        {
+            std::copy_n(other._inline, _inline_size, _inline);
+        }
+    }
+
+    small_digit_vector& operator=(const small_digit_vector& other)
+    {
+        if (this != &other)
+        {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    /** The allocator propagates, as pp_allocator asks of containers
+     */
+    small_digit_vector& operator=(small_digit_vector&& other) noexcept
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+
+        release();
+        _allocator = other._allocator;
+        if (other.on_heap())
+        {
+            new (&_heap) heap_vector(std::move(other._heap));
+            _inline_size = heap_marker;
+        }
+        else
+        {
+            std::copy_n(other._inline, other._inline_size, _inline);
+            _inline_size = other._inline_size;
+        }
+        return *this;
+    }
+
+    ~small_digit_vector()
+    {
+        release();
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return _allocator;
+    }
+
+    size_t size() const noexcept
+    {
+        return on_heap() ? _heap.size() : _inline_size;
+    }
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return on_heap() ? _heap.capacity() : inline_capacity;
+    }
+
+    unsigned int* data() noexcept
+    {
+        return on_heap() ? _heap.data() : _inline;
+    }
+
+    const unsigned int* data() const noexcept
+    {
+        return on_heap() ? _heap.data() : _inline;
+    }
+
+    iterator begin() noexcept
+    {
+        return data();
+    }
+
+    iterator end() noexcept
+    {
+        return data() + size();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return data();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return data() + size();
+    }
+
+    unsigned int& operator[](size_t index) noexcept
+    {
+        return data()[index];
+    }
+
+    const unsigned int& operator[](size_t index) const noexcept
+    {
+        return data()[index];
+    }
+
+    unsigned int& back() noexcept
+    {
+        return data()[size() - 1];
+    }
+
+    const unsigned int& back() const noexcept
+    {
+        return data()[size() - 1];
+    }
+
+    void reserve(size_t capacity)
+    {
+        if (on_heap())
+        {
+            _heap.reserve(capacity);
+        }
+        else if (capacity > inline_capacity)
+        {
+            spill(capacity);
+        }
+    }
+
+    void resize(size_t count, unsigned int value = 0)
+    {
+        if (!on_heap() && count <= inline_capacity)
+        {
+            if (count > _inline_size)
+            {
+                std::fill(_inline + _inline_size, _inline + count, value);
+            }
+            _inline_size = static_cast<unsigned int>(count);
+            return;
+        }
+
+        if (!on_heap())
+        {
+            spill(count);
+        }
+        _heap.resize(count, value);
+    }
+
+    void assign(size_t count, unsigned int value)
+    {
+        if (!on_heap() && count <= inline_capacity)
+        {
+            std::fill_n(_inline, count, value);
+            _inline_size = static_cast<unsigned int>(count);
+            return;
+        }
+
+        if (!on_heap())
+        {
+            spill(count);
+        }
+        _heap.assign(count, value);
+    }
+
+    template<std::forward_iterator It>
+    void assign(It first, It last)
+    {
+        const auto count = static_cast<size_t>(std::distance(first, last));
+        if (!on_heap() && count <= inline_capacity)
+        {
+            std::copy(first, last, _inline);
+            _inline_size = static_cast<unsigned int>(count);
+            return;
+        }
+
+        if (!on_heap())
+        {
+            _inline_size = 0;
+            spill(count);
+        }
+        _heap.assign(first, last);
+    }
+
+    void push_back(unsigned int value)
+    {
+        if (!on_heap())
+        {
+            if (_inline_size < inline_capacity)
+            {
+                _inline[_inline_size++] = value;
+                return;
+            }
+            spill(2 * inline_capacity);
+        }
+        _heap.push_back(value);
+    }
+
+    void pop_back() noexcept
+    {
+        if (on_heap())
+        {
+            _heap.pop_back();
+        }
+        else
+        {
+            --_inline_size;
+        }
+    }
+
+    void clear() noexcept
+    {
+        if (on_heap())
+        {
+            _heap.clear();
+        }
+        else
+        {
+            _inline_size = 0;
+        }
+    }
+
+    iterator insert(const_iterator position, size_t count, unsigned int value)
+    {
+        const auto offset = static_cast<size_t>(position - begin());
+        if (!on_heap() && _inline_size + count <= inline_capacity)
+        {
+            std::copy_backward(_inline + offset, _inline + _inline_size, _inline + _inline_size + count);
+            std::fill_n(_inline + offset, count, value);
+            _inline_size += static_cast<unsigned int>(count);
+            return _inline + offset;
+        }
+
+        if (!on_heap())
+        {
+            spill(_inline_size + count);
+        }
+        return _heap.data() + (_heap.insert(_heap.begin() + offset, count, value) - _heap.begin());
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        const auto offset = static_cast<size_t>(first - begin());
+        const auto count = static_cast<size_t>(last - first);
+        if (on_heap())
+        {
+            _heap.erase(_heap.begin() + offset, _heap.begin() + offset + count);
+            return _heap.data() + offset;
+        }
+
+        std::copy(_inline + offset + count, _inline + _inline_size, _inline + offset);
+        _inline_size -= static_cast<unsigned int>(count);
+        return _inline + offset;
+    }
+};
+
+#endif //MP_OS_SMALL_DIGIT_VECTOR_H
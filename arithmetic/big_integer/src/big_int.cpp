@@ -5,23 +5,2434 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
 #include "../include/big_int.h"
 
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(BIG_INT_PORTABLE_KERNELS)
+#define BIG_INT_SIMD_KERNELS
+#include <immintrin.h>
+#endif
+
 namespace
 {
     constexpr unsigned long long BASE = 1ULL << (8 * sizeof(unsigned int));
 
-    void optimise(std::vector<unsigned int, pp_allocator<unsigned int>>& digits)
+    using digits_vector = small_digit_vector;
+
+    void optimise(digits_vector& digits)
+    {
+        while (digits.size() > 1 && digits.back() == 0)
+        {
+            digits.pop_back();
+        }
+    }
+
+    bool is_zero(const digits_vector& digits)
+    {
+        return digits.size() == 1 && digits[0] == 0;
+    }
+
+    /*
+     * Multiplication kernels. They work on raw little-endian limb ranges and take all temporary space from
+     * one scratch buffer sized by mul_scratch_size, so a product allocates exactly twice: result and scratch.
+     */
+
+    using limb = unsigned int;
+
+    // Below this many limbs in the shorter operand schoolbook wins, below the second Karatsuba beats Toom-3.
+    // Measured with mp_os_arthmtc_bg_intgr_benchmarks
+    constexpr size_t karatsuba_threshold = 32;
+    constexpr size_t toom3_threshold = 160;
+
+    /*
+     * Where the compiler has a 128-bit integer the carry chains below run over 64-bit words, two limbs per step.
+     * Limbs themselves stay 32-bit, so the digit interface of big_int is the same either way.
+     * Define BIG_INT_PORTABLE_KERNELS to build the limb-at-a-time loops only
+     */
+#if defined(__SIZEOF_INT128__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ \
+    && !defined(BIG_INT_PORTABLE_KERNELS)
+#define BIG_INT_WORD_KERNELS
+
+    using word = unsigned long long;
+    using double_word = unsigned __int128;
+
+    /** Limb vectors are only 4-byte aligned; memcpy compiles to a plain unaligned load or store
+     */
+    word load_word(const limb* p) noexcept
+    {
+        word value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    void store_word(limb* p, word value) noexcept
+    {
+        std::memcpy(p, &value, sizeof(value));
+    }
+#endif
+
+#ifdef BIG_INT_SIMD_KERNELS
+    /*
+     * AVX2 and AVX-512 kernels for long operands, chosen once at start-up from what the processor supports.
+     * A vector of limb sums is carried by lookahead: overflowing lanes generate a carry, all-ones lanes
+     * propagate one, and one integer addition of the two lane masks tells which lanes receive a carry.
+     * Each kernel handles whole vectors and returns how many limbs it did; the scalar loops finish the rest
+     */
+    enum class simd_level
+    {
+        none,
+        avx2,
+        avx512
+    };
+
+    simd_level detect_simd() noexcept
+    {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            return simd_level::avx512;
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return simd_level::avx2;
+        }
+        return simd_level::none;
+    }
+
+    // Zero, i.e. scalar, until initialised, so big_int stays usable from other translation units' static objects
+    const simd_level simd = detect_simd();
+
+    __attribute__((target("avx2")))
+    __m256i load(const limb* p) noexcept
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    __attribute__((target("avx2")))
+    void store(limb* p, __m256i value) noexcept
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), value);
+    }
+
+    /** Turns the low 8 bits of mask into all-ones lanes
+     */
+    __attribute__((target("avx2")))
+    __m256i lanes_of(unsigned int mask) noexcept
+    {
+        const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(mask)), bits), bits);
+    }
+
+    __attribute__((target("avx2")))
+    unsigned int mask_of(__m256i lanes) noexcept
+    {
+        return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(lanes)));
+    }
+
+    __attribute__((target("avx2")))
+    size_t add_avx2(limb* r, const limb* a, const limb* b, size_t n, unsigned long long& carry) noexcept
+    {
+        const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+        const __m256i ones = _mm256_set1_epi32(-1);
+
+        unsigned int chain = static_cast<unsigned int>(carry);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256i x = load(a + i);
+            __m256i sum = _mm256_add_epi32(x, load(b + i));
+            const unsigned int generate = mask_of(_mm256_cmpgt_epi32(_mm256_xor_si256(x, sign), _mm256_xor_si256(sum, sign)));
+            const unsigned int propagate = mask_of(_mm256_cmpeq_epi32(sum, ones));
+            chain = (generate << 1) + propagate + chain;
+            sum = _mm256_sub_epi32(sum, lanes_of(chain ^ propagate));
+            store(r + i, sum);
+            chain >>= 8;
+        }
+        carry = chain;
+        return i;
+    }
+
+    __attribute__((target("avx2")))
+    size_t sub_avx2(limb* r, const limb* a, const limb* b, size_t n, unsigned long long& borrow) noexcept
+    {
+        const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+        const __m256i zero = _mm256_setzero_si256();
+
+        unsigned int chain = static_cast<unsigned int>(borrow);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256i x = load(a + i);
+            const __m256i y = load(b + i);
+            __m256i diff = _mm256_sub_epi32(x, y);
+            const unsigned int generate = mask_of(_mm256_cmpgt_epi32(_mm256_xor_si256(y, sign), _mm256_xor_si256(x, sign)));
+            const unsigned int propagate = mask_of(_mm256_cmpeq_epi32(diff, zero));
+            chain = (generate << 1) + propagate + chain;
+            diff = _mm256_add_epi32(diff, lanes_of(chain ^ propagate));
+            store(r + i, diff);
+            chain >>= 8;
+        }
+        borrow = chain;
+        return i;
+    }
+
+    __attribute__((target("avx512f")))
+    size_t add_avx512(limb* r, const limb* a, const limb* b, size_t n, unsigned long long& carry) noexcept
+    {
+        const __m512i ones = _mm512_set1_epi32(-1);
+        const __m512i one = _mm512_set1_epi32(1);
+
+        unsigned int chain = static_cast<unsigned int>(carry);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            const __m512i x = _mm512_loadu_si512(a + i);
+            const __m512i sum = _mm512_add_epi32(x, _mm512_loadu_si512(b + i));
+            const unsigned int generate = _mm512_cmplt_epu32_mask(sum, x);
+            const unsigned int propagate = _mm512_cmpeq_epi32_mask(sum, ones);
+            chain = (generate << 1) + propagate + chain;
+            _mm512_storeu_si512(r + i, _mm512_mask_add_epi32(sum, static_cast<__mmask16>(chain ^ propagate), sum, one));
+            chain >>= 16;
+        }
+        carry = chain;
+        return i;
+    }
+
+    __attribute__((target("avx512f")))
+    size_t sub_avx512(limb* r, const limb* a, const limb* b, size_t n, unsigned long long& borrow) noexcept
+    {
+        const __m512i zero = _mm512_setzero_si512();
+        const __m512i one = _mm512_set1_epi32(1);
+
+        unsigned int chain = static_cast<unsigned int>(borrow);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            const __m512i x = _mm512_loadu_si512(a + i);
+            const __m512i y = _mm512_loadu_si512(b + i);
+            const __m512i diff = _mm512_sub_epi32(x, y);
+            const unsigned int generate = _mm512_cmplt_epu32_mask(x, y);
+            const unsigned int propagate = _mm512_cmpeq_epi32_mask(diff, zero);
+            chain = (generate << 1) + propagate + chain;
+            _mm512_storeu_si512(r + i, _mm512_mask_sub_epi32(diff, static_cast<__mmask16>(chain ^ propagate), diff, one));
+            chain >>= 16;
+        }
+        borrow = chain;
+        return i;
+    }
+
+    /** Shifts a[top - 8k + 1, top] left in place, top-down; returns the highest index still to shift
+     */
+    __attribute__((target("avx2")))
+    size_t shift_left_avx2(limb* a, size_t top, int shift) noexcept
+    {
+        const __m128i left = _mm_cvtsi32_si128(shift);
+        const __m128i right = _mm_cvtsi32_si128(32 - shift);
+        for (; top >= 8; top -= 8)
+        {
+            limb* block = a + top - 7;
+            store(block, _mm256_or_si256(_mm256_sll_epi32(load(block), left), _mm256_srl_epi32(load(block - 1), right)));
+        }
+        return top;
+    }
+
+    /** _mm512_sll_epi32 and _mm512_srl_epi32 merge into an undefined vector, which GCC 12 reports as
+     *  maybe-uninitialized; with every lane selected the zero source is never used
+     */
+    __attribute__((target("avx512f")))
+    __m512i shift_lanes_left(__m512i value, __m128i count) noexcept
+    {
+        return _mm512_mask_sll_epi32(_mm512_setzero_si512(), 0xFFFF, value, count);
+    }
+
+    __attribute__((target("avx512f")))
+    __m512i shift_lanes_right(__m512i value, __m128i count) noexcept
+    {
+        return _mm512_mask_srl_epi32(_mm512_setzero_si512(), 0xFFFF, value, count);
+    }
+
+    __attribute__((target("avx512f")))
+    size_t shift_left_avx512(limb* a, size_t top, int shift) noexcept
+    {
+        const __m128i left = _mm_cvtsi32_si128(shift);
+        const __m128i right = _mm_cvtsi32_si128(32 - shift);
+        for (; top >= 16; top -= 16)
+        {
+            limb* block = a + top - 15;
+            const __m512i value = _mm512_or_si512(shift_lanes_left(_mm512_loadu_si512(block), left),
+                                                  shift_lanes_right(_mm512_loadu_si512(block - 1), right));
+            _mm512_storeu_si512(block, value);
+        }
+        return top;
+    }
+
+    /** Shifts a[0, 8k) right in place, bottom-up, while the limb above each block exists; returns the limbs done
+     */
+    __attribute__((target("avx2")))
+    size_t shift_right_avx2(limb* a, size_t n, int shift) noexcept
+    {
+        const __m128i right = _mm_cvtsi32_si128(shift);
+        const __m128i left = _mm_cvtsi32_si128(32 - shift);
+        size_t i = 0;
+        for (; i + 8 < n; i += 8)
+        {
+            store(a + i, _mm256_or_si256(_mm256_srl_epi32(load(a + i), right), _mm256_sll_epi32(load(a + i + 1), left)));
+        }
+        return i;
+    }
+
+    __attribute__((target("avx512f")))
+    size_t shift_right_avx512(limb* a, size_t n, int shift) noexcept
+    {
+        const __m128i right = _mm_cvtsi32_si128(shift);
+        const __m128i left = _mm_cvtsi32_si128(32 - shift);
+        size_t i = 0;
+        for (; i + 16 < n; i += 16)
+        {
+            const __m512i value = _mm512_or_si512(shift_lanes_right(_mm512_loadu_si512(a + i), right),
+                                                  shift_lanes_left(_mm512_loadu_si512(a + i + 1), left));
+            _mm512_storeu_si512(a + i, value);
+        }
+        return i;
+    }
+
+    template<char Op>
+    __attribute__((target("avx2")))
+    size_t bitwise_avx2(limb* r, const limb* b, size_t n) noexcept
+    {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256i x = load(r + i);
+            if constexpr (Op == '&')
+            {
+                store(r + i, _mm256_and_si256(x, load(b + i)));
+            }
+            else if constexpr (Op == '|')
+            {
+                store(r + i, _mm256_or_si256(x, load(b + i)));
+            }
+            else if constexpr (Op == '^')
+            {
+                store(r + i, _mm256_xor_si256(x, load(b + i)));
+            }
+            else
+            {
+                store(r + i, _mm256_xor_si256(x, _mm256_set1_epi32(-1)));
+            }
+        }
+        return i;
+    }
+
+    template<char Op>
+    __attribute__((target("avx512f")))
+    size_t bitwise_avx512(limb* r, const limb* b, size_t n) noexcept
+    {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            const __m512i x = _mm512_loadu_si512(r + i);
+            __m512i value;
+            if constexpr (Op == '&')
+            {
+                value = _mm512_and_si512(x, _mm512_loadu_si512(b + i));
+            }
+            else if constexpr (Op == '|')
+            {
+                value = _mm512_or_si512(x, _mm512_loadu_si512(b + i));
+            }
+            else if constexpr (Op == '^')
+            {
+                value = _mm512_xor_si512(x, _mm512_loadu_si512(b + i));
+            }
+            else
+            {
+                value = _mm512_xor_si512(x, _mm512_set1_epi32(-1));
+            }
+            _mm512_storeu_si512(r + i, value);
+        }
+        return i;
+    }
+#endif
+
+    /** r[0, an) = a + b, an >= bn; r may alias a or b. Returns the carry out of r[an - 1]
+     */
+    limb add(limb* r, const limb* a, size_t an, const limb* b, size_t bn) noexcept
+    {
+        unsigned long long carry = 0;
+        size_t i = 0;
+#ifdef BIG_INT_SIMD_KERNELS
+        if (simd == simd_level::avx512)
+        {
+            i = add_avx512(r, a, b, bn, carry);
+        }
+        else if (simd == simd_level::avx2)
+        {
+            i = add_avx2(r, a, b, bn, carry);
+        }
+#endif
+#ifdef BIG_INT_WORD_KERNELS
+        for (; i + 2 <= bn; i += 2)
+        {
+            const double_word sum = static_cast<double_word>(load_word(a + i)) + load_word(b + i) + carry;
+            store_word(r + i, static_cast<word>(sum));
+            carry = static_cast<word>(sum >> 64);
+        }
+#endif
+        for (; i < bn; ++i)
+        {
+            carry += static_cast<unsigned long long>(a[i]) + b[i];
+            r[i] = static_cast<limb>(carry);
+            carry >>= 32;
+        }
+        for (; i < an && carry != 0; ++i)
+        {
+            carry += a[i];
+            r[i] = static_cast<limb>(carry);
+            carry >>= 32;
+        }
+        if (r != a)
+        {
+            std::copy(a + i, a + an, r + i);
+        }
+        return static_cast<limb>(carry);
+    }
+
+    /** r[0, an) = a - b, an >= bn; r may alias a or b. Returns the borrow out of r[an - 1]
+     */
+    limb sub(limb* r, const limb* a, size_t an, const limb* b, size_t bn) noexcept
+    {
+        unsigned long long borrow = 0;
+        size_t i = 0;
+#ifdef BIG_INT_SIMD_KERNELS
+        if (simd == simd_level::avx512)
+        {
+            i = sub_avx512(r, a, b, bn, borrow);
+        }
+        else if (simd == simd_level::avx2)
+        {
+            i = sub_avx2(r, a, b, bn, borrow);
+        }
+#endif
+#ifdef BIG_INT_WORD_KERNELS
+        for (; i + 2 <= bn; i += 2)
+        {
+            const double_word diff = static_cast<double_word>(load_word(a + i)) - load_word(b + i) - borrow;
+            store_word(r + i, static_cast<word>(diff));
+            borrow = static_cast<word>(diff >> 64) & 1;
+        }
+#endif
+        for (; i < bn; ++i)
+        {
+            unsigned long long diff = static_cast<unsigned long long>(a[i]) - b[i] - borrow;
+            r[i] = static_cast<limb>(diff);
+            borrow = diff >> 63;
+        }
+        for (; i < an && borrow != 0; ++i)
+        {
+            unsigned long long diff = static_cast<unsigned long long>(a[i]) - borrow;
+            r[i] = static_cast<limb>(diff);
+            borrow = diff >> 63;
+        }
+        if (r != a)
+        {
+            std::copy(a + i, a + an, r + i);
+        }
+        return static_cast<limb>(borrow);
+    }
+
+    /** r[0, n) += a * multiplier. Returns the carry out of r[n - 1]
+     */
+    limb addmul_1(limb* r, const limb* a, size_t n, limb multiplier) noexcept
+    {
+        unsigned long long carry = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            carry += static_cast<unsigned long long>(multiplier) * a[i] + r[i];
+            r[i] = static_cast<limb>(carry);
+            carry >>= 32;
+        }
+        return static_cast<limb>(carry);
+    }
+
+    size_t significant(const limb* a, size_t n) noexcept
+    {
+        while (n > 0 && a[n - 1] == 0)
+        {
+            --n;
+        }
+        return n;
+    }
+
+    int compare(const limb* a, size_t an, const limb* b, size_t bn) noexcept
+    {
+        an = significant(a, an);
+        bn = significant(b, bn);
+        if (an != bn)
+        {
+            return an < bn ? -1 : 1;
+        }
+        for (size_t i = an; i-- > 0;)
+        {
+            if (a[i] != b[i])
+            {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    /** Adds a into the rn-limb range r, propagating the carry; the product layout guarantees it never leaves r
+     */
+    void add_into(limb* r, size_t rn, const limb* a, size_t an) noexcept
+    {
+        an = std::min(significant(a, an), rn);
+        add(r, r, rn, a, an);
+    }
+
+    /** Signed magnitude sum over fixed-width ranges: (r, rn, r_negative) = (a, a_negative) + (b, b_negative).
+     *  r may alias a or b and must be wide enough for the result
+     */
+    void add_signed(limb* r, size_t rn, bool& r_negative,
+                    const limb* a, size_t an, bool a_negative,
+                    const limb* b, size_t bn, bool b_negative) noexcept
+    {
+        an = significant(a, an);
+        bn = significant(b, bn);
+
+        size_t written;
+        if (a_negative == b_negative)
+        {
+            if (an < bn)
+            {
+                std::swap(a, b);
+                std::swap(an, bn);
+            }
+            limb carry = add(r, a, an, b, bn);
+            written = an;
+            if (carry != 0)
+            {
+                r[written++] = carry;
+            }
+            r_negative = a_negative;
+        }
+        else if (compare(a, an, b, bn) >= 0)
+        {
+            sub(r, a, an, b, bn);
+            written = an;
+            r_negative = a_negative;
+        }
+        else
+        {
+            sub(r, b, bn, a, an);
+            written = bn;
+            r_negative = b_negative;
+        }
+
+        std::fill(r + written, r + rn, 0u);
+        if (significant(r, rn) == 0)
+        {
+            r_negative = false;
+        }
+    }
+
+    /** a <<= shift bits in place, 0 < shift < 32. Returns the bits shifted out of the top limb
+     */
+    limb shift_left(limb* a, size_t n, int shift) noexcept
+    {
+        if (n == 0)
+        {
+            return 0;
+        }
+
+        const limb carry = a[n - 1] >> (32 - shift);
+        size_t i = n - 1;
+#ifdef BIG_INT_SIMD_KERNELS
+        if (simd == simd_level::avx512)
+        {
+            i = shift_left_avx512(a, i, shift);
+        }
+        else if (simd == simd_level::avx2)
+        {
+            i = shift_left_avx2(a, i, shift);
+        }
+#endif
+        for (; i > 0; --i)
+        {
+            a[i] = (a[i] << shift) | (a[i - 1] >> (32 - shift));
+        }
+        a[0] <<= shift;
+        return carry;
+    }
+
+    /** a >>= shift bits in place, 0 < shift < 32
+     */
+    void shift_right(limb* a, size_t n, int shift) noexcept
+    {
+        size_t i = 0;
+#ifdef BIG_INT_SIMD_KERNELS
+        if (simd == simd_level::avx512)
+        {
+            i = shift_right_avx512(a, n, shift);
+        }
+        else if (simd == simd_level::avx2)
+        {
+            i = shift_right_avx2(a, n, shift);
+        }
+#endif
+        for (; i + 1 < n; ++i)
+        {
+            a[i] = (a[i] >> shift) | (a[i + 1] << (32 - shift));
+        }
+        if (n > 0)
+        {
+            a[n - 1] >>= shift;
+        }
+    }
+
+    /** r[0, n) = r Op b for Op one of & | ^, or r = ~r for Op '~', where b is not read
+     */
+    template<char Op>
+    void bitwise(limb* r, const limb* b, size_t n) noexcept
+    {
+        size_t i = 0;
+#ifdef BIG_INT_SIMD_KERNELS
+        if (simd == simd_level::avx512)
+        {
+            i = bitwise_avx512<Op>(r, b, n);
+        }
+        else if (simd == simd_level::avx2)
+        {
+            i = bitwise_avx2<Op>(r, b, n);
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            if constexpr (Op == '&')
+            {
+                r[i] &= b[i];
+            }
+            else if constexpr (Op == '|')
+            {
+                r[i] |= b[i];
+            }
+            else if constexpr (Op == '^')
+            {
+                r[i] ^= b[i];
+            }
+            else
+            {
+                r[i] = ~r[i];
+            }
+        }
+    }
+
+    /** a /= 3, the division is known to be exact
+     */
+    void divide_exact_by_3(limb* a, size_t n) noexcept
+    {
+        unsigned long long remainder = 0;
+        for (size_t i = n; i-- > 0;)
+        {
+            unsigned long long current = (remainder << 32) | a[i];
+            a[i] = static_cast<limb>(current / 3);
+            remainder = current % 3;
+        }
+    }
+
+    /** r[0, an + bn) = a * b
+     */
+    void mul_basecase(limb* r, const limb* a, size_t an, const limb* b, size_t bn) noexcept
+    {
+        std::fill(r, r + an + bn, 0u);
+#ifdef BIG_INT_WORD_KERNELS
+        if (an >= 2 && bn >= 2)
+        {
+            // Even-length prefixes word by word, then an odd top limb of either operand as one limb row
+            const size_t a_words = an / 2;
+            const size_t b_words = bn / 2;
+            for (size_t j = 0; j < b_words; ++j)
+            {
+                const word multiplier = load_word(b + 2 * j);
+                if (multiplier == 0)
+                {
+                    continue;
+                }
+                word carry = 0;
+                for (size_t i = 0; i < a_words; ++i)
+                {
+                    const double_word product = static_cast<double_word>(multiplier) * load_word(a + 2 * i)
+                        + load_word(r + 2 * (i + j)) + carry;
+                    store_word(r + 2 * (i + j), static_cast<word>(product));
+                    carry = static_cast<word>(product >> 64);
+                }
+                store_word(r + 2 * (j + a_words), carry);
+            }
+            if (an % 2 != 0)
+            {
+                r[an + bn - 1] = addmul_1(r + an - 1, b, bn, a[an - 1]);
+            }
+            if (bn % 2 != 0)
+            {
+                const limb carry = addmul_1(r + bn - 1, a, 2 * a_words, b[bn - 1]);
+                add(r + bn - 1 + 2 * a_words, r + bn - 1 + 2 * a_words, an - 2 * a_words + 1, &carry, 1);
+            }
+            return;
+        }
+#endif
+        for (size_t j = 0; j < bn; ++j)
+        {
+            if (b[j] != 0)
+            {
+                r[j + an] = addmul_1(r + j, a, an, b[j]);
+            }
+        }
+    }
+
+    size_t balanced_scratch_size(size_t n) noexcept
+    {
+        if (n < karatsuba_threshold)
+        {
+            return 0;
+        }
+        if (n < toom3_threshold)
+        {
+            const size_t low = n - n / 2;
+            return 6 * low + 1 + std::max(balanced_scratch_size(low), balanced_scratch_size(n / 2));
+        }
+        const size_t part = (n + 2) / 3;
+        return 6 * (part + 1) + 5 * (2 * part + 2) + std::max(balanced_scratch_size(part), balanced_scratch_size(part + 1));
+    }
+
+    size_t mul_scratch_size(size_t an, size_t bn) noexcept
+    {
+        if (bn < karatsuba_threshold)
+        {
+            return 0;
+        }
+        if (an == bn || an % bn == 0)
+        {
+            return 2 * bn + balanced_scratch_size(bn);
+        }
+        return 2 * bn + std::max(balanced_scratch_size(bn), mul_scratch_size(bn, an % bn));
+    }
+
+    void mul_balanced(limb* r, const limb* a, const limb* b, size_t n, limb* scratch) noexcept;
+
+    /** r[0, 2n) = a * b for n-limb a and b, a = a0 + a1 * B^low: z1 = z0 + z2 - (a0 - a1)(b0 - b1).
+     *  The subtractive form keeps the middle product at low limbs, so there is no carry limb to handle
+     */
+    void mul_karatsuba(limb* r, const limb* a, const limb* b, size_t n, limb* scratch) noexcept
+    {
+        const size_t high = n / 2;
+        const size_t low = n - high;
+
+        limb* a_diff = scratch;
+        limb* b_diff = a_diff + low;
+        limb* middle = b_diff + low;
+        limb* sum = middle + 2 * low;
+        limb* next = sum + 2 * low + 1;
+
+        const bool a_negative = compare(a, low, a + low, high) < 0;
+        if (a_negative)
+        {
+            sub(a_diff, a + low, high, a, significant(a, low));
+            std::fill(a_diff + high, a_diff + low, 0u);
+        }
+        else
+        {
+            sub(a_diff, a, low, a + low, high);
+        }
+
+        const bool b_negative = compare(b, low, b + low, high) < 0;
+        if (b_negative)
+        {
+            sub(b_diff, b + low, high, b, significant(b, low));
+            std::fill(b_diff + high, b_diff + low, 0u);
+        }
+        else
+        {
+            sub(b_diff, b, low, b + low, high);
+        }
+
+        mul_balanced(middle, a_diff, b_diff, low, next);
+        mul_balanced(r, a, b, low, next);
+        mul_balanced(r + 2 * low, a + low, b + low, high, next);
+
+        sum[2 * low] = add(sum, r, 2 * low, r + 2 * low, 2 * high);
+        if (a_negative == b_negative)
+        {
+            sub(sum, sum, 2 * low + 1, middle, 2 * low);
+        }
+        else
+        {
+            sum[2 * low] += add(sum, sum, 2 * low, middle, 2 * low);
+        }
+
+        add_into(r + low, 2 * n - low, sum, 2 * low + 1);
+    }
+
+    /** r[0, 2n) = a * b for n-limb a and b by Toom-3: evaluation at 0, 1, -1, -2, infinity and
+     *  Bodrato's interpolation sequence. Values at the inner points are signed and kept as magnitude plus sign
+     */
+    void mul_toom3(limb* r, const limb* a, const limb* b, size_t n, limb* scratch) noexcept
+    {
+        const size_t part = (n + 2) / 3;
+        const size_t top = n - 2 * part;
+        const size_t width = 2 * part + 2;
+
+        limb* a1 = scratch;
+        limb* am1 = a1 + part + 1;
+        limb* am2 = am1 + part + 1;
+        limb* b1 = am2 + part + 1;
+        limb* bm1 = b1 + part + 1;
+        limb* bm2 = bm1 + part + 1;
+        limb* r1 = bm2 + part + 1;
+        limb* rm1 = r1 + width;
+        limb* rm2 = rm1 + width;
+        limb* r0 = rm2 + width;
+        limb* rinf = r0 + width;
+        limb* next = rinf + width;
+
+        bool am1_negative, am2_negative, bm1_negative, bm2_negative;
+
+        auto evaluate = [part, top](const limb* x, limb* x1, limb* xm1, bool& xm1_negative, limb* xm2, bool& xm2_negative)
+        {
+            const limb* x0 = x;
+            const limb* x_1 = x + part;
+            const limb* x_2 = x + 2 * part;
+            bool ignored;
+
+            // x1 = x0 + x2, then xm1 = x1 - x_1 and x1 += x_1
+            add_signed(x1, part + 1, ignored, x0, part, false, x_2, top, false);
+            add_signed(xm1, part + 1, xm1_negative, x1, part + 1, false, x_1, part, true);
+            add_signed(x1, part + 1, ignored, x1, part + 1, false, x_1, part, false);
+
+            // xm2 = 2 * (xm1 + x2) - x0
+            add_signed(xm2, part + 1, xm2_negative, xm1, part + 1, xm1_negative, x_2, top, false);
+            shift_left(xm2, part + 1, 1);
+            add_signed(xm2, part + 1, xm2_negative, xm2, part + 1, xm2_negative, x0, part, true);
+        };
+
+        evaluate(a, a1, am1, am1_negative, am2, am2_negative);
+        evaluate(b, b1, bm1, bm1_negative, bm2, bm2_negative);
+
+        mul_balanced(r1, a1, b1, part + 1, next);
+        mul_balanced(rm1, am1, bm1, part + 1, next);
+        mul_balanced(rm2, am2, bm2, part + 1, next);
+        bool rm1_negative = am1_negative != bm1_negative;
+        bool rm2_negative = am2_negative != bm2_negative;
+        bool r1_negative = false;
+
+        // The outer coefficients land in place; copies padded to width feed the interpolation
+        mul_balanced(r, a, b, part, next);
+        std::fill(r + 2 * part, r + 4 * part, 0u);
+        mul_balanced(r + 4 * part, a + 2 * part, b + 2 * part, top, next);
+        std::copy(r, r + 2 * part, r0);
+        std::fill(r0 + 2 * part, r0 + width, 0u);
+        std::copy(r + 4 * part, r + 4 * part + 2 * top, rinf);
+        std::fill(rinf + 2 * top, rinf + width, 0u);
+
+        // c3 = (r(-2) - r(1)) / 3
+        add_signed(rm2, width, rm2_negative, rm2, width, rm2_negative, r1, width, true);
+        divide_exact_by_3(rm2, width);
+        // c1 = (r(1) - r(-1)) / 2
+        add_signed(r1, width, r1_negative, r1, width, false, rm1, width, !rm1_negative);
+        shift_right(r1, width, 1);
+        // c2 = r(-1) - r(0)
+        add_signed(rm1, width, rm1_negative, rm1, width, rm1_negative, r0, width, true);
+        // c3 = (c2 - c3) / 2 + 2 r(inf)
+        add_signed(rm2, width, rm2_negative, rm1, width, rm1_negative, rm2, width, !rm2_negative);
+        shift_right(rm2, width, 1);
+        add_signed(rm2, width, rm2_negative, rm2, width, rm2_negative, rinf, width, false);
+        add_signed(rm2, width, rm2_negative, rm2, width, rm2_negative, rinf, width, false);
+        // c2 = c2 + c1 - r(inf)
+        add_signed(rm1, width, rm1_negative, rm1, width, rm1_negative, r1, width, r1_negative);
+        add_signed(rm1, width, rm1_negative, rm1, width, rm1_negative, rinf, width, true);
+        // c1 = c1 - c3
+        add_signed(r1, width, r1_negative, r1, width, r1_negative, rm2, width, !rm2_negative);
+
+        // All of c1, c2, c3 are non-negative now: they are coefficients of a product of non-negative polynomials
+        add_into(r + part, 2 * n - part, r1, width);
+        add_into(r + 2 * part, 2 * n - 2 * part, rm1, width);
+        add_into(r + 3 * part, 2 * n - 3 * part, rm2, width);
+    }
+
+    void mul_balanced(limb* r, const limb* a, const limb* b, size_t n, limb* scratch) noexcept
+    {
+        if (n < karatsuba_threshold)
+        {
+            mul_basecase(r, a, n, b, n);
+        }
+        else if (n < toom3_threshold)
+        {
+            mul_karatsuba(r, a, b, n, scratch);
+        }
+        else
+        {
+            mul_toom3(r, a, b, n, scratch);
+        }
+    }
+
+    /** r[0, an + bn) = a * b, an >= bn. An unbalanced product is cut into bn-limb slices of a,
+     *  each multiplied by the balanced kernels and accumulated
+     */
+    void mul(limb* r, const limb* a, size_t an, const limb* b, size_t bn, limb* scratch) noexcept
+    {
+        if (bn < karatsuba_threshold)
+        {
+            mul_basecase(r, a, an, b, bn);
+            return;
+        }
+
+        mul_balanced(r, a, b, bn, scratch + 2 * bn);
+
+        limb* slice = scratch;
+        for (size_t offset = bn; offset < an; offset += bn)
+        {
+            const size_t length = std::min(bn, an - offset);
+            if (length == bn)
+            {
+                mul_balanced(slice, a + offset, b, bn, scratch + 2 * bn);
+            }
+            else
+            {
+                mul(slice, b, bn, a + offset, length, scratch + 2 * bn);
+            }
+            std::fill(r + offset + bn, r + offset + bn + length, 0u);
+            add_into(r + offset, an + bn - offset, slice, bn + length);
+        }
+    }
+
+    /*
+     * FFT-class multiplication for the SchonhageStrassen rule: a number-theoretic transform modulo three primes
+     * below 2^32 followed by CRT. Every convolution coefficient is below n * 2^64 and the primes' product is
+     * about 2^95, so limbs are transformed as they are. The transform length is bounded by 2^27, the largest
+     * power of two dividing every p - 1; longer products are put together from blocks that fit it.
+     */
+
+    // Shorter operand size from which the transform beats Toom-3, measured with mp_os_arthmtc_bg_intgr_benchmarks
+    constexpr size_t ntt_threshold = 4096;
+
+    // Set for every thread by big_int::parallel_multiplication, or for the products of one call on this thread
+    std::atomic<big_int_thread_pool*> shared_pool = nullptr;
+    std::atomic<size_t> shared_pool_threshold = big_int::default_parallel_threshold;
+    thread_local big_int_thread_pool* local_pool = nullptr;
+
+    big_int_thread_pool* pool_for(size_t shorter) noexcept
+    {
+        if (local_pool != nullptr)
+        {
+            return local_pool;
+        }
+        return shorter >= shared_pool_threshold.load(std::memory_order_relaxed)
+            ? shared_pool.load(std::memory_order_acquire) : nullptr;
+    }
+
+    size_t concurrency(big_int_thread_pool* pool) noexcept
+    {
+        return pool == nullptr ? 1 : pool->concurrency();
+    }
+
+    // Fewer elements than this per part are not worth waking a thread for
+    constexpr size_t parallel_grain = 8192;
+
+    /** body(begin, end) over consecutive ranges covering [0, count), one per thread of the pool
+     *  and none shorter than grain, or over all of it at once without a pool
+     */
+    template<class F>
+    void parallel_for(big_int_thread_pool* pool, size_t count, size_t grain, F&& body)
+    {
+        const size_t parts = std::min(concurrency(pool), std::max<size_t>(count / grain, 1));
+        if (parts == 1)
+        {
+            body(size_t(0), count);
+            return;
+        }
+        pool->run(parts, [&](size_t part) {
+            body(count * part / parts, count * (part + 1) / parts);
+        });
+    }
+
+    template<unsigned int Mod, unsigned int Generator>
+    struct ntt_prime
+    {
+        static constexpr unsigned int modulus = Mod;
+
+        static unsigned int mul(unsigned int a, unsigned int b) noexcept
+        {
+            return static_cast<unsigned int>(static_cast<unsigned long long>(a) * b % Mod);
+        }
+
+        static unsigned int add(unsigned int a, unsigned int b) noexcept
+        {
+            unsigned long long sum = static_cast<unsigned long long>(a) + b;
+            return static_cast<unsigned int>(sum >= Mod ? sum - Mod : sum);
+        }
+
+        static unsigned int sub(unsigned int a, unsigned int b) noexcept
+        {
+            return static_cast<unsigned int>(a >= b ? a - b : static_cast<unsigned long long>(a) + Mod - b);
+        }
+
+        static constexpr unsigned int power(unsigned int base, unsigned long long exponent) noexcept
+        {
+            unsigned long long result = 1;
+            unsigned long long factor = base % Mod;
+            for (; exponent != 0; exponent >>= 1)
+            {
+                if (exponent & 1)
+                {
+                    result = result * factor % Mod;
+                }
+                factor = factor * factor % Mod;
+            }
+            return static_cast<unsigned int>(result);
+        }
+
+        static constexpr unsigned int inverse(unsigned int value) noexcept
+        {
+            return power(value, Mod - 2);
+        }
+
+        /** table[len + j] = w^j for the primitive 2len-th root w, for every power of two len < n
+         */
+        static void roots(unsigned int* table, size_t n, big_int_thread_pool* pool) noexcept
+        {
+            for (size_t len = 1; len < n; len <<= 1)
+            {
+                const unsigned int w = power(Generator, (Mod - 1) / (2 * len));
+                parallel_for(pool, len, parallel_grain, [=](size_t begin, size_t end) {
+                    unsigned int root = power(w, begin);
+                    for (size_t j = begin; j < end; ++j)
+                    {
+                        table[len + j] = root;
+                        root = mul(root, w);
+                    }
+                });
+            }
+        }
+
+        static void forward_butterfly(unsigned int* a, size_t i, size_t j, size_t len, const unsigned int* table) noexcept
+        {
+            const unsigned int u = a[i + j];
+            const unsigned int v = a[i + j + len];
+            a[i + j] = add(u, v);
+            a[i + j + len] = mul(sub(u, v), table[len + j]);
+        }
+
+        /** The twiddle of j = 0 is 1, which is not in the table's entries for len
+         */
+        static void backward_butterfly(unsigned int* a, size_t i, size_t j, size_t len, const unsigned int* table) noexcept
+        {
+            const unsigned int u = a[i + j];
+            const unsigned int v = j == 0 ? a[i + len] : sub(0, mul(a[i + j + len], table[2 * len - j]));
+            a[i + j] = add(u, v);
+            a[i + j + len] = sub(u, v);
+        }
+
+        /** Butterflies [begin, end) of the stage with half-length len, numbered block by block
+         */
+        template<bool Forward>
+        static void stage(unsigned int* a, size_t len, size_t begin, size_t end, const unsigned int* table) noexcept
+        {
+            for (size_t t = begin; t < end;)
+            {
+                const size_t i = t / len * 2 * len;
+                const size_t stop = std::min(len, t % len + (end - t));
+                for (size_t j = t % len; j < stop; ++j, ++t)
+                {
+                    if constexpr (Forward)
+                    {
+                        forward_butterfly(a, i, j, len, table);
+                    }
+                    else
+                    {
+                        backward_butterfly(a, i, j, len, table);
+                    }
+                }
+            }
+        }
+
+        /** Decimation in frequency: natural order in, bit-reversed order out
+         */
+        static void forward(unsigned int* a, size_t n, const unsigned int* table) noexcept
+        {
+            for (size_t len = n / 2; len >= 1; len >>= 1)
+            {
+                for (size_t i = 0; i < n; i += 2 * len)
+                {
+                    for (size_t j = 0; j < len; ++j)
+                    {
+                        forward_butterfly(a, i, j, len, table);
+                    }
+                }
+            }
+        }
+
+        /** Decimation in time with inverse roots, w^-j = -w^(len - j): bit-reversed in, natural order out.
+         *  The 1/n factor is left to the caller
+         */
+        static void backward(unsigned int* a, size_t n, const unsigned int* table) noexcept
+        {
+            for (size_t len = 1; len < n; len <<= 1)
+            {
+                for (size_t i = 0; i < n; i += 2 * len)
+                {
+                    for (size_t j = 0; j < len; ++j)
+                    {
+                        backward_butterfly(a, i, j, len, table);
+                    }
+                }
+            }
+        }
+
+        /** The stages that span more than one of the pool's blocks of n / threads elements share out their
+         *  butterflies; the rest stay inside a block and transform it as a whole
+         */
+        static void forward(unsigned int* a, size_t n, const unsigned int* table, big_int_thread_pool* pool) noexcept
+        {
+            const size_t blocks = std::min(std::bit_ceil(concurrency(pool)), n);
+            const size_t block = n / blocks;
+            for (size_t len = n / 2; len >= block; len >>= 1)
+            {
+                parallel_for(pool, n / 2, parallel_grain, [=](size_t begin, size_t end) {
+                    stage<true>(a, len, begin, end, table);
+                });
+            }
+            parallel_for(pool, blocks, 1, [=](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    forward(a + i * block, block, table);
+                }
+            });
+        }
+
+        static void backward(unsigned int* a, size_t n, const unsigned int* table, big_int_thread_pool* pool) noexcept
+        {
+            const size_t blocks = std::min(std::bit_ceil(concurrency(pool)), n);
+            const size_t block = n / blocks;
+            parallel_for(pool, blocks, 1, [=](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    backward(a + i * block, block, table);
+                }
+            });
+            for (size_t len = block; len < n; len <<= 1)
+            {
+                parallel_for(pool, n / 2, parallel_grain, [=](size_t begin, size_t end) {
+                    stage<false>(a, len, begin, end, table);
+                });
+            }
+        }
+
+        /** out[0, n) = cyclic convolution of a and b modulo Mod; work holds n more residues and the root table
+         */
+        static void convolve(unsigned int* out, const limb* a, size_t an, const limb* b, size_t bn, size_t n,
+                             unsigned int* work, big_int_thread_pool* pool) noexcept
+        {
+            unsigned int* other = work;
+            unsigned int* table = work + n;
+
+            roots(table, n, pool);
+
+            auto load = [n, pool](unsigned int* to, const limb* from, size_t count)
+            {
+                parallel_for(pool, n, parallel_grain, [=](size_t begin, size_t end) {
+                    for (size_t i = begin; i < std::min(end, count); ++i)
+                    {
+                        to[i] = from[i] >= Mod ? from[i] - Mod : from[i];
+                    }
+                    std::fill(to + std::max(begin, std::min(end, count)), to + end, 0u);
+                });
+            };
+
+            load(out, a, an);
+            forward(out, n, table, pool);
+
+            const unsigned int* transformed_b = out;
+            if (a != b || an != bn)
+            {
+                load(other, b, bn);
+                forward(other, n, table, pool);
+                transformed_b = other;
+            }
+
+            const unsigned int scale = inverse(static_cast<unsigned int>(n % Mod));
+            parallel_for(pool, n, parallel_grain, [=](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    out[i] = mul(mul(out[i], transformed_b[i]), scale);
+                }
+            });
+
+            backward(out, n, table, pool);
+        }
+    };
+
+    using ntt_prime_1 = ntt_prime<3221225473u, 5>;  // 3 * 2^30 + 1
+    using ntt_prime_2 = ntt_prime<3489660929u, 3>;  // 13 * 2^28 + 1
+    using ntt_prime_3 = ntt_prime<3892314113u, 3>;  // 29 * 2^27 + 1
+
+    constexpr size_t ntt_max_size = size_t(1) << 27;
+
+    size_t ntt_size(size_t an, size_t bn) noexcept
+    {
+        return std::bit_ceil(std::min(an + bn - 1, ntt_max_size));
+    }
+
+    size_t ntt_scratch_size(size_t an, size_t bn) noexcept
+    {
+        // Past one transform, also room for the product of a pair of blocks
+        return an + bn - 1 <= ntt_max_size ? 5 * ntt_size(an, bn) : 6 * ntt_max_size;
+    }
+
+    /** r[begin, end) gets coefficients [begin, end) of the product from their residues; what they carry
+     *  past end is left in carry[0, 3) for the caller to add
+     */
+    void reconstruct(limb* r, const unsigned int* residues_1, const unsigned int* residues_2, const unsigned int* residues_3,
+                     size_t begin, size_t end, limb* carry) noexcept
+    {
+        constexpr unsigned long long p1 = ntt_prime_1::modulus;
+        constexpr unsigned long long p1p2 = p1 * ntt_prime_2::modulus;
+        constexpr unsigned int p1_inverse_2 = ntt_prime_2::inverse(ntt_prime_1::modulus);
+        constexpr unsigned int p1p2_inverse_3 = ntt_prime_3::inverse(static_cast<unsigned int>(p1p2 % ntt_prime_3::modulus));
+
+        // value = x1 + x2 * p1 + x3 * p1 * p2 is added into three 32-bit columns carried by 64-bit accumulators
+        unsigned long long column_0 = 0;
+        unsigned long long column_1 = 0;
+        unsigned long long column_2 = 0;
+
+        for (size_t k = begin; k < end; ++k)
+        {
+            const unsigned int x1 = residues_1[k];
+            const unsigned int x2 = ntt_prime_2::mul(ntt_prime_2::sub(residues_2[k], x1 % ntt_prime_2::modulus), p1_inverse_2);
+            const unsigned int partial = static_cast<unsigned int>((x1 + static_cast<unsigned long long>(x2) * p1) % ntt_prime_3::modulus);
+            const unsigned int x3 = ntt_prime_3::mul(ntt_prime_3::sub(residues_3[k], partial), p1p2_inverse_3);
+
+            const unsigned long long x2_p1 = static_cast<unsigned long long>(x2) * p1;
+            const unsigned long long x3_low = static_cast<unsigned long long>(x3) * static_cast<unsigned int>(p1p2);
+            const unsigned long long x3_high = static_cast<unsigned long long>(x3) * static_cast<unsigned int>(p1p2 >> 32);
+
+            column_0 += static_cast<unsigned long long>(x1) + static_cast<unsigned int>(x2_p1) + static_cast<unsigned int>(x3_low);
+            column_1 += (x2_p1 >> 32) + (x3_low >> 32) + static_cast<unsigned int>(x3_high);
+            column_2 += x3_high >> 32;
+
+            r[k] = static_cast<limb>(column_0);
+            column_1 += column_0 >> 32;
+            column_2 += column_1 >> 32;
+            column_0 = static_cast<unsigned int>(column_1);
+            column_1 = static_cast<unsigned int>(column_2);
+            column_2 = column_2 >> 32;
+        }
+
+        carry[0] = static_cast<limb>(column_0);
+        carry[1] = static_cast<limb>(column_1);
+        carry[2] = static_cast<limb>(column_2);
+    }
+
+    /** r[0, an + bn) = a * b by three modular convolutions and Garner's reconstruction, an + bn - 1 <= ntt_max_size.
+     *  With a pool the transforms and the reconstruction are split between its threads
+     */
+    void mul_ntt_transform(limb* r, const limb* a, size_t an, const limb* b, size_t bn, limb* scratch,
+                           big_int_thread_pool* pool) noexcept
+    {
+        const size_t n = ntt_size(an, bn);
+
+        unsigned int* residues_1 = scratch;
+        unsigned int* residues_2 = residues_1 + n;
+        unsigned int* residues_3 = residues_2 + n;
+        unsigned int* work = residues_3 + n;
+
+        ntt_prime_1::convolve(residues_1, a, an, b, bn, n, work, pool);
+        ntt_prime_2::convolve(residues_2, a, an, b, bn, n, work, pool);
+        ntt_prime_3::convolve(residues_3, a, an, b, bn, n, work, pool);
+
+        // The last limb takes no coefficient of its own, only what the ones below carry into it
+        const size_t coefficients = an + bn - 1;
+        std::array<limb, 3 * 64> carries{};
+        const size_t parts = std::min({concurrency(pool), carries.size() / 3, std::max<size_t>(coefficients / parallel_grain, 1)});
+        auto bounds = [coefficients, parts](size_t part) {
+            return coefficients * part / parts;
+        };
+
+        if (parts == 1)
+        {
+            reconstruct(r, residues_1, residues_2, residues_3, 0, coefficients, carries.data());
+        }
+        else
+        {
+            pool->run(parts, [&](size_t part) {
+                reconstruct(r, residues_1, residues_2, residues_3, bounds(part), bounds(part + 1), carries.data() + 3 * part);
+            });
+        }
+
+        r[coefficients] = 0;
+        for (size_t part = 0; part < parts; ++part)
+        {
+            add_into(r + bounds(part + 1), an + bn - bounds(part + 1), carries.data() + 3 * part, 3);
+        }
+    }
+
+    /** r[0, an + bn) = a * b, an >= bn, in one transform if the product fits it, otherwise as a sum of products
+     *  of blocks of a and b that do
+     */
+    void mul_ntt(limb* r, const limb* a, size_t an, const limb* b, size_t bn, limb* scratch,
+                 big_int_thread_pool* pool = nullptr) noexcept
+    {
+        if (an + bn - 1 <= ntt_max_size)
+        {
+            mul_ntt_transform(r, a, an, b, bn, scratch, pool);
+            return;
+        }
+
+        // A short b is taken whole, so a is cut into as few blocks as possible
+        const size_t b_block = std::min(bn, ntt_max_size / 2);
+        const size_t a_block = ntt_max_size - b_block;
+        limb* product = scratch + 5 * ntt_max_size;
+
+        std::fill(r, r + an + bn, 0u);
+        for (size_t i = 0; i < an; i += a_block)
+        {
+            const size_t a_length = std::min(a_block, an - i);
+            for (size_t j = 0; j < bn; j += b_block)
+            {
+                const size_t b_length = std::min(b_block, bn - j);
+                mul_ntt_transform(product, a + i, a_length, b + j, b_length, scratch, pool);
+                add_into(r + i + j, an + bn - i - j, product, a_length + b_length);
+            }
+        }
+    }
+
+
+    /*
+     * Per-thread buffers for kernel scratch and for results that cannot go straight to their destination.
+     * A buffer keeps its memory between calls, so repeating an operation on numbers of the same size stops
+     * allocating after the first time. It is handed out for the duration of a workspace_lease, which gives the
+     * memory back when it came from another resource than the default one, which may not outlive the operation,
+     * or when it grew past workspace_cap limbs.
+     * Each slot belongs to one function, and none of those reaches itself again while its slot is in use
+     */
+    enum workspace_slot : size_t
+    {
+        multiplication_scratch,
+        product_result,
+        dividend_window,
+        normalised_divisor,
+        partial_quotient,
+        division_scratch,
+        quotient_result,
+        remainder_result,
+        montgomery_operands,
+        montgomery_powers,
+        montgomery_scratch,
+        montgomery_product,
+        montgomery_quotient,
+        workspace_slots
+    };
+
+    constexpr size_t workspace_cap = size_t(1) << 18;
+
+    class workspace_lease final
+    {
+        digits_vector& _buffer;
+
+    public:
+
+        explicit workspace_lease(digits_vector& buffer) noexcept : _buffer(buffer) {}
+
+        workspace_lease(const workspace_lease&) = delete;
+        workspace_lease& operator=(const workspace_lease&) = delete;
+
+        ~workspace_lease()
+        {
+            if (_buffer.capacity() > workspace_cap || _buffer.get_allocator() != digits_vector::allocator_type())
+            {
+                _buffer = digits_vector();
+            }
+        }
+
+        digits_vector& operator*() const noexcept
+        {
+            return _buffer;
+        }
+
+        digits_vector* operator->() const noexcept
+        {
+            return &_buffer;
+        }
+    };
+
+    /** The slot's buffer holding size limbs from the allocator. Only limbs past its previous size are zeroed:
+     *  the callers overwrite what they read
+     */
+    workspace_lease workspace(workspace_slot slot, size_t size, const digits_vector::allocator_type& allocator)
+    {
+        thread_local std::array<digits_vector, workspace_slots> buffers;
+
+        auto& buffer = buffers[slot];
+        if (buffer.get_allocator() != allocator)
+        {
+            buffer = digits_vector(allocator);
+        }
+        buffer.resize(size);
+        return workspace_lease(buffer);
+    }
+
+    /** r[0, an + bn) = a * b by the rule's algorithm, its scratch from the allocator; r must not overlap a or b
+     */
+    void multiply(limb* r, const limb* a, size_t an, const limb* b, size_t bn, big_int::multiplication_rule rule,
+                  const digits_vector::allocator_type& allocator)
+    {
+        if (an < bn)
+        {
+            std::swap(a, b);
+            std::swap(an, bn);
+        }
+
+        std::fill(r, r + an + bn, 0u);
+        if (rule == big_int::multiplication_rule::SchonhageStrassen)
+        {
+            auto scratch = workspace(multiplication_scratch, ntt_scratch_size(an, bn), allocator);
+            mul_ntt(r, a, an, b, bn, scratch->data(), pool_for(bn));
+        }
+        else if (rule == big_int::multiplication_rule::Karatsuba)
+        {
+            auto scratch = workspace(multiplication_scratch, mul_scratch_size(an, bn), allocator);
+            mul(r, a, an, b, bn, scratch->data());
+        }
+        else
+        {
+            mul_basecase(r, a, an, b, bn);
+        }
+    }
+
+    /** result = a * b by whichever kernel fits the sizes
+     */
+    void multiply(digits_vector& result, const limb* a, size_t an, const limb* b, size_t bn)
+    {
+        result.assign(an + bn, 0);
+        multiply(result.data(), a, an, b, bn, std::min(an, bn) >= ntt_threshold
+            ? big_int::multiplication_rule::SchonhageStrassen : big_int::multiplication_rule::Karatsuba,
+            result.get_allocator());
+    }
+
+    /*
+     * Division kernels. They divide a window u[0, n + m) by a normalised (top bit set) divisor v[0, n), n >= 2,
+     * whose top n limbs are below 2v: the quotient is q[0, m) plus a returned top limb of 0 or 1.
+     * The remainder is left in u[0, n) and u[n, n + m) is zeroed.
+     */
+
+    // Quotient and divisor sizes from which recursive division beats Knuth's algorithm, and from which
+    // the Newton reciprocal beats the recursion on a 2n / n division. Measured with mp_os_arthmtc_bg_intgr_benchmarks
+    constexpr size_t burnikel_ziegler_threshold = 48;
+    constexpr size_t newton_threshold = 32000;
+
+    big_int::division_rule division_rule_for(size_t dividend, size_t divisor) noexcept
+    {
+        const size_t quotient = dividend > divisor ? dividend - divisor : 0;
+        const size_t limiting = std::min(quotient, divisor);
+
+        // A reciprocal pays off sooner when several blocks of a long quotient reuse it
+        if (limiting >= newton_threshold || (divisor >= newton_threshold / 4 && quotient > divisor))
+        {
+            return big_int::division_rule::Newton;
+        }
+        if (limiting >= burnikel_ziegler_threshold)
+        {
+            return big_int::division_rule::BurnikelZiegler;
+        }
+        return big_int::division_rule::trivial;
+    }
+
+    /** Returns the carry out of the top limb
+     */
+    bool increment(limb* a, size_t n) noexcept
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (++a[i] != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Returns the borrow out of the top limb
+     */
+    bool decrement(limb* a, size_t n) noexcept
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (a[i]-- != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Knuth's algorithm D (TAOCP 4.3.1): one quotient limb per step, estimated from the top two limbs
+     *  of the window and the divisor, then corrected at most once by adding the divisor back
+     */
+    limb divide_knuth(limb* q, limb* u, const limb* v, size_t n, size_t m) noexcept
+    {
+        limb top = 0;
+        if (compare(u + m, n, v, n) >= 0)
+        {
+            sub(u + m, u + m, n, v, n);
+            top = 1;
+        }
+
+        const unsigned long long v1 = v[n - 1];
+        const unsigned long long v2 = v[n - 2];
+
+        for (size_t j = m; j-- > 0;)
+        {
+            const unsigned long long window = (static_cast<unsigned long long>(u[j + n]) << 32) | u[j + n - 1];
+            unsigned long long q_hat;
+            unsigned long long r_hat;
+            if (u[j + n] >= v1)
+            {
+                q_hat = BASE - 1;
+                r_hat = window - q_hat * v1;
+            }
+            else
+            {
+                q_hat = window / v1;
+                r_hat = window % v1;
+            }
+            while (r_hat < BASE && q_hat * v2 > ((r_hat << 32) | u[j + n - 2]))
+            {
+                --q_hat;
+                r_hat += v1;
+            }
+
+            unsigned long long carry = 0;
+            unsigned long long borrow = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const unsigned long long product = q_hat * v[i] + carry;
+                carry = product >> 32;
+                const unsigned long long diff = static_cast<unsigned long long>(u[i + j]) - static_cast<limb>(product) - borrow;
+                u[i + j] = static_cast<limb>(diff);
+                borrow = diff >> 63;
+            }
+            const unsigned long long diff = static_cast<unsigned long long>(u[j + n]) - carry - borrow;
+            u[j + n] = static_cast<limb>(diff);
+
+            if (diff >> 63)
+            {
+                --q_hat;
+                u[j + n] += add(u + j, u + j, n, v, n);
+            }
+
+            q[j] = static_cast<limb>(q_hat);
+        }
+
+        return top;
+    }
+
+    size_t burnikel_ziegler_scratch_size(size_t n, size_t m) noexcept
+    {
+        if (m < burnikel_ziegler_threshold)
+        {
+            return 0;
+        }
+        const size_t k = m / 2;
+        return std::max({m + 1 + std::max(mul_scratch_size(m - k, k), mul_scratch_size(k, k)),
+                         burnikel_ziegler_scratch_size(n - k, m - k),
+                         burnikel_ziegler_scratch_size(n - k, k)});
+    }
+
+    /** Recursive division (Burnikel and Ziegler; Brent and Zimmermann, "Modern Computer Arithmetic", 1.4.3),
+     *  m <= n. The upper half of the quotient is found from the top of the divisor alone, the low divisor
+     *  limbs are taken into account by one multiplication, and the same is repeated for the lower half
+     */
+    limb divide_recursive(limb* q, limb* u, const limb* v, size_t n, size_t m, limb* scratch) noexcept
+    {
+        if (m < burnikel_ziegler_threshold)
+        {
+            return divide_knuth(q, u, v, n, m);
+        }
+
+        const size_t k = m / 2;
+        limb* product = scratch;
+        limb* next = scratch + m + 1;
+
+        // Upper half: u[2k, n + m) by v[k, n), then subtract q1 * v[0, k) at limb k
+        limb top = divide_recursive(q + k, u + 2 * k, v + k, n - k, m - k, scratch);
+
+        mul(product, q + k, m - k, v, k, next);
+        product[m] = top != 0 ? add(product + m - k, product + m - k, k, v, k) : 0;
+        limb borrow = sub(u + k, u + k, n + 1, product, m + 1);
+        while (borrow != 0)
+        {
+            top -= decrement(q + k, m - k);
+            borrow -= add(u + k, u + k, n + 1, v, n);
+        }
+
+        // Lower half: u[k, n + k) by v[k, n), then subtract q0 * v[0, k)
+        const limb low_top = divide_recursive(q, u + k, v + k, n - k, k, scratch);
+        if (low_top != 0 && increment(q + k, m - k))
+        {
+            ++top;
+        }
+
+        mul(product, q, k, v, k, next);
+        product[2 * k] = low_top != 0 ? add(product + k, product + k, k, v, k) : 0;
+        borrow = sub(u, u, n + 1, product, 2 * k + 1);
+        while (borrow != 0)
+        {
+            top -= decrement(q, m);
+            borrow -= add(u, u, n + 1, v, n);
+        }
+
+        return top;
+    }
+
+    /** x[0, n + 1) ~ (B^2n - 1) / v by Newton's iteration x += x * (B^2n - v * x) / B^2n, doubling the precision
+     *  from a reciprocal of the top n / 2 + 1 limbs. The result may be a few units off; callers correct the quotient
+     */
+    void reciprocal(digits_vector& x, const limb* v, size_t n)
+    {
+        if (n < burnikel_ziegler_threshold)
+        {
+            digits_vector u(2 * n + 1, ~0u, x.get_allocator());
+            u[2 * n] = 0;
+            x.assign(n + 1, 0);
+            divide_knuth(x.data(), u.data(), v, n, n + 1);
+            return;
+        }
+
+        // One guard limb above half keeps the truncation error from growing with the recursion depth
+        const size_t high = n / 2 + 1;
+        const size_t low = n - high;
+
+        digits_vector high_reciprocal(x.get_allocator());
+        reciprocal(high_reciprocal, v + low, high);
+
+        // v * guess where guess = high_reciprocal * B^low
+        digits_vector error(2 * n + 1, 0, x.get_allocator());
+        {
+            digits_vector product(x.get_allocator());
+            multiply(product, v, n, high_reciprocal.data(), high + 1);
+            std::copy(product.begin(), product.end(), error.begin() + low);
+        }
+
+        // error = B^2n - v * guess, kept as magnitude and sign
+        const bool error_negative = error[2 * n] != 0;
+        if (error_negative)
+        {
+            error[2 * n] -= 1;
+        }
+        else
+        {
+            for (size_t i = 0; i < 2 * n; ++i)
+            {
+                error[i] = ~error[i];
+            }
+            increment(error.data(), 2 * n);
+        }
+        const size_t error_size = significant(error.data(), 2 * n + 1);
+
+        // correction = guess * error / B^2n; error limbs below B^(n - low - 2) change it by less than one
+        const size_t dropped = n > low + 2 ? n - low - 2 : 0;
+        digits_vector correction(x.get_allocator());
+        if (error_size > dropped)
+        {
+            multiply(correction, high_reciprocal.data(), high + 1, error.data() + dropped, error_size - dropped);
+        }
+        const size_t shift = 2 * n - low - dropped;
+        const limb* shifted = correction.data() + std::min(shift, correction.size());
+        const size_t shifted_size = correction.size() > shift ? std::min(correction.size() - shift, n + 1) : 0;
+
+        x.assign(n + 1, 0);
+        std::copy(high_reciprocal.begin(), high_reciprocal.end(), x.begin() + low);
+        bool x_negative;
+        add_signed(x.data(), n + 1, x_negative, x.data(), n + 1, false, shifted, shifted_size, error_negative);
+    }
+
+    /** One window of division by a precomputed reciprocal x of v, m <= n. Only the top m + 1 limbs of the window
+     *  and of x take part in the estimate, which is then off by a few units and is corrected against the exact product
+     */
+    void divide_by_reciprocal(limb* q, limb* u, const limb* v, size_t n, size_t m, const digits_vector& x)
+    {
+        digits_vector product(x.get_allocator());
+        multiply(product, u + n - 1, m + 1, x.data() + n - m, m + 1);
+
+        digits_vector estimate(product.begin() + m + 1, product.end(), x.get_allocator());
+
+        digits_vector back(x.get_allocator());
+        multiply(back, estimate.data(), estimate.size(), v, n);
+
+        while (compare(back.data(), back.size(), u, n + m) > 0)
+        {
+            decrement(estimate.data(), estimate.size());
+            sub(back.data(), back.data(), back.size(), v, n);
+        }
+
+        sub(u, u, n + m, back.data(), significant(back.data(), back.size()));
+        while (compare(u, n + m, v, n) >= 0)
+        {
+            increment(estimate.data(), estimate.size());
+            sub(u, u, n + m, v, n);
+        }
+
+        std::copy(estimate.begin(), estimate.begin() + m, q);
+    }
+
+    /** Quotient and remainder of magnitudes a / b, a >= b > 0, by the rule's algorithm; quotient may be null
+     */
+    void divide_magnitudes(const digits_vector& a, const digits_vector& b, big_int::division_rule rule,
+                           digits_vector* quotient, digits_vector& remainder)
+    {
+        const size_t an = a.size();
+        const size_t bn = b.size();
+
+        if (bn == 1)
+        {
+            const unsigned long long divisor = b[0];
+            unsigned long long rest = 0;
+            if (quotient != nullptr)
+            {
+                quotient->assign(an, 0);
+            }
+            for (size_t i = an; i-- > 0;)
+            {
+                const unsigned long long current = (rest << 32) | a[i];
+                if (quotient != nullptr)
+                {
+                    (*quotient)[i] = static_cast<limb>(current / divisor);
+                }
+                rest = current % divisor;
+            }
+            remainder.assign(1, static_cast<limb>(rest));
+            return;
+        }
+
+        // Normalise so that the divisor's top bit is set; the extra dividend limb keeps the top window below it
+        const int shift = std::countl_zero(b.back());
+        const auto allocator = remainder.get_allocator();
+        auto v_lease = workspace(normalised_divisor, bn, allocator);
+        auto u_lease = workspace(dividend_window, an + 1, allocator);
+        auto& v = *v_lease;
+        auto& u = *u_lease;
+        std::copy(b.begin(), b.end(), v.begin());
+        std::copy(a.begin(), a.end(), u.begin());
+        u[an] = 0;
+        if (shift != 0)
+        {
+            shift_left(v.data(), bn, shift);
+            u[an] = shift_left(u.data(), an, shift);
+        }
+
+        const size_t total = an + 1 - bn;
+        auto q_lease = workspace(partial_quotient, total, allocator);
+        auto& q = *q_lease;
+
+        if (rule == big_int::division_rule::trivial)
+        {
+            divide_knuth(q.data(), u.data(), v.data(), bn, total);
+        }
+        else
+        {
+            digits_vector x(allocator);
+            const size_t scratch_size = rule == big_int::division_rule::Newton
+                ? 0 : burnikel_ziegler_scratch_size(bn, std::min(bn, total));
+            auto scratch_lease = workspace(division_scratch, scratch_size, allocator);
+            limb* scratch = scratch_lease->data();
+            if (rule == big_int::division_rule::Newton)
+            {
+                reciprocal(x, v.data(), bn);
+            }
+
+            // Long division in blocks of up to bn quotient limbs, each block a window of the kernels' shape
+            for (size_t position = total; position > 0;)
+            {
+                const size_t block = std::min(bn, position);
+                position -= block;
+                if (rule == big_int::division_rule::Newton)
+                {
+                    divide_by_reciprocal(q.data() + position, u.data() + position, v.data(), bn, block, x);
+                }
+                else
+                {
+                    divide_recursive(q.data() + position, u.data() + position, v.data(), bn, block, scratch);
+                }
+            }
+        }
+
+        remainder.assign(u.begin(), u.begin() + bn);
+        if (shift != 0)
+        {
+            shift_right(remainder.data(), bn, shift);
+        }
+        optimise(remainder);
+
+        if (quotient != nullptr)
+        {
+            *quotient = q;
+            optimise(*quotient);
+        }
+    }
+
+    /** divide_magnitudes for outputs that may be the operands themselves; either output may be null
+     */
+    void divide_digits(const digits_vector& a, const digits_vector& b, big_int::division_rule rule,
+                       digits_vector* quotient, digits_vector* remainder)
+    {
+        auto q = workspace(quotient_result, 0, a.get_allocator());
+        auto r = workspace(remainder_result, 0, a.get_allocator());
+        divide_magnitudes(a, b, rule, quotient != nullptr ? &*q : nullptr, *r);
+
+        if (quotient != nullptr)
+        {
+            *quotient = *q;
+            optimise(*quotient);
+        }
+        if (remainder != nullptr)
+        {
+            *remainder = *r;
+        }
+    }
+
+    /*
+     * Montgomery arithmetic modulo an odd n of k limbs, k even, with R = BASE^k. Short moduli reduce a schoolbook
+     * product (a square takes half the work) a word at a time; long ones reduce a full product with two more
+     * multiplications, so they run at the speed of the multiplication kernels.
+     */
+
+    // From this many limbs in the modulus reducing by full products beats the interleaved loop.
+    // Measured with mp_os_arthmtc_bg_intgr_benchmarks
+    constexpr size_t montgomery_threshold = 192;
+
+    /** -1/n mod 2^64 for odd n; each Newton step doubles the correct low bits from the 3 that n itself gets right
+     */
+    unsigned long long negated_inverse(unsigned long long n) noexcept
+    {
+        unsigned long long x = n;
+        for (int i = 0; i < 5; ++i)
+        {
+            x *= 2 - n * x;
+        }
+        return 0 - x;
+    }
+
+    /** r = t - n if t[0, k) + top * R >= n, else t; the value is below 2n
+     */
+    void montgomery_correct(limb* r, const limb* t, limb top, const limb* n, size_t k) noexcept
+    {
+        if (top != 0 || compare(t, k, n, k) >= 0)
+        {
+            sub(r, t, k, n, k);
+        }
+        else
+        {
+            std::copy(t, t + k, r);
+        }
+    }
+
+    /** r[0, 2n) = a^2 with about half the limb products of mul_basecase: the products below the diagonal
+     *  are summed once and doubled
+     */
+    void square_basecase(limb* r, const limb* a, size_t n) noexcept
+    {
+#ifdef BIG_INT_WORD_KERNELS
+        if (n % 2 == 0)
+        {
+            const size_t words = n / 2;
+            std::fill(r, r + 2 * n, 0u);
+            for (size_t i = 0; i + 1 < words; ++i)
+            {
+                const word multiplier = load_word(a + 2 * i);
+                word carry = 0;
+                for (size_t j = i + 1; j < words; ++j)
+                {
+                    const double_word product = static_cast<double_word>(multiplier) * load_word(a + 2 * j)
+                        + load_word(r + 2 * (i + j)) + carry;
+                    store_word(r + 2 * (i + j), static_cast<word>(product));
+                    carry = static_cast<word>(product >> 64);
+                }
+                store_word(r + 2 * (i + words), carry);
+            }
+
+            shift_left(r, 2 * n, 1);
+
+            word carry = 0;
+            for (size_t i = 0; i < words; ++i)
+            {
+                const word value = load_word(a + 2 * i);
+                const double_word square = static_cast<double_word>(value) * value;
+                double_word sum = static_cast<double_word>(load_word(r + 4 * i)) + static_cast<word>(square) + carry;
+                store_word(r + 4 * i, static_cast<word>(sum));
+                sum = static_cast<double_word>(load_word(r + 4 * i + 2)) + static_cast<word>(square >> 64)
+                    + static_cast<word>(sum >> 64);
+                store_word(r + 4 * i + 2, static_cast<word>(sum));
+                carry = static_cast<word>(sum >> 64);
+            }
+            return;
+        }
+#endif
+        mul_basecase(r, a, n, a, n);
+    }
+
+    /** r[0, k) = t / R mod n for t[0, 2k) < n * R: each step adds the multiple of n that clears the lowest
+     *  remaining word of t. t is overwritten
+     */
+    void montgomery_reduce(limb* r, limb* t, const limb* n, size_t k, unsigned long long inverse) noexcept
+    {
+#ifdef BIG_INT_WORD_KERNELS
+        const size_t words = k / 2;
+        word overflow = 0;
+        for (size_t i = 0; i < words; ++i)
+        {
+            const word m = load_word(t + 2 * i) * inverse;
+            word carry = 0;
+            for (size_t j = 0; j < words; ++j)
+            {
+                const double_word product = static_cast<double_word>(m) * load_word(n + 2 * j)
+                    + load_word(t + 2 * (i + j)) + carry;
+                store_word(t + 2 * (i + j), static_cast<word>(product));
+                carry = static_cast<word>(product >> 64);
+            }
+            const double_word top = static_cast<double_word>(load_word(t + 2 * (i + words))) + carry + overflow;
+            store_word(t + 2 * (i + words), static_cast<word>(top));
+            overflow = static_cast<word>(top >> 64);
+        }
+#else
+        const limb low_inverse = static_cast<limb>(inverse);
+        unsigned long long overflow = 0;
+        for (size_t i = 0; i < k; ++i)
+        {
+            overflow += static_cast<unsigned long long>(t[i + k]) + addmul_1(t + i, n, k, t[i] * low_inverse);
+            t[i + k] = static_cast<limb>(overflow);
+            overflow >>= 32;
+        }
+#endif
+        montgomery_correct(r, t + k, static_cast<limb>(overflow), n, k);
+    }
+
+    /** r[0, k) = a * b / R mod n for a, b < n. t holds 2k limbs of scratch
+     */
+    void montgomery_multiply_basecase(limb* r, const limb* a, const limb* b, const limb* n, size_t k,
+                                      unsigned long long inverse, limb* t) noexcept
+    {
+        if (a == b)
+        {
+            square_basecase(t, a, k);
+        }
+        else
+        {
+            mul_basecase(t, a, k, b, k);
+        }
+        montgomery_reduce(r, t, n, k, inverse);
+    }
+
+    /** montgomery_multiply_basecase for long moduli: with T = a * b and m = T * inverse mod R,
+     *  T + m * n is a multiple of R and the result is its top half
+     */
+    void montgomery_multiply_product(limb* r, const limb* a, const limb* b, const limb* n, size_t k, const limb* inverse,
+                                     const digits_vector::allocator_type& allocator)
+    {
+        const auto rule = k >= ntt_threshold
+            ? big_int::multiplication_rule::SchonhageStrassen : big_int::multiplication_rule::Karatsuba;
+
+        auto product = workspace(montgomery_product, 2 * k, allocator);
+        multiply(product->data(), a, k, b, k, rule, allocator);
+
+        // Only the low half of m matters, but no kernel computes half a product
+        auto m = workspace(montgomery_quotient, 2 * k, allocator);
+        multiply(m->data(), product->data(), k, inverse, k, rule, allocator);
+
+        auto reduction = workspace(montgomery_scratch, 2 * k, allocator);
+        multiply(reduction->data(), m->data(), k, n, k, rule, allocator);
+
+        const limb top = add(product->data(), product->data(), 2 * k, reduction->data(), 2 * k);
+        montgomery_correct(r, product->data() + k, top, n, k);
+    }
+
+    /** r[0, k) = a * b / R mod n for a, b < n; r may alias a or b. inverse is -1/n mod R, of which only the low
+     *  word is read below montgomery_threshold. Scratch comes from the allocator
+     */
+    void montgomery_multiply(limb* r, const limb* a, const limb* b, const limb* n, size_t k, const limb* inverse,
+                             const digits_vector::allocator_type& allocator)
+    {
+        if (k >= montgomery_threshold)
+        {
+            montgomery_multiply_product(r, a, b, n, k, inverse, allocator);
+        }
+        else
+        {
+            const unsigned long long low = inverse[0] | static_cast<unsigned long long>(inverse[1]) << 32;
+            montgomery_multiply_basecase(r, a, b, n, k, low, workspace(montgomery_scratch, 2 * k, allocator)->data());
+        }
+    }
+
+    /** Window width that minimises squarings plus table products for an exponent of the given bit length
+     */
+    size_t exponent_window(size_t bits) noexcept
+    {
+        constexpr size_t limits[] = {6, 23, 79, 239, 671};
+
+        size_t window = 1;
+        while (window <= std::size(limits) && bits > limits[window - 1])
+        {
+            ++window;
+        }
+        return window;
+    }
+
+    /** r[0, k) = base^exponent for base < n in Montgomery form and exponent > 0, by sliding windows
+     *  over a table of odd powers; r must not overlap base
+     */
+    void montgomery_power(limb* r, const limb* base, const limb* exponent, size_t exponent_size,
+                          const limb* n, size_t k, const limb* inverse, const digits_vector::allocator_type& allocator)
+    {
+        auto bit = [exponent](size_t i) {
+            return (exponent[i / 32] >> (i % 32)) & 1;
+        };
+
+        const size_t bits = exponent_size * 32 - std::countl_zero(exponent[exponent_size - 1]);
+        const size_t window = exponent_window(bits);
+        const size_t odd_powers = size_t(1) << (window - 1);
+
+        // base^1, base^3, ..., base^(2 * odd_powers - 1), then base^2
+        auto powers = workspace(montgomery_powers, (odd_powers + 1) * k, allocator);
+        auto& table = *powers;
+        limb* square = table.data() + odd_powers * k;
+        std::copy(base, base + k, table.data());
+        montgomery_multiply(square, base, base, n, k, inverse, allocator);
+        for (size_t i = 1; i < odd_powers; ++i)
+        {
+            montgomery_multiply(table.data() + i * k, table.data() + (i - 1) * k, square, n, k, inverse, allocator);
+        }
+
+        // The top bit is set, so the first window initialises r
+        bool started = false;
+        for (size_t high = bits; high > 0;)
+        {
+            if (bit(high - 1) == 0)
+            {
+                montgomery_multiply(r, r, r, n, k, inverse, allocator);
+                --high;
+                continue;
+            }
+
+            size_t low = high > window ? high - window : 0;
+            while (bit(low) == 0)
+            {
+                ++low;
+            }
+            size_t value = 0;
+            for (size_t i = high; i-- > low;)
+            {
+                value = 2 * value + bit(i);
+            }
+
+            const limb* power = table.data() + value / 2 * k;
+            if (started)
+            {
+                for (size_t i = low; i < high; ++i)
+                {
+                    montgomery_multiply(r, r, r, n, k, inverse, allocator);
+                }
+                montgomery_multiply(r, r, power, n, k, inverse, allocator);
+            }
+            else
+            {
+                std::copy(power, power + k, r);
+                started = true;
+            }
+            high = low;
+        }
+    }
+
+    /*
+     * Greatest common divisor by Lehmer's algorithm: Euclid's steps run on the leading 62 bits of both numbers
+     * for as long as those bits decide the quotients and the cofactors fit a limb, then the full numbers are
+     * combined once with the cofactors, about 31 bits of progress per linear pass instead of one quotient.
+     */
+
+    /** Euclid's steps as (a, b) <- (A a + B b, C a + D b). Each row has one entry >= 0 and one <= 0,
+     *  and all fit a limb; odd is set after an odd number of steps, when the determinant is -1
+     */
+    struct lehmer_cofactors
+    {
+        long long A;
+        long long B;
+        long long C;
+        long long D;
+        bool odd;
+    };
+
+    /** Knuth's algorithm L on the leading bits of a >= b, an >= 3, bn + 1 >= an. False when they decide
+     *  no quotient, as when the first quotient exceeds a limb
+     */
+    bool lehmer_step(const limb* a, size_t an, const limb* b, size_t bn, lehmer_cofactors& cofactors) noexcept
+    {
+        // The leading 62 bits of a and the bits of b at the same positions
+        const int shift = std::countl_zero(a[an - 1]);
+        auto leading = [an, shift](const limb* x, size_t xn) {
+            auto at = [x, xn](size_t i) -> unsigned long long {
+                return i < xn ? x[i] : 0;
+            };
+            const unsigned long long high = at(an - 1) << 32 | at(an - 2);
+            const unsigned long long top = shift == 0 ? high : high << shift | at(an - 3) >> (32 - shift);
+            return static_cast<long long>(top >> 2);
+        };
+
+        constexpr long long limb_max = 0xFFFFFFFF;
+
+        long long x = leading(a, an);
+        long long y = leading(b, bn);
+        long long A = 1, B = 0, C = 0, D = 1;
+        bool odd = false;
+        while (y + C != 0 && y + D != 0)
+        {
+            const long long q = (x + A) / (y + C);
+            if (q != (x + B) / (y + D))
+            {
+                break;
+            }
+
+            const long long next_C = A - q * C;
+            const long long next_D = B - q * D;
+            if (next_C > limb_max || next_C < -limb_max || next_D > limb_max || next_D < -limb_max)
+            {
+                break;
+            }
+
+            A = C;
+            B = D;
+            C = next_C;
+            D = next_D;
+            const long long next_y = x - q * y;
+            x = y;
+            y = next_y;
+            odd = !odd;
+        }
+
+        cofactors = {A, B, C, D, odd};
+        return B != 0;
+    }
+
+    /** r[0, n) = a * x - b * y for a result known not to be negative; r may alias a or b
+     */
+    void mul_sub_1(limb* r, const limb* a, limb x, const limb* b, limb y, size_t n) noexcept
+    {
+        unsigned long long plus_carry = 0;
+        unsigned long long minus_carry = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const unsigned long long plus = static_cast<unsigned long long>(x) * a[i] + plus_carry;
+            const unsigned long long minus = static_cast<unsigned long long>(y) * b[i] + minus_carry;
+            const limb low_plus = static_cast<limb>(plus);
+            const limb low_minus = static_cast<limb>(minus);
+            r[i] = low_plus - low_minus;
+            plus_carry = plus >> 32;
+            minus_carry = (minus >> 32) + (low_plus < low_minus);
+        }
+    }
+
+    /** r[0, n) = a * x + b * y, returning what is carried out of them; r may alias a or b
+     */
+    unsigned long long mul_add_1(limb* r, const limb* a, limb x, const limb* b, limb y, size_t n) noexcept
+    {
+        unsigned long long carry = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const unsigned long long first = static_cast<unsigned long long>(x) * a[i] + static_cast<limb>(carry);
+            const unsigned long long second = static_cast<unsigned long long>(y) * b[i] + (carry >> 32);
+            const unsigned long long low = static_cast<unsigned long long>(static_cast<limb>(first)) + static_cast<limb>(second);
+            r[i] = static_cast<limb>(low);
+            carry = (first >> 32) + (second >> 32) + (low >> 32);
+        }
+        return carry;
+    }
+
+    /** One row of the cofactors: r = first * a + second * b
+     */
+    void combine(limb* r, const limb* a, const limb* b, size_t n, long long first, long long second) noexcept
+    {
+        if (second <= 0)
+        {
+            mul_sub_1(r, a, static_cast<limb>(first), b, static_cast<limb>(-second), n);
+        }
+        else
+        {
+            mul_sub_1(r, b, static_cast<limb>(second), a, static_cast<limb>(-first), n);
+        }
+    }
+
+    /** Pairs of numbers from this many limbs are reduced by half-gcd rather than Lehmer steps; inside it,
+     *  the leading halves of pairs from half_gcd_recursion limbs are reduced recursively.
+     *  Measured with mp_os_arthmtc_bg_intgr_benchmarks
+     */
+    constexpr size_t half_gcd_threshold = 640;
+    constexpr size_t half_gcd_recursion = 128;
+
+    /*
+     * Radix conversion. Digits are grouped into chunks of as many digits as fit a limb (9 for radix 10), and
+     * numbers are split in halves at cached powers (radix^chunk)^(2^level), so both directions cost
+     * O(M(n) log n) instead of one full-size division or multiplication per digit.
+     * Power-of-two radixes are plain bit repacking.
+     */
+
+    constexpr std::string_view digit_symbols = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+    // Below this many chunks (parsing) or limbs (printing) the quadratic single-limb loops win
+    constexpr size_t conversion_threshold = 32;
+
+    void check_radix(unsigned int radix)
+    {
+        if (radix < 2 || radix > 36)
+        {
+            throw std::invalid_argument("Radix must be between 2 and 36");
+        }
+    }
+
+    struct radix_chunk
+    {
+        size_t digits;
+        limb value;
+    };
+
+    constexpr radix_chunk chunk_for(unsigned int radix) noexcept
+    {
+        radix_chunk chunk{1, radix};
+        while (static_cast<unsigned long long>(chunk.value) * radix < BASE)
+        {
+            chunk.value *= radix;
+            ++chunk.digits;
+        }
+        return chunk;
+    }
+
+    /** (radix^chunk)^(2^level), computed once per radix and level for the whole process
+     */
+    const digits_vector& radix_power(unsigned int radix, size_t level)
+    {
+        static std::mutex mutex;
+        static std::map<unsigned int, std::deque<digits_vector>> cache;
+
+        std::lock_guard lock(mutex);
+        auto& powers = cache[radix];
+        if (powers.empty())
+        {
+            powers.emplace_back(1, chunk_for(radix).value);
+        }
+        while (powers.size() <= level)
+        {
+            digits_vector square;
+            multiply(square, powers.back().data(), powers.back().size(), powers.back().data(), powers.back().size());
+            optimise(square);
+            powers.push_back(std::move(square));
+        }
+        return powers[level];
+    }
+
+    limb digit_value(char symbol, unsigned int radix)
     {
-        while (digits.size() > 1 && digits.back() == 0)
+        unsigned int value = radix;
+        if (symbol >= '0' && symbol <= '9')
         {
-            digits.pop_back();
+            value = symbol - '0';
+        }
+        else if (symbol >= 'a' && symbol <= 'z')
+        {
+            value = symbol - 'a' + 10;
+        }
+        else if (symbol >= 'A' && symbol <= 'Z')
+        {
+            value = symbol - 'A' + 10;
+        }
+
+        if (value >= radix)
+        {
+            throw std::invalid_argument("Invalid character in number string");
         }
+        return value;
     }
 
-    bool is_zero(const std::vector<unsigned int, pp_allocator<unsigned int>>& digits)
+    void parse_power_of_two(digits_vector& result, std::string_view text, unsigned int radix)
     {
-        return digits.size() == 1 && digits[0] == 0;
+        const int bits = std::countr_zero(radix);
+        result.assign((text.size() * bits + 31) / 32, 0);
+
+        size_t position = 0;
+        for (size_t i = text.size(); i-- > 0; position += bits)
+        {
+            const unsigned long long value = digit_value(text[i], radix);
+            result[position / 32] |= static_cast<limb>(value << (position % 32));
+            if (position % 32 + bits > 32)
+            {
+                result[position / 32 + 1] |= static_cast<limb>(value >> (32 - position % 32));
+            }
+        }
+    }
+
+    void parse_chunks(digits_vector& result, std::string_view text, unsigned int radix, const radix_chunk& chunk)
+    {
+        const size_t chunks = (text.size() + chunk.digits - 1) / chunk.digits;
+
+        if (chunks <= conversion_threshold)
+        {
+            // result = result * radix^digits + chunk, leftmost chunk taking the odd remainder of digits
+            result.assign(1, 0);
+            size_t taken = text.size() - (chunks - 1) * chunk.digits;
+            for (size_t begin = 0; begin < text.size(); begin += taken, taken = chunk.digits)
+            {
+                limb value = 0;
+                limb multiplier = 1;
+                for (size_t i = begin; i < begin + taken; ++i)
+                {
+                    value = value * radix + digit_value(text[i], radix);
+                    multiplier *= radix;
+                }
+
+                unsigned long long carry = value;
+                for (auto& digit : result)
+                {
+                    carry += static_cast<unsigned long long>(digit) * multiplier;
+                    digit = static_cast<limb>(carry);
+                    carry >>= 32;
+                }
+                if (carry != 0)
+                {
+                    result.push_back(static_cast<limb>(carry));
+                }
+            }
+            return;
+        }
+
+        // The low half is the largest power-of-two number of chunks below the total
+        const size_t level = std::bit_width(chunks - 1) - 1;
+        const size_t low_digits = chunk.digits << level;
+
+        digits_vector high(result.get_allocator());
+        digits_vector low(result.get_allocator());
+        parse_chunks(high, text.substr(0, text.size() - low_digits), radix, chunk);
+        parse_chunks(low, text.substr(text.size() - low_digits), radix, chunk);
+
+        const auto& power = radix_power(radix, level);
+        multiply(result, high.data(), high.size(), power.data(), power.size());
+        add_into(result.data(), result.size(), low.data(), low.size());
+        optimise(result);
+    }
+
+    void print_power_of_two(std::string& out, const digits_vector& value, unsigned int radix)
+    {
+        const int bits = std::countr_zero(radix);
+        const size_t total_bits = value.size() * 32 - std::countl_zero(value.back());
+        const size_t symbols = (total_bits + bits - 1) / bits;
+
+        for (size_t i = symbols; i-- > 0;)
+        {
+            const size_t position = i * bits;
+            unsigned long long window = value[position / 32];
+            if (position / 32 + 1 < value.size())
+            {
+                window |= static_cast<unsigned long long>(value[position / 32 + 1]) << 32;
+            }
+            out.push_back(digit_symbols[(window >> (position % 32)) & (radix - 1)]);
+        }
+    }
+
+    /** Quadratic conversion of a short value: repeated single-limb division by radix^chunk. Radix 10 is instantiated
+     *  with constant divisors, which the compiler turns into multiplications
+     */
+    template<unsigned int Radix = 0>
+    void print_basecase(std::string& out, const limb* value, size_t n, unsigned int radix, const radix_chunk& chunk, size_t width)
+    {
+        constexpr radix_chunk fixed = chunk_for(Radix != 0 ? Radix : 2);
+        const unsigned long long divisor = Radix != 0 ? fixed.value : chunk.value;
+        const size_t digits = Radix != 0 ? fixed.digits : chunk.digits;
+        const unsigned int base = Radix != 0 ? Radix : radix;
+
+        limb rest[conversion_threshold];
+        std::copy(value, value + n, rest);
+
+        char symbols[conversion_threshold * 32];
+        size_t count = 0;
+        while (n != 0)
+        {
+            unsigned long long remainder = 0;
+            for (size_t i = n; i-- > 0;)
+            {
+                const unsigned long long current = (remainder << 32) | rest[i];
+                rest[i] = static_cast<limb>(current / divisor);
+                remainder = current % divisor;
+            }
+            n = significant(rest, n);
+
+            for (size_t i = 0; i < digits; ++i)
+            {
+                symbols[count++] = digit_symbols[remainder % base];
+                remainder /= base;
+            }
+        }
+
+        while (count != 0 && symbols[count - 1] == '0')
+        {
+            --count;
+        }
+        if (width > count)
+        {
+            out.append(width - count, '0');
+        }
+        while (count != 0)
+        {
+            out.push_back(symbols[--count]);
+        }
+    }
+
+    /** Appends the digits of value, left-padded with zeros to width symbols when width is not 0
+     */
+    void print_chunks(std::string& out, const limb* value, size_t n, unsigned int radix, const radix_chunk& chunk, size_t width)
+    {
+        n = significant(value, n);
+
+        if (n <= conversion_threshold)
+        {
+            if (radix == 10)
+            {
+                print_basecase<10>(out, value, n, radix, chunk, width);
+            }
+            else
+            {
+                print_basecase(out, value, n, radix, chunk, width);
+            }
+            return;
+        }
+
+        // Split at a cached power with about half the limbs of the value; each level doubles the size
+        size_t level = 0;
+        while (radix_power(radix, level).size() * 4 <= n)
+        {
+            ++level;
+        }
+        const auto& power = radix_power(radix, level);
+        const size_t low_width = chunk.digits << level;
+
+        digits_vector numerator(value, value + n);
+        digits_vector quotient;
+        digits_vector remainder;
+        divide_magnitudes(numerator, power, division_rule_for(n, power.size()), &quotient, remainder);
+
+        print_chunks(out, quotient.data(), quotient.size(), radix, chunk, width > low_width ? width - low_width : 0);
+        print_chunks(out, remainder.data(), remainder.size(), radix, chunk, low_width);
     }
 }
 
@@ -31,23 +2442,23 @@ big_int::multiplication_rule big_int::decide_mult(size_t rhs) const noexcept
     // return multiplication_rule::Karatsuba;
      
 
-    const size_t threshold = 64;
-
-    if (_digits.size() > threshold || rhs > threshold) {
+    if (std::min(_digits.size(), rhs) >= ntt_threshold) {
+        return multiplication_rule::SchonhageStrassen;
+    }
+    if (std::min(_digits.size(), rhs) >= karatsuba_threshold) {
         return multiplication_rule::Karatsuba;
     }
     return multiplication_rule::trivial;
 
 }
 
-big_int::division_rule big_int::decide_div(size_t) const noexcept
+big_int::division_rule big_int::decide_div(size_t rhs) const noexcept
 {
-
-    return division_rule::trivial;
+    return division_rule_for(_digits.size(), rhs);
 }
 
 big_int::big_int(const std::vector<unsigned int, pp_allocator<unsigned int>>& digits, bool sign)
-    : _sign(sign), _digits(digits)
+    : _sign(sign), _digits(digits.begin(), digits.end(), digits.get_allocator())
 {
     if (_digits.empty())
     {
@@ -69,27 +2480,19 @@ big_int::big_int(std::vector<unsigned int, pp_allocator<unsigned int>>&& digits,
 big_int::big_int(const std::string& num, unsigned int radix, pp_allocator<unsigned int> allocator)
     : _sign(true), _digits(allocator)
 {
-    if (num.empty())
-    {
-        _digits.push_back(0);
-        return;
-    }
+    check_radix(radix);
 
-    std::string number = num;
+    std::string_view number = num;
     bool is_negative = false;
-    if (number[0] == '-')
-    {
-        is_negative = true;
-        number = number.substr(1);
-    }
-    else if (number[0] == '+')
+    if (!number.empty() && (number[0] == '-' || number[0] == '+'))
     {
-        number = number.substr(1);
+        is_negative = number[0] == '-';
+        number.remove_prefix(1);
     }
 
     while (number.size() > 1 && number[0] == '0')
     {
-        number = number.substr(1);
+        number.remove_prefix(1);
     }
 
     if (number.empty())
@@ -98,17 +2501,15 @@ big_int::big_int(const std::string& num, unsigned int radix, pp_allocator<unsign
         return;
     }
 
-    _digits.push_back(0);
-    for (char c : number)
+    if (std::has_single_bit(radix))
     {
-        if (!std::isdigit(c))
-        {
-            throw std::invalid_argument("Invalid character in number string");
-        }
-        unsigned int digit = c - '0';
-        *this *= 10;
-        *this += big_int(static_cast<long long>(digit), allocator);
+        parse_power_of_two(_digits, number, radix);
+    }
+    else
+    {
+        parse_chunks(_digits, number, radix, chunk_for(radix));
     }
+    optimise(_digits);
 
     _sign = !is_negative;
 
@@ -129,6 +2530,36 @@ big_int::operator bool() const noexcept
     return !is_zero(_digits);
 }
 
+size_t big_int::bit_width() const noexcept
+{
+    return (_digits.size() - 1) * 32 + std::bit_width(_digits.back());
+}
+
+size_t big_int::countr_zero() const noexcept
+{
+    size_t i = 0;
+    while (i < _digits.size() && _digits[i] == 0)
+    {
+        ++i;
+    }
+    return i == _digits.size() ? 0 : i * 32 + std::countr_zero(_digits[i]);
+}
+
+unsigned long long big_int::leading_bits() const noexcept
+{
+    // The top three limbs hold at least 65 bits of a number that long
+    unsigned long long top[3] = {};
+    const size_t n = std::min<size_t>(_digits.size(), 3);
+    for (size_t i = 0; i < n; ++i)
+    {
+        top[i] = _digits[_digits.size() - 1 - i];
+    }
+
+    const int shift = std::countl_zero(_digits.back());
+    const unsigned long long high = top[0] << 32 | top[1];
+    return shift == 0 ? high : high << shift | top[2] >> (32 - shift);
+}
+
 big_int& big_int::operator++() &
 {
     *this += big_int(1, _digits.get_allocator());
@@ -155,266 +2586,139 @@ big_int big_int::operator--(int)
     return temp;
 }
 
-big_int& big_int::plus_assign(const big_int& other, size_t shift) &
+void big_int::accumulate(const unsigned int* other, size_t other_size, bool other_sign, size_t shift)
 {
-    if (other._digits.size() == 1 && other._digits[0] == 0)
-    {
-        return *this;
-    }
-
-    if (_sign == other._sign)
+    if (_sign == other_sign)
     {
-        size_t max_size = std::max(_digits.size(), other._digits.size() + shift);
-        _digits.resize(max_size, 0);
-
-        unsigned long long carry = 0;
-        for (size_t i = 0; i < max_size; ++i)
+        if (_digits.size() < other_size + shift)
         {
-            unsigned long long sum = carry;
-            if (i < _digits.size())
-            {
-                sum += _digits[i];
-            }
-            if (i >= shift && (i - shift) < other._digits.size())
-            {
-                sum += other._digits[i - shift];
-            }
-            _digits[i] = static_cast<unsigned int>(sum % BASE);
-            carry = sum / BASE;
+            _digits.resize(other_size + shift, 0);
         }
-        if (carry > 0)
+
+        limb* digits = _digits.data() + shift;
+        const limb carry = add(digits, digits, _digits.size() - shift, other, other_size);
+        if (carry != 0)
         {
-            _digits.push_back(static_cast<unsigned int>(carry));
+            _digits.push_back(carry);
         }
+        return;
     }
-    else
+
+    // Both ranges are normalised, so lengths decide unless they match; then the top other_size limbs do,
+    // and when those are equal too the low shift limbs of this
+    const size_t size = _digits.size();
+    int order = size < other_size + shift ? -1 : size > other_size + shift ? 1 : 0;
+    if (order == 0)
     {
-        big_int temp(other);
-        temp._sign = _sign;
-        minus_assign(temp, shift);
+        order = compare(_digits.data() + shift, other_size, other, other_size);
     }
-
-    optimise(_digits);
-    return *this;
-}
-
-big_int& big_int::operator+=(const big_int& other) &
-{
-    return plus_assign(other, 0);
-}
-
-big_int& big_int::minus_assign(const big_int& other, size_t shift) &
-{
-    if (other._digits.size() == 1 && other._digits[0] == 0)
+    if (order == 0)
     {
-        return *this;
+        order = significant(_digits.data(), shift) != 0 ? 1 : 0;
     }
 
-    if (_sign != other._sign)
+    if (order == 0)
     {
-        big_int temp(other);
-        temp._sign = _sign;
-        return plus_assign(temp, shift);
+        _digits.assign(1, 0);
+        _sign = true;
+        return;
     }
 
-    big_int abs_this(*this);
-    abs_this._sign = true;
-    big_int abs_other(other);
-    abs_other._sign = true;
-    abs_other <<= shift;
-
-    auto cmp = (abs_this <=> abs_other);
-    bool result_sign = _sign;
-    if (cmp == std::strong_ordering::less)
+    limb* digits = _digits.data();
+    if (order > 0)
     {
-        result_sign = !result_sign;
-        std::vector<unsigned int, pp_allocator<unsigned int>> temp_digits = abs_other._digits;
-        abs_other._digits = abs_this._digits;
-        abs_this._digits = temp_digits;
+        sub(digits + shift, digits + shift, size - shift, other, other_size);
     }
-
-    size_t max_size = std::max(abs_this._digits.size(), abs_other._digits.size());
-    std::vector<unsigned int, pp_allocator<unsigned int>> result(max_size, 0, _digits.get_allocator());
-    long long borrow = 0;
-
-    for (size_t i = 0; i < max_size; ++i)
+    else
     {
-        long long diff = borrow;
-        if (i < abs_this._digits.size())
-        {
-            diff += abs_this._digits[i];
-        }
-        if (i < abs_other._digits.size())
-        {
-            diff -= abs_other._digits[i];
-        }
-        if (diff < 0)
+        // other * B^shift - this in place: the low shift limbs are negated, the rest subtracted from other
+        _digits.resize(other_size + shift, 0);
+        digits = _digits.data();
+
+        const bool low_borrow = significant(digits, shift) != 0;
+        if (low_borrow)
         {
-            diff += BASE;
-            borrow = -1;
+            std::transform(digits, digits + shift, digits, [](limb digit) { return ~digit; });
+            increment(digits, shift);
         }
-        else
+        sub(digits + shift, other, other_size, digits + shift, other_size);
+        if (low_borrow)
         {
-            borrow = 0;
+            decrement(digits + shift, other_size);
         }
-        result[i] = static_cast<unsigned int>(diff);
+        _sign = other_sign;
     }
 
-    _digits = std::move(result);
-    _sign = result_sign;
     optimise(_digits);
+}
 
-    if (is_zero(_digits))
+big_int& big_int::plus_assign(const big_int& other, size_t shift) &
+{
+    if (is_zero(other._digits))
     {
-        _sign = true;
+        return *this;
     }
 
+    if (&other == this)
+    {
+        return plus_assign(big_int(other), shift);
+    }
+
+    accumulate(other._digits.data(), other._digits.size(), other._sign, shift);
     return *this;
 }
 
-big_int& big_int::operator-=(const big_int& other) &
+big_int& big_int::operator+=(const big_int& other) &
 {
-    return minus_assign(other, 0);
+    return plus_assign(other, 0);
 }
 
-big_int& big_int::multiply_assign(const big_int& other, multiplication_rule rule) &
+big_int& big_int::minus_assign(const big_int& other, size_t shift) &
 {
     if (is_zero(other._digits))
     {
-        _digits.clear();
-        _digits.push_back(0);
-        _sign = true;
         return *this;
     }
 
-    if (is_zero(_digits))
+    if (&other == this)
     {
-        return *this;
+        return minus_assign(big_int(other), shift);
     }
 
-    if (rule == multiplication_rule::Karatsuba) {
-        size_t n = std::max(_digits.size(), other._digits.size());
-        size_t m = n / 2 + (n % 2);
-        
-        if (n <= 4) {
-            return multiply_assign(other, multiplication_rule::trivial);
-        }
-        
-        std::vector<unsigned int, pp_allocator<unsigned int>> a_high(_digits.get_allocator());
-        std::vector<unsigned int, pp_allocator<unsigned int>> a_low(_digits.get_allocator());
-        std::vector<unsigned int, pp_allocator<unsigned int>> b_high(other._digits.get_allocator());
-        std::vector<unsigned int, pp_allocator<unsigned int>> b_low(other._digits.get_allocator());
-        
-        if (_digits.size() <= m) {
-            a_low = _digits;
-            a_high.push_back(0);
-        } else {
-            a_low.assign(_digits.begin(), _digits.begin() + m);
-            a_high.assign(_digits.begin() + m, _digits.end());
-        }
-        
-        if (other._digits.size() <= m) {
-            b_low = other._digits;
-            b_high.push_back(0);
-        } else {
-            b_low.assign(other._digits.begin(), other._digits.begin() + m);
-            b_high.assign(other._digits.begin() + m, other._digits.end());
-        }
-        
-        optimise(a_low);
-        optimise(a_high);
-        optimise(b_low);
-        optimise(b_high);
-        
-        big_int z0(a_low, true);
-        z0.multiply_assign(big_int(b_low, true), multiplication_rule::trivial);
-        
-        big_int z2(a_high, true);
-        z2.multiply_assign(big_int(b_high, true), multiplication_rule::trivial);
-        
-        big_int a_sum(a_low, true);
-        a_sum += big_int(a_high, true);
-        
-        big_int b_sum(b_low, true);
-        b_sum += big_int(b_high, true);
-        
-        big_int z1(a_sum);
-        z1.multiply_assign(b_sum, multiplication_rule::trivial);
-        z1 -= z0;
-        z1 -= z2;
-        
-        std::vector<unsigned int, pp_allocator<unsigned int>> result(_digits.get_allocator());
-        result.resize(n * 2, 0);
-        
-        for (size_t i = 0; i < z0._digits.size(); ++i) {
-            result[i] = z0._digits[i];
-        }
-        
-        for (size_t i = 0; i < z1._digits.size(); ++i) {
-            unsigned long long temp = static_cast<unsigned long long>(result[i + m]) + z1._digits[i];
-            result[i + m] = static_cast<unsigned int>(temp % BASE);
-            if (temp >= BASE) {
-                unsigned long long carry = temp / BASE;
-                size_t j = i + m + 1;
-                while (carry > 0 && j < result.size()) {
-                    unsigned long long next = static_cast<unsigned long long>(result[j]) + carry;
-                    result[j] = static_cast<unsigned int>(next % BASE);
-                    carry = next / BASE;
-                    j++;
-                }
-                if (carry > 0) {
-                    result.push_back(static_cast<unsigned int>(carry));
-                }
-            }
-        }
-                
-        for (size_t i = 0; i < z2._digits.size(); ++i) {
-            unsigned long long temp = static_cast<unsigned long long>(result[i + 2*m]) + z2._digits[i];
-            result[i + 2*m] = static_cast<unsigned int>(temp % BASE);
-            if (temp >= BASE) {
-                unsigned long long carry = temp / BASE;
-                size_t j = i + 2*m + 1;
-                while (carry > 0 && j < result.size()) {
-                    unsigned long long next = static_cast<unsigned long long>(result[j]) + carry;
-                    result[j] = static_cast<unsigned int>(next % BASE);
-                    carry = next / BASE;
-                    j++;
-                }
-                if (carry > 0) {
-                    result.push_back(static_cast<unsigned int>(carry));
-                }
-            }
-        }
-        
-        _sign = (_sign == other._sign);
-        _digits = std::move(result);
-        optimise(_digits);
-        return *this;
-    }
-    else { 
-        big_int result(_digits.get_allocator());
-        result._digits.resize(_digits.size() + other._digits.size(), 0);
+    accumulate(other._digits.data(), other._digits.size(), !other._sign, shift);
+    return *this;
+}
+
+big_int& big_int::operator-=(const big_int& other) &
+{
+    return minus_assign(other, 0);
+}
+
+big_int& big_int::multiply_assign(const big_int& other, multiplication_rule rule) &
+{
+    mul(*this, *this, other, rule);
+    return *this;
+}
 
-        for (size_t i = 0; i < _digits.size(); ++i)
+big_int& big_int::multiply_assign(const big_int& other, multiplication_rule rule, big_int_thread_pool& pool) &
+{
+    struct scope
+    {
+        big_int_thread_pool* previous = local_pool;
+        ~scope()
         {
-            unsigned long long carry = 0;
-            for (size_t j = 0; j < other._digits.size() || carry; ++j)
-            {
-                unsigned long long product = result._digits[i + j] + carry;
-                if (j < other._digits.size())
-                {
-                    product += static_cast<unsigned long long>(_digits[i]) * other._digits[j];
-                }
-                result._digits[i + j] = static_cast<unsigned int>(product % BASE);
-                carry = product / BASE;
-            }
+            local_pool = previous;
         }
+    } restore;
 
-        _sign = (_sign == other._sign);
-        _digits = std::move(result._digits);
-        optimise(_digits);
-        return *this;
-    }
+    local_pool = &pool;
+    return multiply_assign(other, rule);
+}
+
+void big_int::parallel_multiplication(big_int_thread_pool* pool, size_t threshold)
+{
+    shared_pool_threshold.store(threshold, std::memory_order_relaxed);
+    shared_pool.store(pool, std::memory_order_release);
 }
 
 big_int& big_int::operator*=(const big_int& other) &
@@ -439,108 +2743,171 @@ big_int& big_int::divide_assign(const big_int& other, division_rule rule) &
         return *this;
     }
 
-    big_int abs_this(*this);
-    abs_this._sign = true;
-    big_int abs_other(other);
-    abs_other._sign = true;
-
-    if (abs_this < abs_other)
+    if (compare(_digits.data(), _digits.size(), other._digits.data(), other._digits.size()) < 0)
     {
         _digits.clear();
         _digits.push_back(0);
         _sign = true;
         return *this;
     }
-    
-    std::vector<unsigned int, pp_allocator<unsigned int>> quotient(_digits.size() - other._digits.size() + 1, 0, _digits.get_allocator());
-    big_int remainder(_digits.get_allocator());
-    remainder._digits.clear();
-    remainder._digits.push_back(0);
-    
-    for (int i = static_cast<int>(_digits.size()) - 1; i >= 0; --i)
+
+    const bool sign = (_sign == other._sign);
+    divide_digits(_digits, other._digits, rule, &_digits, nullptr);
+
+    _sign = sign;
+    optimise(_digits);
+    if (is_zero(_digits))
     {
-        remainder._digits.insert(remainder._digits.begin(), _digits[i]);
-        optimise(remainder._digits);
+        _sign = true;
+    }
     
-        if (remainder < abs_other)
-        {
-            if (i < static_cast<int>(quotient.size()))
-                quotient[i] = 0;
-            continue;
-        }
+    return *this;
+}
 
-        unsigned long long left = 0, right = BASE - 1;
-        unsigned long long q = 0;
-        while (left <= right)
-        {
-            unsigned long long mid = left + (right - left) / 2;
-            big_int temp(abs_other);
-            temp *= big_int(static_cast<long long>(mid), _digits.get_allocator());
-            if (remainder >= temp)
-            {
-                q = mid;
-                left = mid + 1;
-            }
-            else
-            {
-                right = mid - 1;
-            }
-        }
 
-    
-        if (q > 0)
-        {
-            big_int temp(abs_other);
-            temp *= big_int(static_cast<long long>(q), _digits.get_allocator());
-            remainder -= temp;
-        }
+big_int& big_int::operator/=(const big_int& other) &
+{
+    return divide_assign(other, decide_div(other._digits.size()));
+}
+
+
+big_int& big_int::operator%=(const big_int& other) &
+{
+    return modulo_assign(other, decide_div(other._digits.size()));
+}
+
+void add(big_int& out, const big_int& a, const big_int& b)
+{
+    if (&out == &b)
+    {
+        out.plus_assign(a);
+        return;
+    }
+
+    if (&out != &a)
+    {
+        out._digits.reserve(std::max(a._digits.size(), b._digits.size()) + 1);
+        out = a;
+    }
+    out.plus_assign(b);
+}
 
-    
-        if (i < static_cast<int>(quotient.size()))
-            quotient[i] = static_cast<unsigned int>(q);
+void sub(big_int& out, const big_int& a, const big_int& b)
+{
+    if (&out == &b && &out != &a)
+    {
+        // a - out = -(out - a)
+        out.minus_assign(a);
+        out._sign = !out._sign || is_zero(out._digits);
+        return;
     }
 
-    _digits = std::move(quotient);
-    _sign = (_sign == other._sign);
-    optimise(_digits);
-    if (is_zero(_digits))
+    if (&out != &a)
     {
-        _sign = true;
+        out._digits.reserve(std::max(a._digits.size(), b._digits.size()) + 1);
+        out = a;
     }
-    
-    return *this;
+    out.minus_assign(b);
 }
 
+void mul(big_int& out, const big_int& a, const big_int& b)
+{
+    mul(out, a, b, a.decide_mult(b._digits.size()));
+}
 
-big_int& big_int::operator/=(const big_int& other) &
+void mul(big_int& out, const big_int& a, const big_int& b, big_int::multiplication_rule rule)
 {
-    return divide_assign(other, decide_div(other._digits.size()));
+    if (is_zero(a._digits) || is_zero(b._digits))
+    {
+        out._digits.assign(1, 0);
+        out._sign = true;
+        return;
+    }
+
+    const bool sign = (a._sign == b._sign);
+    const size_t size = a._digits.size() + b._digits.size();
+    if (&out != &a && &out != &b)
+    {
+        out._digits.resize(size);
+        multiply(out._digits.data(), a._digits.data(), a._digits.size(), b._digits.data(), b._digits.size(), rule,
+                 out._digits.get_allocator());
+    }
+    else
+    {
+        auto product = workspace(product_result, size, out._digits.get_allocator());
+        multiply(product->data(), a._digits.data(), a._digits.size(), b._digits.data(), b._digits.size(), rule,
+                 out._digits.get_allocator());
+        out._digits = *product;
+    }
+
+    out._sign = sign;
+    optimise(out._digits);
 }
 
+void addmul(big_int& out, const big_int& a, const big_int& b)
+{
+    if (is_zero(a._digits) || is_zero(b._digits))
+    {
+        return;
+    }
+
+    const size_t an = a._digits.size();
+    const size_t bn = b._digits.size();
+    auto product = workspace(product_result, an + bn, out._digits.get_allocator());
+    multiply(product->data(), a._digits.data(), an, b._digits.data(), bn, a.decide_mult(bn), out._digits.get_allocator());
 
-big_int& big_int::operator%=(const big_int& other) &
+    out.accumulate(product->data(), significant(product->data(), an + bn), a._sign == b._sign, 0);
+}
+
+void divmod(big_int& quotient, big_int& remainder, const big_int& a, const big_int& b)
 {
-    return modulo_assign(other, decide_div(other._digits.size()));
+    divmod(quotient, remainder, a, b, a.decide_div(b._digits.size()));
+}
+
+void divmod(big_int& quotient, big_int& remainder, const big_int& a, const big_int& b, big_int::division_rule rule)
+{
+    if (is_zero(b._digits))
+    {
+        throw std::logic_error("Division by zero");
+    }
+
+    const bool quotient_sign = (a._sign == b._sign);
+    const bool remainder_sign = a._sign;
+
+    // |a| < |b| leaves a positive remainder of |a|, as operator%= does
+    if (compare(a._digits.data(), a._digits.size(), b._digits.data(), b._digits.size()) < 0)
+    {
+        remainder = a;
+        remainder._sign = true;
+        quotient._digits.assign(1, 0);
+        quotient._sign = true;
+        return;
+    }
+
+    divide_digits(a._digits, b._digits, rule, &quotient._digits, &remainder._digits);
+
+    quotient._sign = quotient_sign || is_zero(quotient._digits);
+    remainder._sign = remainder_sign || is_zero(remainder._digits);
 }
 
 big_int big_int::operator+(const big_int& other) const
 {
-    big_int result(*this);
-    result += other;
+    big_int result(_digits.get_allocator());
+    add(result, *this, other);
     return result;
 }
 
 big_int big_int::operator-(const big_int& other) const
 {
-    big_int result(*this);
-    result -= other;
+    big_int result(_digits.get_allocator());
+    sub(result, *this, other);
     return result;
 }
 
 big_int big_int::operator*(const big_int& other) const
 {
-    big_int result(*this);
-    result *= other;
+    big_int result(_digits.get_allocator());
+    mul(result, *this, other);
     return result;
 }
 
@@ -644,16 +3011,10 @@ big_int& big_int::operator<<=(size_t shift) &
 
     if (bit_shift > 0)
     {
-        unsigned long long carry = 0;
-        for (size_t i = 0; i < _digits.size(); ++i)
-        {
-            unsigned long long value = (static_cast<unsigned long long>(_digits[i]) << bit_shift) | carry;
-            _digits[i] = static_cast<unsigned int>(value % BASE);
-            carry = value / BASE;
-        }
+        const limb carry = shift_left(_digits.data() + word_shift, _digits.size() - word_shift, static_cast<int>(bit_shift));
         if (carry > 0)
         {
-            _digits.push_back(static_cast<unsigned int>(carry));
+            _digits.push_back(carry);
         }
     }
 
@@ -685,13 +3046,7 @@ big_int& big_int::operator>>=(size_t shift) &
 
     if (bit_shift > 0)
     {
-        unsigned long long carry = 0;
-        for (int i = static_cast<int>(_digits.size()) - 1; i >= 0; --i)
-        {
-            unsigned long long value = (carry << (8 * sizeof(unsigned int))) | _digits[i];
-            _digits[i] = static_cast<unsigned int>(value >> bit_shift);
-            carry = (value & ((1ULL << bit_shift) - 1));
-        }
+        shift_right(_digits.data(), _digits.size(), static_cast<int>(bit_shift));
     }
 
     optimise(_digits);
@@ -719,28 +3074,20 @@ big_int big_int::operator>>(size_t shift) const
 big_int big_int::operator~() const
 {
     big_int result(*this);
-    for (auto& digit : result._digits)
-    {
-        digit = ~digit;
-    }
+    bitwise<'~'>(result._digits.data(), nullptr, result._digits.size());
     optimise(result._digits);
     return result;
 }
 
 big_int& big_int::operator&=(const big_int& other) &
 {
-    size_t max_size = std::max(_digits.size(), other._digits.size());
-    _digits.resize(max_size, 0);
-    
-    for (size_t i = 0; i < max_size; ++i)
+    // Limbs above the shorter operand are and-ed with zero
+    if (_digits.size() > other._digits.size())
     {
-        if (i < other._digits.size()) {
-            _digits[i] &= other._digits[i];
-        } else {
-            _digits[i] = 0; 
-        }
+        _digits.resize(other._digits.size());
     }
-    
+    bitwise<'&'>(_digits.data(), other._digits.data(), _digits.size());
+
     optimise(_digits);
     return *this;
 }
@@ -749,12 +3096,8 @@ big_int& big_int::operator|=(const big_int& other) &
 {
     size_t max_size = std::max(_digits.size(), other._digits.size());
     _digits.resize(max_size, 0);
-    
-    for (size_t i = 0; i < other._digits.size(); ++i)
-    {
-        _digits[i] |= other._digits[i];
-    }
-    
+    bitwise<'|'>(_digits.data(), other._digits.data(), other._digits.size());
+
     optimise(_digits);
     return *this;
 }
@@ -763,12 +3106,8 @@ big_int& big_int::operator^=(const big_int& other) &
 {
     size_t max_size = std::max(_digits.size(), other._digits.size());
     _digits.resize(max_size, 0);
-    
-    for (size_t i = 0; i < other._digits.size(); ++i)
-    {
-        _digits[i] ^= other._digits[i];
-    }
-    
+    bitwise<'^'>(_digits.data(), other._digits.data(), other._digits.size());
+
     optimise(_digits);
     return *this;
 }
@@ -808,30 +3147,30 @@ std::istream& operator>>(std::istream& stream, big_int& value)
     return stream;
 }
 
-std::string big_int::to_string() const
+std::string big_int::to_string(unsigned int radix) const
 {
+    check_radix(radix);
+
     if (is_zero(_digits))
     {
         return "0";
     }
 
     std::string result;
-    big_int temp(*this);
-    temp._sign = true;
-
-    while (temp)
+    if (!_sign)
     {
-        big_int remainder = temp % 10;
-        result += static_cast<char>('0' + remainder._digits[0]);
-        temp /= 10;
+        result += '-';
     }
 
-    if (!_sign)
+    if (std::has_single_bit(radix))
     {
-        result += '-';
+        print_power_of_two(result, _digits, radix);
+    }
+    else
+    {
+        print_chunks(result, _digits.data(), _digits.size(), radix, chunk_for(radix), 0);
     }
 
-    std::reverse(result.begin(), result.end());
     return result;
 }
 
@@ -853,62 +3192,548 @@ big_int& big_int::modulo_assign(const big_int& other, division_rule rule) &
         return *this;
     }
 
-    big_int abs_this(*this);
-    abs_this._sign = true;
-    big_int abs_other(other);
-    abs_other._sign = true;
-
-    if (abs_this < abs_other)
+    if (compare(_digits.data(), _digits.size(), other._digits.data(), other._digits.size()) < 0)
     {
 
         _sign = true;
         return *this;
     }
 
-    big_int remainder(_digits.get_allocator());
-    remainder._digits.clear();
-    remainder._digits.push_back(0);
+    divide_digits(_digits, other._digits, rule, nullptr, &_digits);
+    if (is_zero(_digits))
+    {
+        _sign = true;
+    }
+    
+    return *this;
+}
+
+big_int big_int::pow_mod(const big_int& exponent, const big_int& modulus) const
+{
+    if (!modulus._sign || is_zero(modulus._digits))
+    {
+        throw std::invalid_argument("Modulus must be positive");
+    }
 
-    for (int i = static_cast<int>(_digits.size()) - 1; i >= 0; --i)
+    if ((modulus._digits[0] & 1) != 0)
+    {
+        return montgomery_context(modulus).pow(*this, exponent);
+    }
+
+    if (!exponent._sign && !is_zero(exponent._digits))
+    {
+        throw std::invalid_argument("Exponent must be non-negative");
+    }
+
+    // An even modulus has no Montgomery form; reduce every product by division instead
+    big_int base(*this);
+    base._sign = true;
+    base %= modulus;
+    if (!_sign && !is_zero(base._digits))
+    {
+        sub(base, modulus, base);
+    }
+
+    big_int result(1, _digits.get_allocator());
+    big_int product(_digits.get_allocator());
+    big_int quotient(_digits.get_allocator());
+    const size_t bits = is_zero(exponent._digits) ? 0
+        : exponent._digits.size() * 32 - std::countl_zero(exponent._digits.back());
+    for (size_t i = bits; i-- > 0;)
+    {
+        mul(product, result, result);
+        divmod(quotient, result, product, modulus);
+        if ((exponent._digits[i / 32] >> (i % 32)) & 1)
+        {
+            mul(product, result, base);
+            divmod(quotient, result, product, modulus);
+        }
+    }
+    return result;
+}
+
+/*
+ * The pair a >= b >= 0 is reduced to (gcd, 0). Where the cofactors are wanted, every step is folded into
+ * a matrix M with (a, b) = M (current a, current b) for the pair the reduction started from.
+ */
+struct big_int::euclid
+{
+    struct matrix
+    {
+        big_int m00;
+        big_int m01;
+        big_int m10;
+        big_int m11;
+        bool negative = false; // det M = -1
+
+        explicit matrix(pp_allocator<unsigned int> allocator)
+            : m00(1, allocator), m01(0, allocator), m10(0, allocator), m11(1, allocator) {}
+    };
+
+    static size_t size(const big_int& value) noexcept
+    {
+        return value._digits.size();
+    }
+
+    static void negate(big_int& value) noexcept
+    {
+        if (!is_zero(value._digits))
+        {
+            value._sign = !value._sign;
+        }
+    }
+
+    /** M = M N for N = [[n00, n01], [n10, n11]] of determinant -1 when negative
+     */
+    static void multiply(matrix& m, const big_int& n00, const big_int& n01, const big_int& n10, const big_int& n11,
+                         bool negative)
+    {
+        big_int column(m.m00._digits.get_allocator());
+        for (auto [first, second] : {std::pair{&m.m00, &m.m01}, std::pair{&m.m10, &m.m11}})
+        {
+            mul(column, *first, n01);
+            addmul(column, *second, n11);
+            mul(*first, *first, n00);
+            addmul(*first, *second, n10);
+            std::swap(*second, column);
+        }
+        m.negative ^= negative;
+    }
+
+    /** M = M [[q, 1], [1, 0]], the step (a, b) -> (b, a - q b)
+     */
+    static void fold(matrix& m, const big_int& quotient)
     {
-        remainder._digits.insert(remainder._digits.begin(), _digits[i]);
-        optimise(remainder._digits);
+        std::swap(m.m00, m.m01);
+        addmul(m.m00, m.m01, quotient);
+        std::swap(m.m10, m.m11);
+        addmul(m.m10, m.m11, quotient);
+        m.negative = !m.negative;
+    }
 
-        if (remainder < abs_other)
+    /** (first, second) = (first n00 + second n10, first n01 + second n11)
+     */
+    static void fold_row(big_int& first, big_int& second, limb n00, limb n01, limb n10, limb n11, big_int& scratch)
+    {
+        const size_t n = std::max(size(first), size(second));
+        first._digits.resize(n);
+        second._digits.resize(n);
+        scratch._digits.resize(n);
+        const unsigned long long first_carry = mul_add_1(scratch._digits.data(), first._digits.data(), n00,
+                                                         second._digits.data(), n10, n);
+        const unsigned long long second_carry = mul_add_1(second._digits.data(), first._digits.data(), n01,
+                                                          second._digits.data(), n11, n);
+        for (auto [value, carry] : {std::pair{&scratch, first_carry}, std::pair{&second, second_carry}})
         {
-            continue;
+            value->_digits.push_back(static_cast<limb>(carry));
+            value->_digits.push_back(static_cast<limb>(carry >> 32));
+            optimise(value->_digits);
+            value->_sign = true;
         }
+        std::swap(first, scratch);
+    }
 
-        unsigned long long left = 0, right = BASE - 1;
-        unsigned long long q = 0;
-        while (left <= right)
+    /** M = M L^-1 for Lehmer's cofactors L, L^-1 = det L [[D, -B], [-C, A]]
+     */
+    static void fold(matrix& m, const lehmer_cofactors& cofactors)
+    {
+        // L^-1 is a product of steps [[q, 1], [1, 0]], and so is M unless reduce_by has changed a sign
+        if (m.m00._sign && m.m01._sign && m.m10._sign && m.m11._sign)
         {
-            unsigned long long mid = left + (right - left) / 2;
-            big_int temp(abs_other);
-            temp *= big_int(static_cast<long long>(mid), _digits.get_allocator());
-            if (remainder >= temp)
+            const auto magnitude = [](long long entry) { return static_cast<limb>(entry < 0 ? -entry : entry); };
+            big_int scratch(m.m00._digits.get_allocator());
+            for (auto [first, second] : {std::pair{&m.m00, &m.m01}, std::pair{&m.m10, &m.m11}})
             {
-                q = mid;
-                left = mid + 1;
+                fold_row(*first, *second, magnitude(cofactors.D), magnitude(cofactors.B),
+                         magnitude(cofactors.C), magnitude(cofactors.A), scratch);
             }
-            else
+            m.negative ^= cofactors.odd;
+            return;
+        }
+
+        const long long sign = cofactors.odd ? -1 : 1;
+        const auto allocator = m.m00._digits.get_allocator();
+        multiply(m, big_int(sign * cofactors.D, allocator), big_int(-sign * cofactors.B, allocator),
+                 big_int(-sign * cofactors.C, allocator), big_int(sign * cofactors.A, allocator), cofactors.odd);
+    }
+
+    /** A batch of Euclid's steps from Lehmer's cofactors or, when the leading limbs decide none, one division,
+     *  on a >= b > 0
+     */
+    static void step(big_int& a, big_int& b, matrix* m, big_int& first, big_int& second)
+    {
+        const size_t n = size(a);
+        lehmer_cofactors cofactors;
+        if (n >= 3 && size(b) + 1 >= n && lehmer_step(a._digits.data(), n, b._digits.data(), size(b), cofactors))
+        {
+            b._digits.resize(n);
+            first._digits.resize(n);
+            second._digits.resize(n);
+            combine(first._digits.data(), a._digits.data(), b._digits.data(), n, cofactors.A, cofactors.B);
+            combine(second._digits.data(), a._digits.data(), b._digits.data(), n, cofactors.C, cofactors.D);
+            optimise(first._digits);
+            optimise(second._digits);
+            first._sign = second._sign = true;
+            std::swap(a, first);
+            std::swap(b, second);
+            if (m != nullptr)
             {
-                right = mid - 1;
+                fold(*m, cofactors);
             }
+            return;
         }
 
-        if (q > 0)
+        divmod(first, second, a, b);
+        std::swap(a, b);
+        std::swap(b, second);
+        if (m != nullptr)
         {
-            big_int temp(abs_other);
-            temp *= big_int(static_cast<long long>(q), _digits.get_allocator());
-            remainder -= temp;
+            fold(*m, first);
         }
     }
-    _digits = std::move(remainder._digits);
-    if (is_zero(_digits))
+
+    /** (a, b) = M^-1 (a, b) for the M that took the limbs of a and b above the lowest low ones to high_a and
+     *  high_b, then made non-negative and ordered with the changes folded into M
+     */
+    static void reduce_by(matrix& m, big_int& a, big_int& b, const big_int& high_a, const big_int& high_b, size_t low)
     {
-        _sign = true;
+        a._digits.resize(std::min(size(a), low));
+        b._digits.resize(std::min(size(b), low));
+        optimise(a._digits);
+        optimise(b._digits);
+
+        // M^-1 = det M [[m11, -m01], [-m10, m00]]
+        big_int first(a._digits.get_allocator());
+        big_int second(a._digits.get_allocator());
+        mul(first, m.m11, a);
+        mul(second, m.m01, b);
+        sub(first, first, second);
+        mul(second, m.m00, b);
+        mul(b, m.m10, a);
+        sub(b, second, b);
+        std::swap(a, first);
+        if (m.negative)
+        {
+            negate(a);
+            negate(b);
+        }
+        a.plus_assign(high_a, low);
+        b.plus_assign(high_b, low);
+
+        if (!a._sign)
+        {
+            negate(a);
+            negate(m.m00);
+            negate(m.m10);
+            m.negative = !m.negative;
+        }
+        if (!b._sign)
+        {
+            negate(b);
+            negate(m.m01);
+            negate(m.m11);
+            m.negative = !m.negative;
+        }
+        if (a < b)
+        {
+            std::swap(a, b);
+            std::swap(m.m00, m.m01);
+            std::swap(m.m10, m.m11);
+            m.negative = !m.negative;
+        }
     }
-    
-    return *this;
-}
\ No newline at end of file
+
+    /** Takes a >= b > 0 of n limbs down Euclid's sequence until b has at most n / 2 + 1 limbs, and sets M from
+     *  the identity to the steps made. Long pairs recurse twice: the steps for the leading half of a pair are,
+     *  but for the last few, those of the whole pair while its remainders keep a limb more than the cofactors
+     */
+    static void half_gcd(big_int& a, big_int& b, matrix& m)
+    {
+        const size_t n = size(a);
+        const size_t s = n / 2 + 1;
+        const auto allocator = a._digits.get_allocator();
+
+        if (n >= half_gcd_recursion && size(b) > s)
+        {
+            const size_t low = n / 2;
+            big_int high_a = a >> (32 * low);
+            big_int high_b = b >> (32 * low);
+            half_gcd(high_a, high_b, m);
+            reduce_by(m, a, b, high_a, high_b, low);
+
+            if (!is_zero(b._digits) && size(b) > s)
+            {
+                big_int quotient(allocator);
+                big_int remainder(allocator);
+                divmod(quotient, remainder, a, b);
+                std::swap(a, b);
+                std::swap(b, remainder);
+                fold(m, quotient);
+            }
+
+            if (!is_zero(b._digits) && size(b) > s)
+            {
+                // The leading 2 (size(a) - s) limbs reduce to about s limbs in all
+                const size_t shift = 2 * s - size(a);
+                matrix second(allocator);
+                high_a = a >> (32 * shift);
+                high_b = b >> (32 * shift);
+                half_gcd(high_a, high_b, second);
+                reduce_by(second, a, b, high_a, high_b, shift);
+                multiply(m, second.m00, second.m01, second.m10, second.m11, second.negative);
+            }
+        }
+
+        big_int first(allocator);
+        big_int second(allocator);
+        while (!is_zero(b._digits) && size(b) > s)
+        {
+            step(a, b, &m, first, second);
+        }
+    }
+
+    /** Reduces a >= b >= 0 to (gcd, 0), folding every step into M when given
+     */
+    static void reduce(big_int& a, big_int& b, matrix* m)
+    {
+        const auto allocator = a._digits.get_allocator();
+        big_int first(allocator);
+        big_int second(allocator);
+        while (!is_zero(b._digits))
+        {
+            if (m == nullptr && size(a) <= 2)
+            {
+                auto value = [](const big_int& x) {
+                    return x._digits.size() == 1 ? x._digits[0]
+                        : static_cast<unsigned long long>(x._digits[1]) << 32 | x._digits[0];
+                };
+                const unsigned long long divisor = std::gcd(value(a), value(b));
+                a._digits.assign(1, static_cast<limb>(divisor));
+                a._digits.push_back(static_cast<limb>(divisor >> 32));
+                optimise(a._digits);
+                b._digits.assign(1, 0);
+                return;
+            }
+
+            if (size(b) >= half_gcd_threshold && size(b) > size(a) / 2 + 1)
+            {
+                matrix steps(allocator);
+                half_gcd(a, b, steps);
+                if (m != nullptr)
+                {
+                    multiply(*m, steps.m00, steps.m01, steps.m10, steps.m11, steps.negative);
+                }
+                continue;
+            }
+
+            step(a, b, m, first, second);
+        }
+    }
+};
+
+big_int big_int::gcd(const big_int& a, const big_int& b)
+{
+    big_int first(a);
+    big_int second(b);
+    first._sign = second._sign = true;
+    if (first < second)
+    {
+        std::swap(first, second);
+    }
+
+    euclid::reduce(first, second, nullptr);
+    return first;
+}
+
+big_int big_int::gcd_extended(const big_int& a, const big_int& b, big_int& x, big_int& y)
+{
+    const bool a_negative = !a._sign;
+    const bool b_negative = !b._sign;
+    big_int first(a);
+    big_int second(b);
+    first._sign = second._sign = true;
+    const bool swapped = first < second;
+    if (swapped)
+    {
+        std::swap(first, second);
+    }
+
+    euclid::matrix m(first._digits.get_allocator());
+    euclid::reduce(first, second, &m);
+
+    // (first, second) was M (gcd, 0), so gcd = det M (m11 first - m01 second)
+    big_int first_cofactor(std::move(m.m11));
+    big_int second_cofactor(std::move(m.m01));
+    euclid::negate(second_cofactor);
+    if (m.negative)
+    {
+        euclid::negate(first_cofactor);
+        euclid::negate(second_cofactor);
+    }
+    if (swapped)
+    {
+        std::swap(first_cofactor, second_cofactor);
+    }
+    if (a_negative)
+    {
+        euclid::negate(first_cofactor);
+    }
+    if (b_negative)
+    {
+        euclid::negate(second_cofactor);
+    }
+
+    x = std::move(first_cofactor);
+    y = std::move(second_cofactor);
+    return first;
+}
+
+montgomery_context::montgomery_context(const big_int& modulus)
+    : _modulus(modulus), _digits(modulus._digits.get_allocator()), _square(modulus._digits.get_allocator()),
+      _inverse(modulus._digits.get_allocator())
+{
+    if (!modulus._sign || (modulus._digits[0] & 1) == 0)
+    {
+        throw std::invalid_argument("Montgomery modulus must be odd and positive");
+    }
+
+    const size_t k = modulus._digits.size() + modulus._digits.size() % 2;
+    _digits.assign(k, 0);
+    std::copy(modulus._digits.begin(), modulus._digits.end(), _digits.begin());
+
+    digits_vector power(2 * k + 1, 0, modulus._digits.get_allocator());
+    power.back() = 1;
+    divide_magnitudes(power, modulus._digits, division_rule_for(2 * k + 1, modulus._digits.size()), nullptr, _square);
+    _square.resize(k);
+
+    const unsigned long long low = _digits[0] | static_cast<unsigned long long>(_digits[1]) << 32;
+    const unsigned long long inverse = negated_inverse(low);
+    if (k < montgomery_threshold)
+    {
+        _inverse.assign(2, 0);
+        _inverse[0] = static_cast<limb>(inverse);
+        _inverse[1] = static_cast<limb>(inverse >> 32);
+        return;
+    }
+
+    // Lift 1/n from 64 bits to all of R by Newton steps x = x * (2 - n * x), each doubling the correct bits
+    const big_int one(1, modulus._digits.get_allocator());
+    big_int x(0 - inverse, modulus._digits.get_allocator());
+    for (size_t bits = 64; bits < 32 * k;)
+    {
+        bits = std::min(2 * bits, 32 * k);
+        const big_int mask = (one << bits) - one;
+        const big_int error = (_modulus * x) & mask;
+        x = (x * (((one << bits) + 2) - error)) & mask;
+    }
+    const big_int negated = (one << (32 * k)) - x;
+    _inverse.assign(k, 0);
+    std::copy(negated._digits.begin(), negated._digits.end(), _inverse.begin());
+}
+
+const big_int& montgomery_context::modulus() const noexcept
+{
+    return _modulus;
+}
+
+void montgomery_context::residue(limb* out, const big_int& value) const
+{
+    const size_t k = _digits.size();
+    std::fill(out, out + k, 0u);
+
+    if (compare(value._digits.data(), value._digits.size(), _modulus._digits.data(), _modulus._digits.size()) < 0)
+    {
+        std::copy(value._digits.begin(), value._digits.end(), out);
+    }
+    else
+    {
+        auto remainder = workspace(remainder_result, 0, _digits.get_allocator());
+        divide_magnitudes(value._digits, _modulus._digits,
+                          division_rule_for(value._digits.size(), _modulus._digits.size()), nullptr, *remainder);
+        std::copy(remainder->begin(), remainder->end(), out);
+    }
+
+    if (!value._sign && significant(out, k) != 0)
+    {
+        sub(out, _digits.data(), k, out, k);
+    }
+}
+
+void montgomery_context::assign(big_int& out, const limb* digits) const
+{
+    out._digits.assign(digits, digits + _digits.size());
+    out._sign = true;
+    optimise(out._digits);
+}
+
+big_int montgomery_context::to_montgomery(const big_int& value) const
+{
+    const size_t k = _digits.size();
+    auto operands = workspace(montgomery_operands, k, _digits.get_allocator());
+    residue(operands->data(), value);
+    montgomery_multiply(operands->data(), operands->data(), _square.data(), _digits.data(), k, _inverse.data(),
+                        _digits.get_allocator());
+
+    big_int result(_modulus._digits.get_allocator());
+    assign(result, operands->data());
+    return result;
+}
+
+big_int montgomery_context::from_montgomery(const big_int& value) const
+{
+    const size_t k = _digits.size();
+    auto operands = workspace(montgomery_operands, 2 * k, _digits.get_allocator());
+    limb* plain = operands->data();
+    limb* one = plain + k;
+    residue(plain, value);
+    std::fill(one, one + k, 0u);
+    one[0] = 1;
+    montgomery_multiply(plain, plain, one, _digits.data(), k, _inverse.data(), _digits.get_allocator());
+
+    big_int result(_modulus._digits.get_allocator());
+    assign(result, plain);
+    return result;
+}
+
+void montgomery_context::multiply(big_int& out, const big_int& a, const big_int& b) const
+{
+    const size_t k = _digits.size();
+    auto operands = workspace(montgomery_operands, 2 * k, _digits.get_allocator());
+    residue(operands->data(), a);
+    residue(operands->data() + k, b);
+    montgomery_multiply(operands->data(), operands->data(), operands->data() + k, _digits.data(), k, _inverse.data(),
+                        _digits.get_allocator());
+    assign(out, operands->data());
+}
+
+big_int montgomery_context::pow(const big_int& base, const big_int& exponent) const
+{
+    if (!exponent._sign && !is_zero(exponent._digits))
+    {
+        throw std::invalid_argument("Exponent must be non-negative");
+    }
+
+    big_int result(_modulus._digits.get_allocator());
+    if (is_zero(exponent._digits))
+    {
+        result._digits.assign(1, _modulus._digits.size() == 1 && _modulus._digits[0] == 1 ? 0 : 1);
+        return result;
+    }
+
+    // The base, its Montgomery form, then the power, which one more product by 1 takes out of the form
+    const size_t k = _digits.size();
+    auto operands = workspace(montgomery_operands, 3 * k, _digits.get_allocator());
+    limb* plain = operands->data();
+    limb* form = plain + k;
+    limb* power = form + k;
+    residue(plain, base);
+    montgomery_multiply(form, plain, _square.data(), _digits.data(), k, _inverse.data(), _digits.get_allocator());
+    montgomery_power(power, form, exponent._digits.data(), exponent._digits.size(), _digits.data(), k, _inverse.data(),
+                     _digits.get_allocator());
+    std::fill(plain, plain + k, 0u);
+    plain[0] = 1;
+    montgomery_multiply(power, power, plain, _digits.data(), k, _inverse.data(), _digits.get_allocator());
+
+    assign(result, power);
+    return result;
+}
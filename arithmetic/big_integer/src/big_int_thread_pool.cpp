@@ -0,0 +1,90 @@
+#include "../include/big_int_thread_pool.h"
+
+big_int_thread_pool::big_int_thread_pool(size_t threads)
+{
+    _workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i)
+    {
+        _workers.emplace_back(&big_int_thread_pool::work, this);
+    }
+}
+
+big_int_thread_pool::~big_int_thread_pool()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stopping = true;
+    }
+    _started.notify_all();
+
+    for (auto& worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+size_t big_int_thread_pool::concurrency() const noexcept
+{
+    return _workers.size() + 1;
+}
+
+void big_int_thread_pool::take_parts(std::unique_lock<std::mutex>& lock)
+{
+    // The task is read with the part under the lock: a late worker may already be looking at the next job
+    while (_next < _count)
+    {
+        const size_t part = _next++;
+        const auto task = _task;
+        const auto context = _context;
+
+        lock.unlock();
+        task(context, part);
+        lock.lock();
+
+        if (--_pending == 0)
+        {
+            _finished.notify_all();
+        }
+    }
+}
+
+void big_int_thread_pool::work()
+{
+    size_t seen = 0;
+    std::unique_lock lock(_mutex);
+    while (true)
+    {
+        _started.wait(lock, [this, seen] { return _stopping || _generation != seen; });
+        if (_stopping)
+        {
+            return;
+        }
+        seen = _generation;
+        take_parts(lock);
+    }
+}
+
+void big_int_thread_pool::run_parts(size_t count, void (*task)(void*, size_t), void* context)
+{
+    std::unique_lock busy(_busy, std::try_to_lock);
+    if (!busy.owns_lock() || _workers.empty() || count <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            task(context, i);
+        }
+        return;
+    }
+
+    std::unique_lock lock(_mutex);
+    _task = task;
+    _context = context;
+    _count = count;
+    _next = 0;
+    _pending = count;
+    ++_generation;
+    _started.notify_all();
+
+    take_parts(lock);
+    _finished.wait(lock, [this] { return _pending == 0; });
+}
@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 #include <client_logger_builder.h>
 #include <sstream>
+#include <random>
 #include <big_int.h>
+#include "../big_int_test_helpers.h"
 #include <client_logger.h>
 #include <client_logger_builder.h>
 
@@ -165,6 +167,26 @@ TEST(positive_tests_kar, test7)
     delete logger;
 }
 
+TEST(positive_tests_kar, matches_trivial_across_thresholds)
+{
+    std::mt19937 generator(7);
+    // Sizes straddle the schoolbook / Karatsuba / Toom-3 switch points, plus unbalanced operands
+    for (auto [lhs_size, rhs_size] : std::vector<std::pair<size_t, size_t>>{
+             {31, 31}, {32, 33}, {100, 100}, {159, 160}, {161, 161}, {500, 499}, {1200, 1200}, {1000, 37}, {3000, 700}})
+    {
+        // Runs of all-ones limbs stress the carries of the recombination steps
+        big_int lhs(random_digits(generator, lhs_size, 3));
+        big_int rhs(random_digits(generator, rhs_size, 3), false);
+
+        big_int expected(lhs);
+        expected.multiply_assign(rhs, big_int::multiplication_rule::trivial);
+
+        lhs.multiply_assign(rhs, big_int::multiplication_rule::Karatsuba);
+
+        EXPECT_TRUE(lhs == expected) << lhs_size << " x " << rhs_size;
+    }
+}
+
 int main(
     int argc,
     char **argv)
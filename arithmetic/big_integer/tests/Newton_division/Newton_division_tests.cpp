@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 #include <client_logger_builder.h>
 #include <sstream>
+#include <random>
 #include <big_int.h>
+#include "../big_int_test_helpers.h"
 #include <client_logger.h>
 #include <operation_not_supported.h>
 
@@ -163,6 +165,19 @@ TEST(positive_tests, test7)
     delete logger;
 }
 
+INSTANTIATE_TEST_SUITE_P(
+    Newton,
+    quotient_and_remainder,
+    testing::Combine(
+        testing::Values(big_int::division_rule::Newton),
+        testing::Values(
+            std::pair(5, 2),
+            std::pair(96, 48),
+            std::pair(300, 120),
+            std::pair(1000, 999),
+            std::pair(4000, 1500),
+            std::pair(20000, 3000))));
+
 int main(
     int argc,
     char **argv)
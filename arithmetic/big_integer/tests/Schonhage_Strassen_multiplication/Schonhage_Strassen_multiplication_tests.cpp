@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 #include <sstream>
+#include <random>
 #include <client_logger_builder.h>
 #include <big_int.h>
+#include "../big_int_test_helpers.h"
 #include <client_logger.h>
 
 logger *create_logger(
@@ -164,6 +166,54 @@ TEST(positive_tests, test7)
     delete logger;
 }
 
+TEST(positive_tests, transform_matches_toom_and_trivial)
+{
+    std::mt19937 generator(11);
+    for (auto [lhs_size, rhs_size, saturated] : std::vector<std::tuple<size_t, size_t, bool>>{
+             {1, 1, true}, {3, 2, false}, {100, 1, false}, {257, 255, true}, {1000, 333, false}, {5000, 4097, true}, {20000, 20000, false}})
+    {
+        // All-ones operands give the largest convolution coefficients, the worst case for the CRT
+        big_int lhs(random_digits(generator, lhs_size, saturated ? 1 : 0));
+        big_int rhs(random_digits(generator, rhs_size, saturated ? 1 : 0), false);
+
+        big_int expected(lhs);
+        expected.multiply_assign(rhs, lhs_size < 2000 ? big_int::multiplication_rule::trivial : big_int::multiplication_rule::Karatsuba);
+
+        big_int square(lhs);
+        square.multiply_assign(square, big_int::multiplication_rule::SchonhageStrassen);
+        big_int expected_square(lhs);
+        expected_square.multiply_assign(lhs, big_int::multiplication_rule::Karatsuba);
+
+        lhs.multiply_assign(rhs, big_int::multiplication_rule::SchonhageStrassen);
+
+        EXPECT_TRUE(lhs == expected) << lhs_size << " x " << rhs_size;
+        EXPECT_TRUE(square == expected_square) << lhs_size << " squared";
+    }
+}
+
+TEST(positive_tests, thread_pool_gives_the_serial_product)
+{
+    std::mt19937 generator(13);
+    // More threads than blocks of the smallest transform, and an uneven split of the reconstruction
+    big_int_thread_pool pool(5);
+    for (auto [lhs_size, rhs_size] : std::vector<std::pair<size_t, size_t>>{{4096, 4096}, {30001, 17000}})
+    {
+        big_int lhs(random_digits(generator, lhs_size, 4));
+        big_int rhs(random_digits(generator, rhs_size, 4));
+
+        big_int expected(lhs);
+        expected.multiply_assign(rhs, big_int::multiplication_rule::SchonhageStrassen);
+
+        big_int product(lhs);
+        product.multiply_assign(rhs, big_int::multiplication_rule::SchonhageStrassen, pool);
+        EXPECT_TRUE(product == expected) << lhs_size << " x " << rhs_size;
+
+        big_int::parallel_multiplication(&pool, 4096);
+        EXPECT_TRUE(lhs * rhs == expected) << lhs_size << " x " << rhs_size;
+        big_int::parallel_multiplication(nullptr);
+    }
+}
+
 int main(
     int argc,
     char **argv)
@@ -0,0 +1,59 @@
+#ifndef MP_OS_BIG_INT_TEST_HELPERS_H
+#define MP_OS_BIG_INT_TEST_HELPERS_H
+
+#include <gtest/gtest.h>
+#include <big_int.h>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/** Random limbs, about one in saturated_one_in of them all-ones (0 - none, 1 - all): runs of all-ones limbs
+ *  stress carries, borrows and the largest convolution coefficients
+ */
+inline std::vector<unsigned int> random_digits(
+    std::mt19937 &generator,
+    size_t size,
+    unsigned int saturated_one_in)
+{
+    std::vector<unsigned int> digits(size);
+    for (auto &digit : digits)
+    {
+        digit = saturated_one_in != 0 && generator() % saturated_one_in == 0
+            ? 0xFFFFFFFFu
+            : static_cast<unsigned int>(generator());
+    }
+    return digits;
+}
+
+/** Division rule and (dividend, divisor) sizes in limbs; each division test instantiates it with the sizes its
+ *  rule is meant for
+ */
+class quotient_and_remainder
+    : public testing::TestWithParam<std::tuple<big_int::division_rule, std::pair<size_t, size_t>>>
+{
+};
+
+// The multiplication tests include this header only for random_digits
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(quotient_and_remainder);
+
+TEST_P(quotient_and_remainder, reconstruct_dividend)
+{
+    const auto [rule, sizes] = GetParam();
+    const auto [dividend_size, divisor_size] = sizes;
+
+    std::mt19937 generator(13);
+    big_int dividend(random_digits(generator, dividend_size, 4), false);
+    big_int divisor(random_digits(generator, divisor_size, 4));
+
+    big_int quotient(dividend);
+    quotient.divide_assign(divisor, rule);
+    big_int remainder(dividend);
+    remainder.modulo_assign(divisor, rule);
+
+    // Truncating division: the remainder takes the dividend's sign and is smaller than the divisor
+    EXPECT_TRUE(quotient * divisor + remainder == dividend) << dividend_size << " / " << divisor_size;
+    EXPECT_TRUE(remainder <= 0_bi && remainder > 0_bi - divisor) << dividend_size << " / " << divisor_size;
+}
+
+#endif //MP_OS_BIG_INT_TEST_HELPERS_H
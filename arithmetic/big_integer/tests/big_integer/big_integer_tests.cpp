@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <big_int.h>
+#include <random>
 #include <client_logger.h>
 #include <client_logger_builder.h>
 #include <operation_not_supported.h>
@@ -29,6 +30,292 @@ logger *create_logger(
     return built_logger;
 }
 
+TEST(positive_tests, radix_round_trip)
+{
+    std::mt19937 generator(17);
+    std::vector<unsigned int> digits(700);
+    for (auto &digit : digits)
+    {
+        digit = static_cast<unsigned int>(generator());
+    }
+    big_int value(digits, false);
+
+    for (unsigned int radix = 2; radix <= 36; ++radix)
+    {
+        EXPECT_TRUE(big_int(value.to_string(radix), radix) == value) << radix;
+    }
+
+    EXPECT_EQ(big_int("-FF", 16).to_string(), "-255");
+    EXPECT_EQ(big_int("255").to_string(2), "11111111");
+    EXPECT_EQ(big_int("zz", 36).to_string(7), "3530");
+    EXPECT_THROW(big_int("129", 9), std::invalid_argument);
+    EXPECT_THROW(big_int("1", 37), std::invalid_argument);
+}
+
+TEST(positive_tests, short_values_stay_inline)
+{
+    struct counting_resource : std::pmr::memory_resource
+    {
+        size_t allocations = 0;
+
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    } resource;
+
+    big_int a(123456789012345LL, &resource);
+    big_int b(-987654321, &resource);
+    big_int gcd_x = a * b;
+    big_int gcd_y(b + big_int(17, &resource));
+    while (gcd_y)
+    {
+        big_int rest = gcd_x % gcd_y;
+        gcd_x = gcd_y;
+        gcd_y = rest;
+    }
+    big_int value = (a * a - b) / big_int(7, &resource) + (a << 20) - (b >> 3);
+
+    EXPECT_EQ(resource.allocations, 0u);
+    EXPECT_EQ(value.to_string(), "2177368522773635870039277988");
+    EXPECT_EQ(gcd_x.to_string(), "-17");
+
+    // Past the inline limbs the digits move to the allocator and keep working
+    big_int power(1, &resource);
+    for (int i = 0; i < 10; ++i)
+    {
+        power *= a;
+    }
+    EXPECT_GT(resource.allocations, 0u);
+    EXPECT_TRUE(power / a / a == power / (a * a));
+    EXPECT_TRUE(big_int(power.to_string()) == power);
+}
+
+TEST(positive_tests, in_place_functions_match_operators)
+{
+    big_int a("-123456789012345678901234567890123456789012345678901234567890");
+    big_int b("987654321098765432109876543210987");
+
+    big_int out;
+    add(out, a, b);
+    EXPECT_TRUE(out == a + b);
+    sub(out, a, b);
+    EXPECT_TRUE(out == a - b);
+    mul(out, a, b);
+    EXPECT_TRUE(out == a * b);
+    addmul(out, a, b);
+    EXPECT_TRUE(out == a * b * big_int(2));
+
+    big_int quotient;
+    big_int remainder;
+    divmod(quotient, remainder, a, b);
+    EXPECT_TRUE(quotient == a / b);
+    EXPECT_TRUE(remainder == a % b);
+    EXPECT_TRUE(quotient * b + remainder == a);
+
+    // Outputs may be the inputs
+    big_int x(a);
+    big_int y(b);
+    mul(x, x, y);
+    EXPECT_TRUE(x == a * b);
+    sub(y, a, y);
+    EXPECT_TRUE(y == a - b);
+    x = a;
+    y = b;
+    divmod(x, y, x, y);
+    EXPECT_TRUE(x == a / b);
+    EXPECT_TRUE(y == a % b);
+
+    EXPECT_THROW(divmod(quotient, remainder, a, big_int(0)), std::logic_error);
+}
+
+TEST(positive_tests, long_operands_match_limbwise_results)
+{
+    std::mt19937 generator(23);
+    std::vector<unsigned int> lhs(301);
+    std::vector<unsigned int> rhs(157);
+    for (auto &digit : lhs)
+    {
+        digit = static_cast<unsigned int>(generator());
+    }
+    for (auto &digit : rhs)
+    {
+        // Runs of all-ones limbs make carries and borrows cross many vector lanes
+        digit = generator() % 3 == 0 ? static_cast<unsigned int>(generator()) : 0xFFFFFFFFu;
+    }
+    big_int a(lhs);
+    big_int b(rhs);
+
+    std::vector<unsigned int> conjunction(rhs.size());
+    std::vector<unsigned int> exclusive(lhs);
+    for (size_t i = 0; i < rhs.size(); ++i)
+    {
+        conjunction[i] = lhs[i] & rhs[i];
+        exclusive[i] ^= rhs[i];
+    }
+    EXPECT_TRUE((a & b) == big_int(conjunction));
+    EXPECT_TRUE((a ^ b) == big_int(exclusive));
+    EXPECT_TRUE(((a | b) ^ (a & b)) == (a ^ b));
+
+    EXPECT_TRUE(a + b - b == a);
+    EXPECT_TRUE(b - a + a == b);
+    EXPECT_TRUE((a << 200) - (b << 37) + (b << 37) == (a << 200));
+    EXPECT_TRUE(((a << 45) >> 45) == a);
+    EXPECT_TRUE((a << 45) == a * (big_int(1) << 45));
+    EXPECT_TRUE((a >> 45) == a / (big_int(1) << 45));
+}
+
+TEST(positive_tests, pow_mod_matches_repeated_multiplication)
+{
+    // Fermat's little theorem for the Mersenne prime 2^521 - 1
+    const big_int prime = (big_int(1) << 521) - big_int(1);
+    const big_int a("123456789012345678901234567890123456789");
+    EXPECT_TRUE(a.pow_mod(prime - big_int(1), prime) == big_int(1));
+    EXPECT_TRUE((big_int(0) - a).pow_mod(prime, prime) == prime - a);
+
+    const montgomery_context context(prime);
+    const big_int b("-98765432109876543210987654321");
+    big_int product;
+    context.multiply(product, context.to_montgomery(a), context.to_montgomery(b));
+    EXPECT_TRUE(context.from_montgomery(product) == prime + a * b);
+
+    // A modulus past the switch to reduction by full products, and an even one reduced by division
+    std::mt19937 generator(29);
+    std::vector<unsigned int> digits(250);
+    for (auto &digit : digits)
+    {
+        digit = static_cast<unsigned int>(generator());
+    }
+    digits[0] |= 1;
+    for (const big_int& modulus : {big_int(digits), big_int(digits) + big_int(1)})
+    {
+        const big_int base = (a << 4000) % modulus;
+        const big_int exponent(0x1234567u);
+        big_int expected(1);
+        for (int i = 24; i >= 0; --i)
+        {
+            expected = expected * expected % modulus;
+            if ((0x1234567u >> i) & 1)
+            {
+                expected = expected * base % modulus;
+            }
+        }
+        EXPECT_TRUE(base.pow_mod(exponent, modulus) == expected);
+    }
+
+    EXPECT_TRUE(big_int(-7).pow_mod(big_int(3), big_int(10)) == big_int(7));
+    EXPECT_TRUE(a.pow_mod(big_int(0), big_int(1)) == big_int(0));
+    EXPECT_THROW(a.pow_mod(big_int(-1), prime), std::invalid_argument);
+    EXPECT_THROW(a.pow_mod(big_int(2), big_int(0)), std::invalid_argument);
+    EXPECT_THROW(montgomery_context(big_int(10)), std::invalid_argument);
+}
+
+TEST(positive_tests, gcd_matches_euclid)
+{
+    auto euclid = [](big_int a, big_int b) {
+        while (b != big_int(0))
+        {
+            big_int remainder = a % b;
+            a = b;
+            b = remainder;
+        }
+        return a;
+    };
+
+    std::mt19937 generator(46);
+    auto random = [&generator](size_t size) {
+        std::vector<unsigned int> digits(size);
+        for (auto &digit : digits)
+        {
+            digit = static_cast<unsigned int>(generator());
+        }
+        return big_int(digits);
+    };
+
+    // Lehmer steps, then pairs long enough for half-gcd, with a large common factor
+    for (size_t size : {1, 3, 20, 150, 900, 1500})
+    {
+        const big_int common = random(size / 3 + 1);
+        const big_int a = random(size) * common;
+        const big_int b = random(size - size / 4) * common;
+        const big_int expected = euclid(a, b);
+
+        EXPECT_TRUE(big_int::gcd(a, b) == expected);
+        EXPECT_TRUE(big_int::gcd(big_int(0) - a, b) == expected);
+
+        big_int x, y;
+        EXPECT_TRUE(big_int::gcd_extended(a, big_int(0) - b, x, y) == expected);
+        EXPECT_TRUE(a * x - b * y == expected);
+    }
+
+    // Consecutive Fibonacci numbers take the most steps
+    big_int previous(1), current(1);
+    for (int i = 0; i < 3000; ++i)
+    {
+        big_int next = previous + current;
+        previous = current;
+        current = next;
+    }
+    big_int x, y;
+    EXPECT_TRUE(big_int::gcd_extended(current, previous, x, y) == big_int(1));
+    EXPECT_TRUE(current * x + previous * y == big_int(1));
+
+    EXPECT_TRUE(big_int::gcd(big_int(0), big_int(0)) == big_int(0));
+    EXPECT_TRUE(big_int::gcd(big_int(-12), big_int(0)) == big_int(12));
+    EXPECT_TRUE(big_int::gcd(big_int(1ull << 40), big_int(6ull << 35)) == big_int(1ull << 36));
+}
+
+TEST(positive_tests, long_decimal_conversion_keeps_inner_zeros)
+{
+    // Power-of-ten splits must pad every lower half to its full width
+    std::string text = "7" + std::string(30000, '0') + "12" + std::string(20000, '0') + "9";
+
+    big_int value(text);
+    EXPECT_EQ(value.to_string(), text);
+
+    big_int power("1" + std::string(20002, '0'));
+    EXPECT_EQ((value / power).to_string(), "7" + std::string(30000, '0') + "1");
+}
+
+TEST(positive_tests, bit_queries_match_binary_digits)
+{
+    std::mt19937 generator(23);
+    for (size_t bits : {1, 31, 32, 33, 63, 64, 65, 95, 96, 97, 1000})
+    {
+        std::string binary = "1";
+        for (size_t i = 1; i < bits; ++i)
+        {
+            binary += generator() % 4 == 0 ? '1' : '0';
+        }
+        big_int value(binary, 2);
+        big_int negative = 0_bi - value;
+
+        const size_t zeros = binary.size() - 1 - binary.find_last_of('1');
+        const std::string top = binary.substr(0, 64) + std::string(64 - std::min<size_t>(bits, 64), '0');
+        for (const big_int *number : {&value, &negative})
+        {
+            EXPECT_EQ(number->bit_width(), bits);
+            EXPECT_EQ(number->countr_zero(), zeros) << binary;
+            EXPECT_EQ(number->leading_bits(), std::stoull(top, nullptr, 2)) << binary;
+        }
+    }
+
+    EXPECT_EQ(big_int(0).bit_width(), 0u);
+    EXPECT_EQ(big_int(0).countr_zero(), 0u);
+    EXPECT_EQ(big_int(0).leading_bits(), 0u);
+}
+
 TEST(my_test, t1)
 {
     std::vector<unsigned int> vec1{0, 1, 2, 3, 4, 5};
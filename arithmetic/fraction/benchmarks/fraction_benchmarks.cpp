@@ -0,0 +1,161 @@
+#include <fraction.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// usage: mp_os_arthmtc_frctn_benchmarks [largest number of terms = 4000]
+
+namespace
+{
+    /** Repeats the operation until it has run for at least 200 ms and returns seconds per call
+     */
+    template<class F>
+    double measure(F&& operation)
+    {
+        using clock = std::chrono::steady_clock;
+
+        size_t iterations = 0;
+        auto started = clock::now();
+        std::chrono::duration<double> elapsed{};
+        do
+        {
+            operation();
+            ++iterations;
+            elapsed = clock::now() - started;
+        }
+        while (elapsed.count() < 0.2);
+
+        return elapsed.count() / static_cast<double>(iterations);
+    }
+
+    void print_time(double seconds)
+    {
+        std::cout << std::setw(16) << std::fixed << std::setprecision(2) << seconds * 1e6;
+    }
+
+    void harmonic_series(size_t largest)
+    {
+        std::cout << "1/1 + 1/2 + ... + 1/N and (2/3)(3/4)...((N+1)/(N+2))" << std::endl;
+        std::cout << std::setw(10) << "N" << std::setw(16) << "sum, us" << std::setw(16) << "product, us"
+                  << std::setw(12) << "digits" << std::endl;
+
+        for (size_t terms = 125; terms <= largest; terms *= 2)
+        {
+            fraction sum;
+            const double summed = measure([&] {
+                sum = fraction();
+                for (size_t i = 1; i <= terms; ++i)
+                {
+                    sum += fraction(1, i);
+                }
+            });
+
+            const double multiplied = measure([&] {
+                fraction product(1, 1);
+                for (size_t i = 1; i <= terms; ++i)
+                {
+                    product *= fraction(i + 1, i + 2);
+                }
+            });
+
+            std::cout << std::setw(10) << terms;
+            print_time(summed);
+            print_time(multiplied);
+            std::cout << std::setw(12) << sum.to_string().size() << std::endl;
+        }
+    }
+
+    void functions(size_t largest)
+    {
+        std::cout << "functions to within epsilon = 2^-bits" << std::endl;
+        std::cout << std::setw(10) << "bits" << std::setw(16) << "sin 7/10, us" << std::setw(16) << "cos 7/10, us"
+                  << std::setw(16) << "arctg 7/10, us" << std::setw(16) << "ln 10/3, us" << std::setw(16) << "root 2 of 2, us"
+                  << std::endl;
+
+        const fraction x(7, 10);
+        const fraction y(10, 3);
+        const fraction two(2, 1);
+        for (size_t bits = 32; bits <= largest; bits *= 4)
+        {
+            const fraction epsilon(1_bi, 1_bi << bits);
+
+            std::cout << std::setw(10) << bits;
+            print_time(measure([&] { x.sin(epsilon); }));
+            print_time(measure([&] { x.cos(epsilon); }));
+            print_time(measure([&] { x.arctg(epsilon); }));
+            print_time(measure([&] { y.ln(epsilon); }));
+            print_time(measure([&] { two.root(2, epsilon); }));
+            std::cout << std::endl;
+        }
+    }
+
+    /** Functions built from others, and an argument with long parts; the results stay near bits / log2 10
+     *  digits in each part
+     */
+    void compositions(size_t largest)
+    {
+        std::cout << "composed functions and long arguments to within epsilon = 2^-bits, H = 1/1 + ... + 1/100" << std::endl;
+        std::cout << std::setw(10) << "bits" << std::setw(16) << "arcsin 7/10, us" << std::setw(16) << "tg 7/10, us"
+                  << std::setw(16) << "sin H, us" << std::setw(16) << "log2 H, us" << std::setw(12) << "digits" << std::endl;
+
+        const fraction x(7, 10);
+        fraction harmonic;
+        for (size_t i = 1; i <= 100; ++i)
+        {
+            harmonic += fraction(1, i);
+        }
+        for (size_t bits = 32; bits <= largest; bits *= 4)
+        {
+            const fraction epsilon(1_bi, 1_bi << bits);
+
+            std::cout << std::setw(10) << bits;
+            print_time(measure([&] { x.arcsin(epsilon); }));
+            print_time(measure([&] { x.tg(epsilon); }));
+            print_time(measure([&] { harmonic.sin(epsilon); }));
+            print_time(measure([&] { harmonic.log2(epsilon); }));
+            std::cout << std::setw(12) << x.arcsin(epsilon).to_string().size() << std::endl;
+        }
+    }
+
+    /** The same calls over and over at one epsilon, which after the first take pi, ln 2 and ln 10 from the cache
+     */
+    void repeated(size_t largest)
+    {
+        std::cout << "repeated calls to within epsilon = 2^-bits" << std::endl;
+        std::cout << std::setw(10) << "bits" << std::setw(16) << "log2 3, us" << std::setw(16) << "lg 3, us"
+                  << std::setw(16) << "sin 100, us" << std::setw(16) << "cos 10^6/7, us" << std::setw(16) << "arctg 3, us"
+                  << std::endl;
+
+        const fraction three(3, 1);
+        const fraction hundred(100, 1);
+        const fraction large(1000000, 7);
+        for (size_t bits = 32; bits <= largest; bits *= 4)
+        {
+            const fraction epsilon(1_bi, 1_bi << bits);
+
+            std::cout << std::setw(10) << bits;
+            print_time(measure([&] { three.log2(epsilon); }));
+            print_time(measure([&] { three.lg(epsilon); }));
+            print_time(measure([&] { hundred.sin(epsilon); }));
+            print_time(measure([&] { large.cos(epsilon); }));
+            print_time(measure([&] { three.arctg(epsilon); }));
+            std::cout << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t largest = argc > 1 ? std::stoul(argv[1]) : 4000;
+
+    harmonic_series(largest);
+    std::cout << std::endl;
+    functions(largest);
+    std::cout << std::endl;
+    compositions(largest);
+    std::cout << std::endl;
+    repeated(largest);
+
+    return 0;
+}
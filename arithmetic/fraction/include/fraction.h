@@ -15,12 +15,31 @@ private:
 
     void optimise(); //сокращает дробь
 
+    /** Henrici's forms for reduced operands: the factors that can cancel are found by gcds of the operands
+     *  rather than of the full cross products
+     */
+    void add(fraction const &other, bool subtract);
+
+    void multiply(big_int const &numerator, big_int const &denominator);
+
+    /** log2 of a positive epsilon, which the functions below turn into the number of terms or steps they take
+     */
+    static double log2_of(fraction const &epsilon);
+
+    /** Rounding to power-of-two denominators, and the series and constants the functions below are built from
+     */
+    struct evaluation;
+
 public:
 
     /** Perfect forwarding ctor
      */
     template<std::convertible_to<big_int> f, std::convertible_to<big_int> s>
-    fraction(f &&numerator, s &&denominator);
+    fraction(f &&numerator, s &&denominator)
+        : _numerator(std::forward<f>(numerator)),
+          _denominator(std::forward<s>(denominator)) {
+        optimise();
+    }
 
     fraction(pp_allocator<big_int::value_type> = pp_allocator<big_int::value_type>());
 
@@ -58,6 +77,14 @@ public:
 
     std::string to_string() const;
 
+public:
+
+    /** pi and e to within epsilon, from values cached at the highest precision asked for so far
+     */
+    static fraction pi(fraction const &epsilon = fraction(1_bi, 1000000_bi));
+
+    static fraction e(fraction const &epsilon = fraction(1_bi, 1000000_bi));
+
 public:
 
     fraction sin(fraction const &epsilon = fraction(1_bi, 1000000_bi)) const;
@@ -1,21 +1,466 @@
 #include "../include/fraction.h"
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <mutex>
+#include <numbers>
 #include <numeric>
 #include <sstream>
 #include <regex>
 
+namespace {
 
-big_int gcd(big_int a, big_int b) {
-    if (a < 0) a = -a;
-    if (b < 0) b = -b;
-    while (b != 0) {
-        big_int t = b;
-        b = a % b;
-        a = t;
+    big_int cancel(big_int const &value, big_int const &divisor) {
+        return divisor == 1 ? value : value / divisor;
     }
-    return a;
+
+    bool fits_limb(big_int const &value) {
+        static const big_int bound(1ull << 32);
+        static const big_int negative_bound(-(1ll << 32));
+        return value < bound && value > negative_bound;
+    }
+
+    /** log2 |value| from its leading bits, -infinity for zero
+     */
+    double log2_abs(big_int const &value) {
+        if (!value) {
+            return -std::numeric_limits<double>::infinity();
+        }
+        return std::log2(static_cast<double>(value.leading_bits()))
+               + (static_cast<double>(value.bit_width()) - 64.0);
+    }
+
+    /*
+     * Binary splitting. A series whose term k is a(k)/b(k) * p(0)...p(k) / (q(0)...q(k)) for integers p, q, a, b
+     * is summed over [from, to) as the integers P, Q, B and T with the sum T / (B Q), where P, Q and B are the
+     * products of p, q and b. Halves of the range are combined by
+     *     T = B2 Q2 T1 + B1 P1 T2
+     * so that the products are of balanced sizes, and the sum becomes a fraction only once, at the end.
+     */
+
+    struct split_sum {
+        big_int P;
+        big_int Q;
+        big_int B;
+        big_int T;
+    };
+
+    template<class Series>
+    split_sum split(Series const &series, size_t from, size_t to) {
+        if (to - from == 1) {
+            split_sum leaf{series.p(from), series.q(from), series.b(from), 0};
+            leaf.T = series.a(from) * leaf.P;
+            return leaf;
+        }
+
+        const size_t middle = from + (to - from) / 2;
+        split_sum left = split(series, from, middle);
+        split_sum right = split(series, middle, to);
+        left.T = right.B * right.Q * left.T + left.B * left.P * right.T;
+        left.P *= right.P;
+        left.Q *= right.Q;
+        left.B *= right.B;
+        return left;
+    }
+
+    /** u/v given as integers, with log2 |u/v|
+     */
+    struct ratio {
+        big_int u;
+        big_int v;
+        double log2;
+    };
+
+    ratio as_ratio(big_int const &u, big_int const &v) {
+        return {u, v, log2_abs(u) - log2_abs(v)};
+    }
+
+    /** 2^-k for the least k with 2^-k <= 2^log2_epsilon
+     */
+    fraction epsilon_of(double log2_epsilon) {
+        const auto k = static_cast<long long>(std::ceil(-log2_epsilon));
+        return k >= 0 ? fraction(1_bi, 1_bi << static_cast<size_t>(k)) : fraction(1_bi << static_cast<size_t>(-k), 1_bi);
+    }
+
+    /** sin x = x - x^3/3! + x^5/5! - ...
+     */
+    struct sine_series {
+        ratio x;
+        big_int u2 = x.u * x.u;
+        big_int v2 = x.v * x.v;
+
+        big_int p(size_t k) const { return k == 0 ? x.u : 0_bi - u2; }
+        big_int q(size_t k) const { return k == 0 ? x.v : v2 * big_int(2 * k) * big_int(2 * k + 1); }
+        big_int a(size_t) const { return 1; }
+        big_int b(size_t) const { return 1; }
+        double log2_ratio(size_t k) const { return 2 * x.log2 - std::log2(2.0 * k * (2.0 * k + 1)); }
+    };
+
+    /** cos x = 1 - x^2/2! + x^4/4! - ...
+     */
+    struct cosine_series {
+        ratio x;
+        big_int u2 = x.u * x.u;
+        big_int v2 = x.v * x.v;
+
+        big_int p(size_t k) const { return k == 0 ? 1_bi : 0_bi - u2; }
+        big_int q(size_t k) const { return k == 0 ? 1_bi : v2 * big_int(2 * k - 1) * big_int(2 * k); }
+        big_int a(size_t) const { return 1; }
+        big_int b(size_t) const { return 1; }
+        double log2_ratio(size_t k) const { return 2 * x.log2 - std::log2((2.0 * k - 1) * 2.0 * k); }
+    };
+
+    /** x + sign x^3/3 + x^5/5 + sign x^7/7 + ..., arctangent for sign -1 and the inverse hyperbolic tangent
+     *  for sign 1
+     */
+    struct odd_power_series {
+        ratio x;
+        int sign;
+        big_int u2 = x.u * x.u;
+        big_int v2 = x.v * x.v;
+
+        big_int p(size_t k) const { return k == 0 ? x.u : sign < 0 ? 0_bi - u2 : u2; }
+        big_int q(size_t k) const { return k == 0 ? x.v : v2; }
+        big_int a(size_t) const { return 1; }
+        big_int b(size_t k) const { return big_int(2 * k + 1); }
+        double log2_ratio(size_t k) const { return 2 * x.log2 + std::log2((2.0 * k - 1) / (2.0 * k + 1)); }
+    };
+
+    /** Euler's arctangent series, arctg x = sum of 2^2k (k!)^2 / (2k + 1)! * x^(2k + 1) / (1 + x^2)^(k + 1),
+     *  whose terms all have the sign of x and fall by x^2 / (1 + x^2), at least halving for |x| <= 1
+     */
+    struct euler_arctangent_series {
+        ratio x;
+        big_int u2 = x.u * x.u;
+        big_int w = u2 + x.v * x.v;
+
+        big_int p(size_t k) const { return k == 0 ? x.u * x.v : big_int(2 * k) * u2; }
+        big_int q(size_t k) const { return k == 0 ? w : big_int(2 * k + 1) * w; }
+        big_int a(size_t) const { return 1; }
+        big_int b(size_t) const { return 1; }
+        double log2_ratio(size_t k) const {
+            return std::log2(2.0 * k / (2.0 * k + 1)) + 2 * x.log2 - std::log2(1 + std::exp2(2 * x.log2));
+        }
+    };
+
+    /** e^x = 1 + x + x^2/2! + x^3/3! + ...
+     */
+    struct exponential_series {
+        ratio x;
+
+        big_int p(size_t k) const { return k == 0 ? 1_bi : x.u; }
+        big_int q(size_t k) const { return k == 0 ? 1_bi : big_int(k) * x.v; }
+        big_int a(size_t) const { return 1; }
+        big_int b(size_t) const { return 1; }
+        double log2_ratio(size_t k) const { return x.log2 - std::log2(static_cast<double>(k)); }
+    };
+
+    /** (1 + t)^(1/n) = sum of binomial(1/n, k) t^k for |t| < 1
+     */
+    struct binomial_series {
+        ratio t;
+        size_t n;
+
+        big_int p(size_t k) const { return k == 0 ? 1_bi : (1_bi - big_int(n) * big_int(k - 1)) * t.u; }
+        big_int q(size_t k) const { return k == 0 ? 1_bi : big_int(n) * big_int(k) * t.v; }
+        big_int a(size_t) const { return 1; }
+        big_int b(size_t) const { return 1; }
+        double log2_ratio(size_t k) const {
+            return t.log2 + std::log2(std::abs(1.0 - static_cast<double>(n) * static_cast<double>(k - 1))
+                                      / (static_cast<double>(n) * static_cast<double>(k)));
+        }
+    };
 }
 
+/*
+ * Results are rounded to the nearest fraction with denominator 2^k for k = ceil(-log2 epsilon), so that they take
+ * about k bits whatever their exact value would have taken. A series then ends in one division rather than the gcd
+ * of its full T and B Q, and arguments with longer parts are rounded the same way before they reach a series.
+ */
+struct fraction::evaluation {
+
+    /** numerator / denominator to within epsilon / 2, unchanged if the denominator is already at most 2^k
+     */
+    static fraction nearest(big_int numerator, big_int denominator, double log2_epsilon) {
+        if (denominator < 0) {
+            numerator = 0_bi - numerator;
+            denominator = 0_bi - denominator;
+        }
+        const auto bits = static_cast<size_t>(std::max(0.0, std::ceil(-log2_epsilon)));
+        if (denominator <= (1_bi << bits)) {
+            return fraction(std::move(numerator), std::move(denominator));
+        }
+
+        const bool negative = numerator < 0;
+        if (negative) {
+            numerator = 0_bi - numerator;
+        }
+        // round(n 2^k / d) = floor((n 2^(k + 1) + d) / 2d)
+        numerator <<= bits + 1;
+        numerator += denominator;
+        denominator <<= 1;
+        big_int rounded = numerator / denominator;
+        if (rounded == 0) {
+            return fraction(0, 1);
+        }
+
+        const size_t zeros = std::min(rounded.countr_zero(), bits);
+        rounded >>= zeros;
+        fraction result;
+        result._numerator = negative ? 0_bi - rounded : std::move(rounded);
+        result._denominator = 1_bi << (bits - zeros);
+        return result;
+    }
+
+    static fraction nearest(fraction const &value, double log2_epsilon) {
+        return nearest(value._numerator, value._denominator, log2_epsilon);
+    }
+
+    /** dividend / divisor to within epsilon / 2, without reducing the exact quotient first
+     */
+    static fraction quotient(fraction const &dividend, fraction const &divisor, double log2_epsilon) {
+        return nearest(dividend._numerator * divisor._denominator, dividend._denominator * divisor._numerator, log2_epsilon);
+    }
+
+    /** As many first terms of the series as leave out only terms of log2 magnitude below that of epsilon, less
+     *  one bit for the tail, from where the terms at least halve. log2_ratio(k) is log2 |term k / term k - 1|
+     */
+    template<class Series>
+    static size_t terms(Series const &series, double log2_first, double log2_epsilon) {
+        size_t count = 1;
+        double log2_term = log2_first;
+        while (true) {
+            const double log2_ratio = series.log2_ratio(count);
+            log2_term += log2_ratio;
+            if (log2_term < log2_epsilon - 1 && log2_ratio <= -1) {
+                return count;
+            }
+            ++count;
+        }
+    }
+
+    /** The sum of the terms, rounded by nearest, which takes the other half of epsilon
+     */
+    template<class Series>
+    static fraction sum(Series const &series, double log2_first, double log2_epsilon) {
+        split_sum total = split(series, 0, terms(series, log2_first, log2_epsilon));
+        return nearest(std::move(total.T), total.B * total.Q, log2_epsilon);
+    }
+
+    /** The sum scaled by 2^precision, to within 2
+     */
+    template<class Series>
+    static big_int scaled_sum(Series const &series, double log2_first, size_t precision) {
+        split_sum total = split(series, 0, terms(series, log2_first, -static_cast<double>(precision)));
+        total.T <<= precision;
+        return total.T / (total.B * total.Q);
+    }
+
+    /*
+     * Bit-burst evaluation of arguments with long parts, such as those left by argument reduction. The argument
+     * is taken apart into a first piece of 16 bits after the point and further pieces of the next 16, 32, 64, ...
+     * bits, each short for how small it is, so that their series together cost about as much as that of one short
+     * argument. The pieces are put back together in fixed point, as integers scaled by 2^precision.
+     */
+
+    static constexpr size_t first_piece = 16;
+
+    static bool is_long(fraction const &x) {
+        static const big_int bound = 1_bi << 64;
+        return x._denominator > bound;
+    }
+
+    /** 2^-precision below epsilon by enough for the errors of a few units from each of about log2(bits) pieces
+     */
+    static size_t fixed_precision(double log2_epsilon) {
+        const double bits = std::max(1.0, -log2_epsilon);
+        return static_cast<size_t>(std::ceil(bits + std::log2(bits) + 4));
+    }
+
+    /** sin x and cos x scaled by 2^precision for 0 <= x = numerator / denominator < 1, by
+     *  sin(a + b) = sin a cos b + cos a sin b and cos(a + b) = cos a cos b - sin a sin b
+     */
+    static std::pair<big_int, big_int> sine_cosine(big_int const &numerator, big_int const &denominator,
+                                                   size_t precision) {
+        big_int sine = 0;
+        big_int cosine = 1_bi << precision;
+        big_int taken = 0;
+        for (size_t from = 0, to = std::min(first_piece, precision); from < precision;
+             from = to, to = std::min(2 * to, precision)) {
+            big_int leading = (numerator << to) / denominator;
+            const big_int piece = leading - (taken << (to - from));
+            taken = std::move(leading);
+            if (piece == 0) {
+                continue;
+            }
+
+            const ratio y = as_ratio(piece, 1_bi << to);
+            const big_int s = scaled_sum(sine_series{y}, y.log2, precision);
+            const big_int c = scaled_sum(cosine_series{y}, 0, precision);
+            big_int next_sine = (sine * c + cosine * s) >> precision;
+            cosine = (cosine * c - sine * s) >> precision;
+            sine = std::move(next_sine);
+        }
+        return {std::move(sine), std::move(cosine)};
+    }
+
+    /** arctg x for sign -1 or atanh x for sign 1, scaled by 2^precision for 0 <= x <= 1/2. Once a piece c is
+     *  taken, what is left is (x - c) / (1 - sign x c), as arctg x = arctg c + arctg((x - c) / (1 + x c)) and
+     *  atanh x = atanh c + atanh((x - c) / (1 - x c))
+     */
+    static big_int inverse_tangent(big_int const &numerator, big_int const &denominator, int sign,
+                                   size_t precision) {
+        const big_int one = 1_bi << precision;
+        big_int rest = (numerator << precision) / denominator;
+        big_int result = 0;
+        for (size_t to = std::min(first_piece, precision); rest != 0; to = std::min(2 * to, precision)) {
+            const big_int piece = rest >> (precision - to);
+            if (piece == 0) {
+                continue;
+            }
+
+            const odd_power_series series{as_ratio(piece, 1_bi << to), sign};
+            result += scaled_sum(series, series.x.log2, precision);
+            const big_int c = piece << (precision - to);
+            const big_int product = (rest * c) >> precision;
+            rest = ((rest - c) << precision) / (sign < 0 ? one + product : one - product);
+        }
+        return result;
+    }
+
+    /*
+     * Constants are kept at the highest precision asked for so far, which grows at least twofold when it has to,
+     * and handed out rounded to the precision of the call. The cached value takes one half of epsilon, the rounding
+     * the other.
+     */
+    struct cached_constant {
+        std::mutex lock;
+        fraction value;
+        size_t bits = 0;
+
+        template<class Compute>
+        fraction get(double log2_epsilon, Compute compute) {
+            const auto needed = static_cast<size_t>(std::max(0.0, std::ceil(1 - log2_epsilon)));
+            fraction copy;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (bits < needed) {
+                    const size_t extended = std::max({needed, 2 * bits, size_t(64)});
+                    value = compute(-static_cast<double>(extended));
+                    bits = extended;
+                }
+                copy = value;
+            }
+            return nearest(copy, log2_epsilon);
+        }
+    };
+
+    /** ln 2 = 2 atanh(1/3)
+     */
+    static fraction ln2(double log2_epsilon) {
+        static cached_constant cache;
+        return cache.get(log2_epsilon, [](double log2_precision) {
+            const odd_power_series series{{1, 3, -std::log2(3.0)}, 1};
+            return fraction(2, 1) * sum(series, series.x.log2, log2_precision - 1);
+        });
+    }
+
+    /** ln 10 = 3 ln 2 + ln(5/4) = 6 atanh(1/3) + 2 atanh(1/9)
+     */
+    static fraction ln10(double log2_epsilon) {
+        static cached_constant cache;
+        return cache.get(log2_epsilon, [](double log2_precision) {
+            const odd_power_series third{{1, 3, -std::log2(3.0)}, 1};
+            const odd_power_series ninth{{1, 9, -std::log2(9.0)}, 1};
+            return nearest(fraction(6, 1) * sum(third, third.x.log2, log2_precision - 5)
+                           + fraction(2, 1) * sum(ninth, ninth.x.log2, log2_precision - 4), log2_precision);
+        });
+    }
+
+    /** pi = 16 arctg(1/5) - 4 arctg(1/239)
+     */
+    static fraction pi(double log2_epsilon) {
+        static cached_constant cache;
+        return cache.get(log2_epsilon, [](double log2_precision) {
+            const odd_power_series fifth{{1, 5, -std::log2(5.0)}, -1};
+            const odd_power_series other{{1, 239, -std::log2(239.0)}, -1};
+            return nearest(fraction(16, 1) * sum(fifth, fifth.x.log2, log2_precision - 6)
+                           - fraction(4, 1) * sum(other, other.x.log2, log2_precision - 4), log2_precision);
+        });
+    }
+
+    static fraction e(double log2_epsilon) {
+        static cached_constant cache;
+        return cache.get(log2_epsilon, [](double log2_precision) {
+            return sum(exponential_series{{1, 1, 0}}, 0, log2_precision);
+        });
+    }
+
+    /** sin x, or cos x = sin(x + pi/2), from sin(r + q pi/2) for r = x - n pi/2 in about [-pi/4, pi/4] and
+     *  q = n mod 4 or n + 1 mod 4, which is one of sin r, cos r, -sin r and -cos r
+     */
+    static fraction sine(fraction const &x, double log2_epsilon, bool cosine) {
+        fraction r = x;
+        int quarter = cosine ? 1 : 0;
+        const double log2_x = as_ratio(x._numerator, x._denominator).log2;
+        // A short argument below about bits / 8 costs less to sum directly than reduced, with the long parts r has
+        if (log2_x > std::log2(std::numbers::pi / 4) && (is_long(x) || log2_x > std::log2(std::max(1.0, -log2_epsilon)) - 3)) {
+            // A rough n is good enough, but the pi/2 it is multiplied by has to be good to epsilon / 16n
+            const big_int n = quotient(x, pi(-log2_x - 8) / fraction(2, 1), 0)._numerator;
+            const fraction half_pi = pi(log2_epsilon - log2_abs(n) - 3) / fraction(2, 1);
+            r = x - fraction(n, 1) * half_pi;
+            const big_int rest = (n < 0 ? 0_bi - n : n) % 4;
+            const int residue = rest == 0 ? 0 : rest == 1 ? 1 : rest == 2 ? 2 : 3;
+            quarter += n < 0 ? 4 - residue : residue;
+        }
+        r = nearest(r, log2_epsilon - 3);
+
+        fraction result;
+        if (is_long(r)) {
+            const bool negative = r._numerator < 0;
+            const size_t precision = fixed_precision(log2_epsilon - 1);
+            auto [s, c] = sine_cosine(negative ? 0_bi - r._numerator : r._numerator, r._denominator, precision);
+            if (quarter % 2 == 0 && negative) {
+                s = 0_bi - s;
+            }
+            result = nearest(quarter % 2 == 0 ? std::move(s) : std::move(c), 1_bi << precision, log2_epsilon - 1);
+        } else if (r._numerator == 0) {
+            result = fraction(quarter % 2, 1);
+        } else if (quarter % 2 == 0) {
+            const sine_series series{as_ratio(r._numerator, r._denominator)};
+            result = sum(series, series.x.log2, log2_epsilon - 1);
+        } else {
+            const cosine_series series{as_ratio(r._numerator, r._denominator)};
+            result = sum(series, 0, log2_epsilon - 1);
+        }
+        return quarter % 4 >= 2 ? -result : result;
+    }
+
+    /** cos x / sin x, or 1 / sin x if reciprocal, with sine and cosine swapped if cosine is set; the divisor c
+     *  must not be zero. Rounded to epsilon it can be, so c is first taken to 2^p for p from the magnitude of x,
+     *  doubling the bits until the error is below |c| / 2, which bounds |c| from below by m = |c| / 2.
+     *  With errors ds and dc the quotient is then off by less than 2 (ds + dc) / m^2, so both are taken to
+     *  epsilon m^2 / 8, leaving the other half of epsilon for rounding it
+     */
+    static fraction divided_by_sine(fraction const &x, double log2_epsilon, bool cosine, bool reciprocal) {
+        const double log2_guess = cosine ? 0.0 : std::min(0.0, as_ratio(x._numerator, x._denominator).log2);
+        double precision = std::min(log2_epsilon, log2_guess) - 4;
+        fraction divisor = sine(x, precision, cosine);
+        while (divisor._numerator == 0 || as_ratio(divisor._numerator, divisor._denominator).log2 < precision + 1) {
+            precision *= 2;
+            divisor = sine(x, precision, cosine);
+        }
+
+        const double log2_lower = as_ratio(divisor._numerator, divisor._denominator).log2 - 1;
+        const double tighter = std::min(log2_epsilon, 0.0) + 2 * log2_lower - 3;
+        if (tighter < precision) {
+            divisor = sine(x, tighter, cosine);
+        }
+        const fraction dividend = reciprocal ? fraction(1, 1) : sine(x, tighter, !cosine);
+        return quotient(dividend, divisor, log2_epsilon - 1);
+    }
+};
+
 void fraction::optimise() {
     if (_denominator == 0) {
         throw std::invalid_argument("Denominator cannot be zero");
@@ -24,33 +469,75 @@ void fraction::optimise() {
         _denominator = 1;
         return;
     }
-    big_int divisor = gcd(_numerator, _denominator);
-    _numerator /= divisor;
-    _denominator /= divisor;
+    big_int divisor = big_int::gcd(_numerator, _denominator);
+    if (divisor != 1) {
+        _numerator /= divisor;
+        _denominator /= divisor;
+    }
     if (_denominator < 0) {
-        _numerator = -_numerator;
-        _denominator = -_denominator;
+        _numerator = 0_bi - _numerator;
+        _denominator = 0_bi - _denominator;
     }
 }
 
-template<std::convertible_to<big_int> f, std::convertible_to<big_int> s>
-fraction::fraction(f &&numerator, s &&denominator)
-    : _numerator(std::forward<f>(numerator)),
-      _denominator(std::forward<s>(denominator)) {
-    if (_denominator == 0) {
-        throw std::invalid_argument("Denominator cannot be zero");
+fraction::fraction(const pp_allocator<big_int::value_type> allocator)
+    : _numerator(0, allocator), _denominator(1, allocator) {
+}
+
+void fraction::add(fraction const &other, bool subtract) {
+    // With d = gcd(d1, d2) the sum is t / (d1/d * d2/d * d) for t = n1 * d2/d + n2 * d1/d, and only gcd(t, d) cancels
+    const big_int divisor = big_int::gcd(_denominator, other._denominator);
+    const big_int scale = cancel(_denominator, divisor);
+    const big_int other_scale = cancel(other._denominator, divisor);
+    const big_int part = other._numerator * scale;
+
+    _numerator *= other_scale;
+    if (subtract) {
+        _numerator -= part;
+    } else {
+        _numerator += part;
     }
-    optimise();
+    if (_numerator == 0) {
+        _denominator = 1;
+        return;
+    }
+
+    const big_int common = divisor == 1 ? divisor : big_int::gcd(_numerator, divisor);
+    _numerator = cancel(_numerator, common);
+    _denominator = scale * other_scale * cancel(divisor, common);
 }
 
-fraction::fraction(const pp_allocator<big_int::value_type> allocator)
-    : _numerator(0, allocator), _denominator(1, allocator) {
+void fraction::multiply(big_int const &numerator, big_int const &denominator) {
+    if (_numerator == 0 || numerator == 0) {
+        _numerator = 0;
+        _denominator = 1;
+        return;
+    }
+
+    // Two gcds on single limbs cost more than one on the products
+    if (fits_limb(_numerator) && fits_limb(_denominator) && fits_limb(numerator) && fits_limb(denominator)) {
+        big_int product = _numerator * numerator;
+        _denominator = _denominator * denominator;
+        _numerator = std::move(product);
+        optimise();
+        return;
+    }
+
+    // Only n1 with d2 and n2 with d1 can have common factors
+    const big_int first = big_int::gcd(_numerator, denominator);
+    const big_int second = big_int::gcd(numerator, _denominator);
+    const big_int numerator_part = cancel(numerator, second);
+    const big_int denominator_part = cancel(denominator, first);
+    _numerator = cancel(_numerator, first) * numerator_part;
+    _denominator = cancel(_denominator, second) * denominator_part;
+    if (_denominator < 0) {
+        _numerator = 0_bi - _numerator;
+        _denominator = 0_bi - _denominator;
+    }
 }
 
 fraction &fraction::operator+=(fraction const &other) & {
-    _numerator = _numerator * other._denominator + _denominator * other._numerator;
-    _denominator = _denominator * other._denominator;
-    optimise();
+    add(other, false);
     return *this;
 }
 
@@ -61,9 +548,7 @@ fraction fraction::operator+(fraction const &other) const {
 }
 
 fraction &fraction::operator-=(fraction const &other) & {
-    _numerator = _numerator * other._denominator - _denominator * other._numerator;
-    _denominator = _denominator * other._denominator;
-    optimise();
+    add(other, true);
     return *this;
 }
 
@@ -75,15 +560,13 @@ fraction fraction::operator-(fraction const &other) const {
 
 fraction fraction::operator-() const {
     fraction result(*this);
-    result._numerator = -result._numerator;
+    result._numerator = 0_bi - result._numerator;
     result.optimise();
     return result;
 }
 
 fraction &fraction::operator*=(fraction const &other) & {
-    _numerator *= other._numerator;
-    _denominator *= other._denominator;
-    optimise();
+    multiply(other._numerator, other._denominator);
     return *this;
 }
 
@@ -97,9 +580,7 @@ fraction &fraction::operator/=(fraction const &other) & {
     if (other._numerator == 0) {
         throw std::invalid_argument("Division by zero");
     }
-    _numerator *= other._denominator;
-    _denominator *= other._numerator;
-    optimise();
+    multiply(other._denominator, other._numerator);
     return *this;
 }
 
@@ -119,7 +600,7 @@ std::partial_ordering fraction::operator<=>(const fraction& other) const noexcep
     if (lhs < rhs) return std::partial_ordering::less;
     if (lhs > rhs) return std::partial_ordering::greater;
     return std::partial_ordering::equivalent;
-}s
+}
 
 std::ostream &operator<<(std::ostream &stream, fraction const &obj) {
     stream << obj.to_string();
@@ -150,90 +631,140 @@ std::string fraction::to_string() const {
     return ss.str();
 }
 
+double fraction::log2_of(fraction const &epsilon) {
+    if (epsilon._numerator <= 0) {
+        throw std::invalid_argument("Epsilon must be positive");
+    }
+    return as_ratio(epsilon._numerator, epsilon._denominator).log2;
+}
+
+fraction fraction::pi(fraction const &epsilon) {
+    return evaluation::pi(log2_of(epsilon));
+}
+
+fraction fraction::e(fraction const &epsilon) {
+    return evaluation::e(log2_of(epsilon));
+}
+
 fraction fraction::sin(fraction const &epsilon) const {
-    fraction x = *this;
-    fraction result(0, 1);
-    fraction term = x;
-    big_int factorial = 1;
-    int n = 1;
-    while (term > epsilon || term < -epsilon) {
-        result += term;
-        n += 2;
-        factorial *= n * (n - 1);
-        term *= x * x;
-        term /= fraction(factorial, 1);
-        term = -term;
+    const double log2_epsilon = log2_of(epsilon);
+    if (_numerator == 0) {
+        return fraction(0, 1);
     }
-    return result;
+    return evaluation::sine(*this, log2_epsilon, false);
 }
 
 fraction fraction::cos(fraction const &epsilon) const {
-    fraction x = *this;
-    fraction result(1, 1);
-    fraction term(1, 1);
-    big_int factorial = 1;
-    int n = 0;
-    while (term > epsilon || term < -epsilon) {
-        if (n > 0) {
-            result += term;
-        }
-        n += 2;
-        factorial *= n * (n - 1);
-        term *= x * x;
-        term /= fraction(factorial, 1);
-        term = -term;
+    const double log2_epsilon = log2_of(epsilon);
+    if (_numerator == 0) {
+        return fraction(1, 1);
     }
-    return result;
+    return evaluation::sine(*this, log2_epsilon, true);
 }
 
+// cos x is not zero for any rational x, and sin x only for x = 0
+
 fraction fraction::tg(fraction const &epsilon) const {
-    fraction cosine = this->cos(epsilon);
-    if (cosine._numerator == 0) {
-        throw std::domain_error("Tangent undefined");
-    }
-    return this->sin(epsilon) / cosine;
+    return evaluation::divided_by_sine(*this, log2_of(epsilon), true, false);
 }
 
 fraction fraction::ctg(fraction const &epsilon) const {
-    fraction sine = this->sin(epsilon);
-    if (sine._numerator == 0) {
+    const double log2_epsilon = log2_of(epsilon);
+    if (_numerator == 0) {
         throw std::domain_error("Cotangent undefined");
     }
-    return this->cos(epsilon) / sine;
+    return evaluation::divided_by_sine(*this, log2_epsilon, false, false);
 }
 
 fraction fraction::sec(fraction const &epsilon) const {
-    fraction cosine = this->cos(epsilon);
-    if (cosine._numerator == 0) {
-        throw std::domain_error("Secant undefined");
-    }
-    return fraction(1, 1) / cosine;
+    return evaluation::divided_by_sine(*this, log2_of(epsilon), true, true);
 }
 
 fraction fraction::cosec(fraction const &epsilon) const {
-    fraction sine = this->sin(epsilon);
-    if (sine._numerator == 0) {
+    const double log2_epsilon = log2_of(epsilon);
+    if (_numerator == 0) {
         throw std::domain_error("Cosecant undefined");
     }
-    return fraction(1, 1) / sine;
+    return evaluation::divided_by_sine(*this, log2_epsilon, false, true);
+}
+
+fraction fraction::arcsin(fraction const &epsilon) const {
+    const double log2_epsilon = log2_of(epsilon);
+    const fraction one(1, 1);
+    if (*this > one || *this < -one) {
+        throw std::domain_error("Arcsine is defined on [-1, 1]");
+    }
+    if (*this == one || *this == -one) {
+        const fraction half_pi = evaluation::pi(log2_epsilon + 1) / fraction(2, 1);
+        return _numerator < 0 ? -half_pi : half_pi;
+    }
+
+    // arcsin x = 2 arctg(x / (1 + sqrt(1 - x^2))), where the error of the root is not amplified
+    const fraction root = (one - *this * *this).root(2, epsilon_of(log2_epsilon - 3));
+    return fraction(2, 1) * (*this / (one + root)).arctg(epsilon_of(log2_epsilon - 2));
+}
+
+fraction fraction::arccos(fraction const &epsilon) const {
+    const double log2_epsilon = log2_of(epsilon);
+    const fraction half_pi = evaluation::pi(log2_epsilon) / fraction(2, 1);
+    return half_pi - arcsin(epsilon_of(log2_epsilon - 1));
 }
 
 fraction fraction::arctg(fraction const &epsilon) const {
+    const double log2_epsilon = log2_of(epsilon);
+    if (_numerator == 0) {
+        return fraction(0, 1);
+    }
     if (_numerator < 0) {
         return -(-*this).arctg(epsilon);
     }
-    if (*this > fraction(1, 1)) {
-        return fraction(1, 2) - (fraction(1, 1) / *this).arctg(epsilon);
+
+    // arctg x = pi/4 + arctg((x - 1) / (x + 1)) and arctg x = pi/2 - arctg(1/x) keep the series to
+    // |w| <= tan(pi/8), where its terms fall at least sevenfold
+    const double log2_x = as_ratio(_numerator, _denominator).log2;
+    const double log2_bound = std::log2(std::numbers::sqrt2 - 1);
+    const int eighths = log2_x <= log2_bound ? 0 : log2_x < -log2_bound ? 1 : 2;
+    const fraction one(1, 1);
+    const fraction w = eighths == 0 ? evaluation::nearest(*this, log2_epsilon - 3)
+                     : eighths == 1 ? evaluation::quotient(*this - one, *this + one, log2_epsilon - 3)
+                                    : evaluation::nearest(_denominator, _numerator, log2_epsilon - 3);
+
+    fraction result;
+    if (evaluation::is_long(w)) {
+        const size_t precision = evaluation::fixed_precision(log2_epsilon - 1);
+        const bool negative = w._numerator < 0;
+        const big_int scaled = evaluation::inverse_tangent(negative ? 0_bi - w._numerator : w._numerator,
+                                                           w._denominator, -1, precision);
+        result = evaluation::nearest(negative ? 0_bi - scaled : scaled, 1_bi << precision, log2_epsilon - 1);
+    } else if (w._numerator != 0) {
+        const euler_arctangent_series series{as_ratio(w._numerator, w._denominator)};
+        const double log2_first = series.x.log2 - std::log2(1 + std::exp2(2 * series.x.log2));
+        result = evaluation::sum(series, log2_first, log2_epsilon - 1);
     }
-    fraction result(0, 1);
-    fraction term = *this;
-    int n = 1;
-    while (term > epsilon || term < -epsilon) {
-        result += fraction((n % 2 == 0 ? -1 : 1), n) * term;
-        n += 2;
-        term *= *this * *this;
+    if (eighths == 0) {
+        return result;
     }
-    return result;
+    const fraction quarter_pi = evaluation::pi(log2_epsilon - 1) / fraction(4, 1);
+    return eighths == 1 ? quarter_pi + result : fraction(2, 1) * quarter_pi - result;
+}
+
+fraction fraction::arcctg(fraction const &epsilon) const {
+    const double log2_epsilon = log2_of(epsilon);
+    return evaluation::pi(log2_epsilon) / fraction(2, 1) - arctg(epsilon_of(log2_epsilon - 1));
+}
+
+fraction fraction::arcsec(fraction const &epsilon) const {
+    if (_numerator == 0) {
+        throw std::domain_error("Arcsecant is defined outside (-1, 1)");
+    }
+    return fraction(_denominator, _numerator).arccos(epsilon);
+}
+
+fraction fraction::arccosec(fraction const &epsilon) const {
+    if (_numerator == 0) {
+        throw std::domain_error("Arccosecant is defined outside (-1, 1)");
+    }
+    return fraction(_denominator, _numerator).arcsin(epsilon);
 }
 
 fraction fraction::pow(size_t degree) const {
@@ -253,6 +784,7 @@ fraction fraction::pow(size_t degree) const {
 }
 
 fraction fraction::root(size_t degree, fraction const &epsilon) const {
+    const double log2_epsilon = log2_of(epsilon);
     if (degree == 0) {
         throw std::invalid_argument("Degree cannot be zero");
     }
@@ -262,59 +794,77 @@ fraction fraction::root(size_t degree, fraction const &epsilon) const {
     if (_numerator < 0 && degree % 2 == 0) {
         throw std::domain_error("Even root of negative number is not real");
     }
-    fraction x = *this;
-    if (x._numerator < 0) x = -x;
-    fraction guess = *this / fraction(degree, 1);
-    fraction prev_guess;
-    do {
-        prev_guess = guess;
-        fraction power = guess.pow(degree - 1);
-        if (power._numerator == 0) {
-            throw std::runtime_error("Division by zero in root calculation");
-        }
-        guess = (fraction(degree - 1, 1) * guess + *this / power) / fraction(degree, 1);
-    } while ((guess - prev_guess > epsilon) || (prev_guess - guess > epsilon));
-    if (_numerator < 0 && degree % 2 == 1) {
-        guess = -guess;
+    if (_numerator < 0) {
+        return -(-*this).root(degree, epsilon);
+    }
+    if (_numerator == 0) {
+        return *this;
     }
-    return guess;
+
+    // c = m 2^e close to the root, from doubles; then root = c (1 + t)^(1/degree) for the small t = x / c^degree - 1
+    const double log2_root = as_ratio(_numerator, _denominator).log2 / static_cast<double>(degree);
+    const auto exponent = static_cast<long long>(std::floor(log2_root)) - 52;
+    const big_int mantissa(static_cast<unsigned long long>(std::llround(std::exp2(log2_root - static_cast<double>(exponent)))));
+    const fraction close = exponent >= 0 ? fraction(mantissa << static_cast<size_t>(exponent), 1_bi)
+                                         : fraction(mantissa, 1_bi << static_cast<size_t>(-exponent));
+    // An error dt of t moves the root by about c dt / degree
+    const fraction t = evaluation::nearest(*this / close.pow(degree) - fraction(1, 1), log2_epsilon - log2_root - 3);
+    if (t._numerator == 0) {
+        return close;
+    }
+
+    const binomial_series series{as_ratio(t._numerator, t._denominator), degree};
+    return close * evaluation::sum(series, 0, log2_epsilon - log2_root - 2);
 }
 
 fraction fraction::log2(fraction const &epsilon) const {
-    if (_numerator <= 0 || _denominator <= 0) {
+    const double log2_epsilon = log2_of(epsilon);
+    if (_numerator <= 0) {
         throw std::domain_error("Logarithm of non-positive number is undefined");
     }
-    fraction ln2 = fraction(2, 1).ln(epsilon);
-    return this->ln(epsilon) / ln2;
+    // ln x / ln 2 is off by about 1.5 (d1 + |ln x / ln 2| d2) for errors d1 and d2 of the logarithms
+    const double magnitude = std::log2(std::abs(as_ratio(_numerator, _denominator).log2) + 1);
+    const fraction logarithm = ln(epsilon_of(log2_epsilon - 3));
+    return evaluation::quotient(logarithm, evaluation::ln2(log2_epsilon - magnitude - 4), log2_epsilon - 1);
 }
 
 fraction fraction::ln(fraction const &epsilon) const {
-    if (_numerator <= 0 || _denominator <= 0) {
+    const double log2_epsilon = log2_of(epsilon);
+    if (_numerator <= 0) {
         throw std::domain_error("Natural logarithm of non-positive number is undefined");
     }
-    fraction x = *this;
-    if (x > fraction(2, 1)) {
-        return fraction(1, 1).ln(epsilon) + (x / fraction(2, 1)).ln(epsilon);
-    }
-    if (x < fraction(1, 2)) {
-        return -(fraction(1, 1) / x).ln(epsilon);
-    }
-    fraction y = x - fraction(1, 1);
+
+    // x = 2^m y with y within a factor of sqrt 2 of 1, and ln y = 2 atanh((y - 1) / (y + 1)) for |(y - 1) / (y + 1)| < 0.18
+    const auto m = static_cast<long long>(std::llround(as_ratio(_numerator, _denominator).log2));
+    const big_int scale = 1_bi << static_cast<size_t>(m < 0 ? -m : m);
+    const fraction y = m >= 0 ? *this / fraction(scale, 1_bi) : *this * fraction(scale, 1_bi);
+    // 2 atanh z changes by at most 2.1 dz there
+    const fraction z = evaluation::quotient(y - fraction(1, 1), y + fraction(1, 1), log2_epsilon - 4);
+
     fraction result(0, 1);
-    fraction term = y;
-    int n = 1;
-    while (term > epsilon || term < -epsilon) {
-        result += fraction((n % 2 == 0 ? -1 : 1), n) * term;
-        n++;
-        term *= y;
+    if (evaluation::is_long(z)) {
+        const size_t precision = evaluation::fixed_precision(log2_epsilon - 3);
+        const bool negative = z._numerator < 0;
+        const big_int scaled = evaluation::inverse_tangent(negative ? 0_bi - z._numerator : z._numerator,
+                                                           z._denominator, 1, precision);
+        result = fraction(2, 1) * evaluation::nearest(negative ? 0_bi - scaled : scaled, 1_bi << precision,
+                                                      log2_epsilon - 3);
+    } else if (z._numerator != 0) {
+        const odd_power_series series{as_ratio(z._numerator, z._denominator), 1};
+        result = fraction(2, 1) * evaluation::sum(series, series.x.log2, log2_epsilon - 3);
+    }
+    if (m != 0) {
+        result += fraction(m, 1) * evaluation::ln2(log2_epsilon - std::log2(std::abs(static_cast<double>(m))) - 2);
     }
     return result;
 }
 
 fraction fraction::lg(fraction const &epsilon) const {
-    if (_numerator <= 0 || _denominator <= 0) {
+    const double log2_epsilon = log2_of(epsilon);
+    if (_numerator <= 0) {
         throw std::domain_error("Base-10 logarithm of non-positive number is undefined");
     }
-    fraction ln10 = fraction(10, 1).ln(epsilon);
-    return this->ln(epsilon) / ln10;
+    const double magnitude = std::log2(std::abs(as_ratio(_numerator, _denominator).log2) + 1);
+    const fraction logarithm = ln(epsilon_of(log2_epsilon - 3));
+    return evaluation::quotient(logarithm, evaluation::ln10(log2_epsilon - magnitude - 4), log2_epsilon - 1);
 }
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <fraction.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    big_int random_number(std::mt19937 &generator, size_t limbs)
+    {
+        std::vector<unsigned int> digits(limbs);
+        for (auto &digit : digits)
+        {
+            digit = static_cast<unsigned int>(generator());
+        }
+        digits.back() |= 1;
+        return big_int(digits, generator() % 2 == 0);
+    }
+
+    /** The numerator is coprime to the denominator, which is positive
+     */
+    void expect_reduced(fraction const &value)
+    {
+        const std::string text = value.to_string();
+        const auto slash = text.find('/');
+        ASSERT_NE(slash, std::string::npos) << text;
+        const big_int numerator(text.substr(0, slash));
+        const big_int denominator(text.substr(slash + 1));
+
+        EXPECT_TRUE(denominator > 0_bi) << text;
+        EXPECT_TRUE(big_int::gcd(numerator, denominator) == 1_bi) << text;
+    }
+}
+
+TEST(positive_tests, arithmetic_is_reduced_and_matches_cross_products)
+{
+    std::mt19937 generator(29);
+    for (size_t limbs : {1, 2, 5, 40})
+    {
+        for (int round = 0; round < 20; ++round)
+        {
+            // A shared factor makes the denominators' gcd nontrivial, as in sums of nearby fractions
+            const big_int shared = random_number(generator, 1);
+            const big_int n1 = random_number(generator, limbs);
+            const big_int d1 = random_number(generator, limbs) * shared;
+            const big_int n2 = random_number(generator, limbs);
+            const big_int d2 = random_number(generator, limbs) * shared;
+            const fraction a(n1, d1);
+            const fraction b(n2, d2);
+
+            const fraction sum = a + b;
+            const fraction difference = a - b;
+            const fraction product = a * b;
+            const fraction ratio = a / b;
+            for (fraction const *result : {&a, &b, &sum, &difference, &product, &ratio})
+            {
+                expect_reduced(*result);
+            }
+
+            EXPECT_TRUE(sum == fraction(n1 * d2 + n2 * d1, d1 * d2));
+            EXPECT_TRUE(difference == fraction(n1 * d2 - n2 * d1, d1 * d2));
+            EXPECT_TRUE(product == fraction(n1 * n2, d1 * d2));
+            EXPECT_TRUE(ratio == fraction(n1 * d2, d1 * n2));
+
+            EXPECT_TRUE(sum - b == a);
+            EXPECT_TRUE(ratio * b == a);
+            EXPECT_TRUE(a - a == fraction(0, 1));
+            EXPECT_EQ((a - a).to_string(), "0/1");
+
+            fraction accumulated = a;
+            accumulated += b;
+            accumulated *= b;
+            accumulated /= b;
+            accumulated -= b;
+            EXPECT_TRUE(accumulated == a);
+            expect_reduced(accumulated);
+        }
+    }
+}
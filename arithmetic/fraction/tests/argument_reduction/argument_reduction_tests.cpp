@@ -0,0 +1,47 @@
+#include "../fraction_test_helpers.h"
+
+TEST(positive_tests, long_arguments_are_reduced)
+{
+    const auto sin = [](fraction const &x, fraction const &epsilon) { return x.sin(epsilon); };
+    const auto cos = [](fraction const &x, fraction const &epsilon) { return x.cos(epsilon); };
+    const auto tg = [](fraction const &x, fraction const &epsilon) { return x.tg(epsilon); };
+    const auto sec = [](fraction const &x, fraction const &epsilon) { return x.sec(epsilon); };
+
+    expect_references({
+        // Arguments many periods long, or near a zero of the divisor once reduced
+        {"sin", sin, "123456789/1000", "-0.9986640823434470978675991225831434346922216920104088524025379779830560"},
+        {"cos", cos, "123456789/1000", "0.0516725327143997700427858744384505751040090959421584543901551423592055"},
+        {"tg", tg, "123456789/1000", "-19.3267879448290676836975389115666357500591856864180743469163743115641717"},
+        {"sec", sec, "123456789/1000", "19.3526414802835165260524986576840310796577533831724564878546441010892692"},
+        {"tg", tg, "355/226", "-7497258.1853255871129050718318912486634172679437852631615712234701518378849562"},
+        {"sec", sec, "355/226", "-7497258.1853256538039523374375682147265875682694777996792790880135222233144201"},
+    }, {1, 6, 12, 40});
+}
+
+TEST(positive_tests, cached_constants_serve_lower_and_higher_precisions)
+{
+    const fraction pi = exact("3.1415926535897932384626433832795028841971693993751058209749445923078164062862089986"
+                              "280348253421170679821480865132823066470938446096");
+    const fraction e = exact("2.7182818284590452353602874713526624977572470936999595749669676277240766303535475945"
+                             "713821785251664274274663919320030599218174135966");
+
+    // The first call fills the caches, the second is served from them and the third extends them
+    for (size_t exponent : {40, 10, 120, 40})
+    {
+        const fraction epsilon = power_of_ten(exponent);
+        expect_within(fraction::pi(epsilon), pi, epsilon, "pi to 1e-" + std::to_string(exponent));
+        expect_within(fraction::e(epsilon), e, epsilon, "e to 1e-" + std::to_string(exponent));
+    }
+}
+
+TEST(positive_tests, long_arguments_are_reduced_to_coarse_precisions)
+{
+    // An epsilon above 1 still reduces the argument instead of summing the series at its full length
+    const fraction epsilon(2, 1);
+    expect_within(fraction(1000000, 1).sin(epsilon),
+                  exact("-0.3499935021712929521176524867807714690614066053287162738570590546446412"),
+                  epsilon, "sin(1000000) to 2");
+    expect_within(fraction(1000000000, 1).cos(epsilon),
+                  exact("0.8378871813639023343897756435515723560595769480881178785846012511068203"),
+                  epsilon, "cos(1000000000) to 2");
+}
@@ -0,0 +1,42 @@
+#include "../fraction_test_helpers.h"
+
+TEST(positive_tests, functions_are_within_epsilon_of_reference_values)
+{
+    // Rounded to 70 decimals
+    expect_references({
+        {"sin", [](fraction const &x, fraction const &epsilon) { return x.sin(epsilon); },
+         "1/3", "0.3271946967961522441733440852676206060643014068937597915900562770705764"},
+        {"cos", [](fraction const &x, fraction const &epsilon) { return x.cos(epsilon); },
+         "1/3", "0.9449569463147376643882840076758806078458526995651407376776457337500996"},
+        {"tg", [](fraction const &x, fraction const &epsilon) { return x.tg(epsilon); },
+         "1/3", "0.3462535495105754910385435656097407745957039161898002179764440648985977"},
+        {"ctg", [](fraction const &x, fraction const &epsilon) { return x.ctg(epsilon); },
+         "1/3", "2.8880570362772768592053002743544131286203963556621545750206037181249105"},
+        {"sec", [](fraction const &x, fraction const &epsilon) { return x.sec(epsilon); },
+         "1/3", "1.0582492714614419014595217776406316365698927520907684601694505190302582"},
+        {"cosec", [](fraction const &x, fraction const &epsilon) { return x.cosec(epsilon); },
+         "1/3", "3.0562842545795193204625163549243292295897900073472112607446364573731579"},
+        {"arcsin", [](fraction const &x, fraction const &epsilon) { return x.arcsin(epsilon); },
+         "1/3", "0.3398369094541219370963925133917640663882446903324580714319239624899159"},
+        {"arccos", [](fraction const &x, fraction const &epsilon) { return x.arccos(epsilon); },
+         "1/3", "1.2309594173407746821349291782479873757103400093550948390555483336639923"},
+        {"arctg", [](fraction const &x, fraction const &epsilon) { return x.arctg(epsilon); },
+         "1/3", "0.3217505543966421934014046143586613190207552955576561914328030593567562"},
+        {"arcctg", [](fraction const &x, fraction const &epsilon) { return x.arcctg(epsilon); },
+         "1/3", "1.2490457723982544258299170772810901230778294041298967190546692367971520"},
+        {"arcsec", [](fraction const &x, fraction const &epsilon) { return x.arcsec(epsilon); },
+         "3/1", "1.2309594173407746821349291782479873757103400093550948390555483336639923"},
+        {"arccosec", [](fraction const &x, fraction const &epsilon) { return x.arccosec(epsilon); },
+         "3/1", "0.3398369094541219370963925133917640663882446903324580714319239624899159"},
+        {"ln", [](fraction const &x, fraction const &epsilon) { return x.ln(epsilon); },
+         "1/3", "-1.0986122886681096913952452369225257046474905578227494517346943336374943"},
+        {"log2", [](fraction const &x, fraction const &epsilon) { return x.log2(epsilon); },
+         "1/3", "-1.5849625007211561814537389439478165087598144076924810604557526545410982"},
+        {"lg", [](fraction const &x, fraction const &epsilon) { return x.lg(epsilon); },
+         "1/3", "-0.4771212547196624372950279032551153092001288641906958648298656403052292"},
+        {"root 2", [](fraction const &x, fraction const &epsilon) { return x.root(2, epsilon); },
+         "1/3", "0.5773502691896257645091487805019574556476017512701268760186023264839777"},
+        {"root 3", [](fraction const &x, fraction const &epsilon) { return x.root(3, epsilon); },
+         "1/3", "0.6933612743506347048433522747859617954459351134577540365658636934000354"},
+    }, {1, 6, 12, 40});
+}
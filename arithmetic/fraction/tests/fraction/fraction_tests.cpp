@@ -0,0 +1,25 @@
+#include <gtest/gtest.h>
+
+#include <fraction.h>
+#include <stdexcept>
+
+TEST(positive_tests, pow_is_exact)
+{
+    const fraction base(-2, 3);
+    EXPECT_TRUE(base.pow(0) == fraction(1, 1));
+    EXPECT_TRUE(base.pow(5) == fraction(-32, 243));
+    EXPECT_TRUE(base.pow(64) == fraction(1_bi << 64, big_int("3433683820292512484657849089281")));
+}
+
+TEST(negative_tests, undefined_values_throw)
+{
+    const fraction zero(0, 1);
+    EXPECT_THROW(fraction(1, 0), std::invalid_argument);
+    EXPECT_THROW(zero.ctg(), std::domain_error);
+    EXPECT_THROW(zero.cosec(), std::domain_error);
+    EXPECT_THROW(fraction(3, 2).arcsin(), std::domain_error);
+    EXPECT_THROW(fraction(1, 3).sin(zero), std::invalid_argument);
+
+    EXPECT_TRUE(zero.tg() == zero);
+    EXPECT_TRUE(zero.sec() == fraction(1, 1));
+}
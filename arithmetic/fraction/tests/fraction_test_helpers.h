@@ -0,0 +1,66 @@
+#ifndef MP_OS_FRACTION_TEST_HELPERS_H
+#define MP_OS_FRACTION_TEST_HELPERS_H
+
+#include <gtest/gtest.h>
+#include <fraction.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+/** The fraction a literal such as "-19.3267" or "1/3" stands for
+ */
+inline fraction exact(std::string const &text)
+{
+    if (const auto slash = text.find('/'); slash != std::string::npos)
+    {
+        return fraction(big_int(text.substr(0, slash)), big_int(text.substr(slash + 1)));
+    }
+
+    const bool negative = text[0] == '-';
+    std::string digits = text.substr(negative ? 1 : 0);
+    size_t scale = 0;
+    if (const auto point = digits.find('.'); point != std::string::npos)
+    {
+        scale = digits.size() - point - 1;
+        digits.erase(point, 1);
+    }
+    big_int numerator(digits);
+    return fraction(negative ? 0_bi - numerator : numerator, big_int("1" + std::string(scale, '0')));
+}
+
+inline fraction power_of_ten(size_t exponent)
+{
+    return fraction(1_bi, big_int("1" + std::string(exponent, '0')));
+}
+
+inline void expect_within(fraction const &value, fraction const &reference, fraction const &epsilon,
+                          std::string const &what)
+{
+    const fraction error = value - reference;
+    EXPECT_TRUE(error <= epsilon && -error <= epsilon) << what << ": " << value << " is off by " << error;
+}
+
+/** A function, its argument and its value rounded to far more decimals than the epsilons it is checked at
+ */
+struct reference_value
+{
+    std::string name;
+    std::function<fraction(fraction const &, fraction const &)> compute;
+    std::string argument;
+    std::string value;
+};
+
+inline void expect_references(std::vector<reference_value> const &references, std::vector<size_t> const &exponents)
+{
+    for (size_t exponent : exponents)
+    {
+        const fraction epsilon = power_of_ten(exponent);
+        for (auto const &[name, compute, argument, value] : references)
+        {
+            expect_within(compute(exact(argument), epsilon), exact(value), epsilon,
+                          name + "(" + argument + ") to 1e-" + std::to_string(exponent));
+        }
+    }
+}
+
+#endif //MP_OS_FRACTION_TEST_HELPERS_H
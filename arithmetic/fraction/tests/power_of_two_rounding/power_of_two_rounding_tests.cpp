@@ -0,0 +1,37 @@
+#include "../fraction_test_helpers.h"
+
+TEST(positive_tests, results_do_not_keep_long_denominators)
+{
+    // 2^ceil(40 log2 10) = 2^133
+    const fraction epsilon = power_of_ten(40);
+    const big_int bound = 1_bi << 133;
+
+    // A series sum whose exact denominator is longer than 2^k is rounded to a power of two denominator
+    const fraction x(1, 3);
+    for (fraction const &result : {x.sin(epsilon), x.cos(epsilon), x.tg(epsilon), x.sec(epsilon), x.arctg(epsilon),
+                                   x.ln(epsilon), x.root(2, epsilon), fraction::pi(epsilon), fraction::e(epsilon)})
+    {
+        const std::string text = result.to_string();
+        const big_int denominator(text.substr(text.find('/') + 1));
+
+        EXPECT_TRUE(denominator <= bound || (denominator & (denominator - 1_bi)) == 0_bi) << text;
+    }
+}
+
+TEST(positive_tests, divisors_far_below_epsilon_are_refined)
+{
+    const auto ctg = [](fraction const &x, fraction const &epsilon) { return x.ctg(epsilon); };
+    const auto cosec = [](fraction const &x, fraction const &epsilon) { return x.cosec(epsilon); };
+
+    // A sine rounded to epsilon would be zero
+    expect_references({
+        {"ctg", ctg, "1/12345678901234567",
+         "12345678901234566.9999999999999999729999997569999958419999448389991882071884545352322359"},
+        {"cosec", cosec, "1/12345678901234567",
+         "12345678901234567.0000000000000000135000001215000020790000275805004103250808923066120043"},
+        {"ctg", ctg, "-1/1000000000000",
+         "-999999999999.9999999999996666666666666666666666666444444444444444444444444423280423"},
+        {"cosec", cosec, "-1/1000000000000",
+         "-1000000000000.0000000000001666666666666666666666666861111111111111111111111131613757"},
+    }, {1, 6, 12, 40});
+}
@@ -0,0 +1,261 @@
+#include <client_logger.h>
+#include <client_logger_builder.h>
+#include <server_logger.h>
+#include <server_logger_builder.h>
+#define CPPHTTPLIB_NO_COMPRESSION
+#include <httplib.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+// usage: mp_os_lggr_benchmarks [messages per client_logger thread = 100000] [messages per server_logger thread = 2000]
+
+namespace
+{
+    /** Swallows everything: console scenarios measure formatting and stream locking, not the terminal
+     */
+    class null_buffer final : public std::streambuf
+    {
+    protected:
+
+        int_type overflow(int_type c) override
+        {
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char*, std::streamsize n) override
+        {
+            return n;
+        }
+    };
+
+    struct result
+    {
+        double messages_per_second;
+        double p50;
+        double p99;
+        double p999;
+    };
+
+    result run(logger& prototype, size_t threads_count, size_t messages, const std::string& message)
+    {
+        std::vector<std::vector<double>> latencies(threads_count);
+        std::vector<std::thread> threads;
+        threads.reserve(threads_count);
+
+        auto started = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < threads_count; ++i)
+        {
+            threads.emplace_back([&, i] {
+                auto& own = latencies[i];
+                own.reserve(messages);
+
+                for (size_t j = 0; j < messages; ++j)
+                {
+                    auto begin = std::chrono::steady_clock::now();
+                    prototype.information(message);
+                    auto end = std::chrono::steady_clock::now();
+                    own.push_back(std::chrono::duration<double, std::nano>(end - begin).count());
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        std::vector<double> all;
+        all.reserve(threads_count * messages);
+        for (auto& own : latencies)
+        {
+            all.insert(all.end(), own.begin(), own.end());
+        }
+        std::sort(all.begin(), all.end());
+
+        auto percentile = [&all](double p) {
+            return all.empty() ? 0.0 : all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))];
+        };
+
+        return {all.size() / elapsed, percentile(0.5), percentile(0.99), percentile(0.999)};
+    }
+
+    void print_header()
+    {
+        std::cout << std::left
+                  << std::setw(16) << "logger"
+                  << std::setw(10) << "sink"
+                  << std::setw(26) << "format"
+                  << std::setw(9) << "threads"
+                  << std::right
+                  << std::setw(14) << "msgs/s"
+                  << std::setw(12) << "p50, ns"
+                  << std::setw(12) << "p99, ns"
+                  << std::setw(12) << "p99.9, ns" << std::endl;
+    }
+
+    void print_row(const std::string& name, const std::string& sink, const std::string& format, size_t threads, const result& r)
+    {
+        std::cout << std::left
+                  << std::setw(16) << name
+                  << std::setw(10) << sink
+                  << std::setw(26) << format
+                  << std::setw(9) << threads
+                  << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(14) << r.messages_per_second
+                  << std::setw(12) << r.p50
+                  << std::setw(12) << r.p99
+                  << std::setw(12) << r.p999 << std::endl;
+    }
+
+#ifdef _WIN32
+    constexpr const char* null_device = "NUL";
+#else
+    constexpr const char* null_device = "/dev/null";
+#endif
+
+    void client_logger_benchmarks(size_t messages)
+    {
+        const std::vector<std::string> formats = {"%m", "[%s] %m", "[%d %t][%s] %m", "%d %t %d %t [%s] %m %m"};
+        const std::vector<std::string> sinks = {"disabled", "null", "file", "console"};
+        const std::string message = "benchmark message of a typical length, with some numbers 1234567890";
+
+        null_buffer discard;
+
+        for (const auto& sink : sinks)
+        {
+            for (const auto& format : formats)
+            {
+                for (size_t threads : {1, 4, 16})
+                {
+                    client_logger_builder builder;
+                    builder.set_format(format);
+
+                    if (sink == "null")
+                    {
+                        builder.add_file_stream(null_device, logger::severity::information);
+                    }
+                    else if (sink == "file")
+                    {
+                        builder.add_file_stream("mp_os_lggr_benchmarks.log", logger::severity::information);
+                    }
+                    else if (sink == "console")
+                    {
+                        builder.add_console_stream(logger::severity::information);
+                    }
+                    else
+                    {
+                        // Only an unrelated severity listens: measures the disabled check
+                        builder.add_console_stream(logger::severity::critical);
+                    }
+
+                    std::unique_ptr<logger> built(builder.build());
+
+                    auto* previous = sink == "console" ? std::cout.rdbuf(&discard) : nullptr;
+                    auto r = run(*built, threads, messages, message);
+                    if (previous != nullptr)
+                    {
+                        std::cout.rdbuf(previous);
+                    }
+
+                    print_row("client_logger", sink, "\"" + format + "\"", threads, r);
+                }
+            }
+        }
+
+        std::remove("mp_os_lggr_benchmarks.log");
+    }
+
+    void server_logger_benchmarks(size_t messages)
+    {
+        constexpr int port = 9311;
+
+        httplib::Server stand_in;
+        stand_in.Post("/log", [](const httplib::Request&, httplib::Response& res) { res.status = 200; });
+
+        std::thread server_thread([&stand_in] { stand_in.listen("127.0.0.1", port); });
+        stand_in.wait_until_ready();
+
+        const std::string message = "benchmark message of a typical length, with some numbers 1234567890";
+
+        for (size_t threads : {1, 4, 16})
+        {
+            server_logger_builder builder;
+            builder.set_destination("http://127.0.0.1:" + std::to_string(port));
+            builder.set_format("%d %t %s %m");
+            builder.add_file_stream("mp_os_lggr_benchmarks_server.log", logger::severity::information);
+
+            std::unique_ptr<logger> built(builder.build());
+
+            // server_logger owns a single HTTP connection, so every thread gets its own copy
+            std::vector<std::unique_ptr<logger>> copies;
+            for (size_t i = 0; i < threads; ++i)
+            {
+                copies.emplace_back(new server_logger(*static_cast<server_logger*>(built.get())));
+            }
+
+            std::vector<std::vector<double>> latencies(threads);
+            std::vector<std::thread> workers;
+            auto started = std::chrono::steady_clock::now();
+
+            for (size_t i = 0; i < threads; ++i)
+            {
+                workers.emplace_back([&, i] {
+                    for (size_t j = 0; j < messages; ++j)
+                    {
+                        auto begin = std::chrono::steady_clock::now();
+                        copies[i]->information(message);
+                        auto end = std::chrono::steady_clock::now();
+                        latencies[i].push_back(std::chrono::duration<double, std::nano>(end - begin).count());
+                    }
+                });
+            }
+
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+            std::vector<double> all;
+            for (auto& own : latencies)
+            {
+                all.insert(all.end(), own.begin(), own.end());
+            }
+            std::sort(all.begin(), all.end());
+
+            auto percentile = [&all](double p) {
+                return all.empty() ? 0.0 : all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))];
+            };
+
+            print_row("server_logger", "http", "\"%d %t %s %m\"", threads,
+                      {all.size() / elapsed, percentile(0.5), percentile(0.99), percentile(0.999)});
+        }
+
+        stand_in.stop();
+        server_thread.join();
+
+        std::remove("mp_os_lggr_benchmarks_server.log");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t client_messages = argc > 1 ? std::stoul(argv[1]) : 100000;
+    const size_t server_messages = argc > 2 ? std::stoul(argv[2]) : 2000;
+
+    print_header();
+    client_logger_benchmarks(client_messages);
+    server_logger_benchmarks(server_messages);
+}
@@ -7,38 +7,146 @@
 #include <forward_list>
 #include <fstream>
 #include <ctime>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <cstdint>
 
 class client_logger_builder;
 
 class client_logger final:
     public logger
 {
+public:
+
+    /** Log file rotation settings. A file shared by several loggers keeps the policy it was first opened with.
+     *  Rotated files are renamed to "<path>.<UTC timestamp>-<sequence>" and compressed in the background.
+     */
+    struct rotation_policy
+    {
+        enum class compression
+        { none, gzip, zstd };
+
+        size_t max_size = 0; // bytes, 0 - no size limit
+        bool daily = false;
+        size_t keep = 0; // rotated files to keep, 0 - keep all
+        compression compress = compression::none;
+
+        [[nodiscard]] bool enabled() const noexcept
+        {
+            return max_size != 0 || daily;
+        }
+    };
+
+    static constexpr size_t default_segment_size = 16 * 1024 * 1024;
+
 private:
-    
 
+    /** One preallocated, mmap'ed piece of a memory-mapped log file. Writers reserve space with a fetch_add on offset;
+     *  the first reservation that does not fit seals the segment and the file is rolled over to a new one.
+     */
+    struct mapped_segment
+    {
+        char* data = nullptr;
+        size_t size = 0;
+        int fd = -1;
+
+        std::atomic<size_t> offset = 0;
+        std::atomic<size_t> sealed = SIZE_MAX;
+        std::atomic<size_t> writers = 0;
+
+        /** Creates the file at path, truncating it, and maps at least min_size preallocated bytes of it
+         */
+        void map(const std::string& path, size_t min_size);
+
+        /** Waits for writers still copying in, unmaps and cuts the file down to the written part
+         */
+        void unmap() noexcept;
+    };
+
+    struct stream_entry
+    {
+        const std::string path;
+        const size_t id;
+
+        std::mutex mut;
+        int fd = -1;
+        rotation_policy rotation;
+        size_t written = 0;
+        long long day = 0;
+        size_t rotations = 0;
+
+        // Records wait in the buffer until it fills up, an error or critical record arrives or the crash flush runs;
+        // write-through files flush it after every record. The buffer is never reallocated, buffered is published
+        // after the copy, so the signal handler can read both.
+        std::unique_ptr<char[]> buffer;
+        size_t buffer_size = 0;
+        bool write_through = true;
+        std::atomic<size_t> buffered = 0;
+
+        // memory-mapped files only: segment_size != 0, stream stays closed
+        size_t segment_size = 0;
+        std::atomic<mapped_segment*> segment = nullptr;
+        std::forward_list<std::unique_ptr<mapped_segment>> segments;
+
+        stream_entry(std::string entry_path, size_t entry_id) : path(std::move(entry_path)), id(entry_id) {}
+
+        ~stream_entry();
+    };
+
+    /** Interned handle to a shared log file. Copies, assignments and destruction only touch an atomic refcount;
+     *  the path registry is consulted once, when a handle is created from a path.
+     *  Writes to the same file from different loggers are serialised by the per-file mutex.
+     */
     class refcounted_stream final
     {
-        static std::unordered_map<std::string, std::pair<size_t, std::ofstream>> _global_streams;
+        static std::unordered_map<std::string, std::weak_ptr<stream_entry>> _registry;
 
-        std::pair<std::string, std::ofstream*> _stream;
+        std::shared_ptr<stream_entry> _entry;
         friend client_logger;
         friend client_logger_builder;
+
+        static std::shared_ptr<stream_entry> intern(const std::string& path, const rotation_policy& rotation,
+                                                    size_t segment_size, size_t buffer_size);
+
+        static void rotate(stream_entry& entry);
+
+        static void flush_buffer(stream_entry& entry) noexcept;
+
+        static void write_mapped(stream_entry& entry, const std::string& line);
+
+        /** False if the full segment could not be renamed away, which leaves it in place and sealed
+         */
+        static bool roll_over(stream_entry& entry, mapped_segment* full, size_t length);
+
     public:
 
         explicit refcounted_stream(const std::string& path);
 
-        refcounted_stream(const refcounted_stream& oth);
+        refcounted_stream(const std::string& path, rotation_policy rotation);
+
+        /** segment_size != 0 opens the file memory-mapped; only keep and compress of the rotation policy apply to it.
+         *  buffer_size != 0 buffers records of an ordinary file instead of writing each one through.
+         */
+        refcounted_stream(const std::string& path, rotation_policy rotation, size_t segment_size, size_t buffer_size = 0);
+
+        refcounted_stream(const refcounted_stream& oth) = default;
 
-        refcounted_stream& operator=(const refcounted_stream& oth);
+        refcounted_stream& operator=(const refcounted_stream& oth) = default;
 
-        refcounted_stream(refcounted_stream&& oth) noexcept;
+        refcounted_stream(refcounted_stream&& oth) noexcept = default;
 
-        refcounted_stream& operator=(refcounted_stream&& oth) noexcept;
+        refcounted_stream& operator=(refcounted_stream&& oth) noexcept = default;
 
-       
-        void open();
+        [[nodiscard]] const std::string& path() const noexcept;
 
-        ~refcounted_stream();
+        [[nodiscard]] size_t id() const noexcept;
+
+        /** urgent records flush the file buffer right away
+         */
+        void write(const std::string& line, bool urgent = false);
+
+        ~refcounted_stream() = default;
     };
 
     
@@ -52,16 +160,41 @@ private:
 
     std::string _format;
 
+    /** One JSON object per record instead of _format: time, severity, message and the fields
+     */
+    bool _json_lines = false;
+
+    /** Buffered and memory-mapped files the crash flush has to take care of
+     */
+    static std::array<std::atomic<stream_entry*>, 64> _crash_slots;
+
+    static void register_for_crash_flush(stream_entry* entry) noexcept;
+
+    static void unregister_from_crash_flush(stream_entry* entry) noexcept;
+
+    /** Signal handler: drains buffers with raw write(), trims mapped segments, then re-raises to the previous handler.
+     *  Only async-signal-safe calls; a record being appended concurrently may be cut or duplicated.
+     */
+    static void crash_flush(int signal) noexcept;
+
+    /** Installs crash_flush for SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT; idempotent
+     */
+    static void enable_crash_flush();
 
 private:
 
     
-    client_logger(const std::unordered_map<logger::severity ,std::pair<std::forward_list<refcounted_stream>, bool>>& streams, std::string format);
+    client_logger(const std::unordered_map<logger::severity ,std::pair<std::forward_list<refcounted_stream>, bool>>& streams, std::string format,
+                  bool json_lines = false);
 
     std::string make_format(const std::string& message, severity sev) const;
 
+    static void make_json_line(std::string& line, const std::string& message, severity sev, std::span<const log_field> fields);
+
     static flag char_to_flag(char c) noexcept;
 
+    void update_enabled_severities() noexcept;
+
     friend client_logger_builder;
 public:
 
@@ -77,10 +210,17 @@ public:
 
 public:
 
+    using logger::log;
+
     [[nodiscard]] logger& log(
         const std::string &message,
         logger::severity severity) & override;
 
+    [[nodiscard]] logger& log(
+        const std::string &message,
+        logger::severity severity,
+        std::span<const log_field> fields) & override;
+
 };
 
 #endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_CLIENT_LOGGER_H
\ No newline at end of file
@@ -16,8 +16,14 @@ private:
 
     std::string _format;
 
+    size_t _file_buffer_size = 0;
+
+    bool _json_lines = false;
+
     void parse_severity(logger::severity, nlohmann::json& j);
 
+    static client_logger::rotation_policy parse_rotation(const nlohmann::json& j);
+
 public:
 
     client_logger_builder() : _format("%m"){};
@@ -42,9 +48,39 @@ public:
         std::string const &stream_file_path,
         logger::severity severity) & override;
 
+    logger_builder& add_file_stream(
+        std::string const &stream_file_path,
+        logger::severity severity,
+        client_logger::rotation_policy rotation) &;
+
+    /** Appends through a memory-mapped, preallocated segment of the file; a full segment is rotated like a file
+     *  that reached rotation.max_size, so only keep and compression of the policy are used.
+     *  Not available on Windows, where an ordinary file stream is added instead.
+     */
+    logger_builder& add_mapped_stream(
+        std::string const &stream_file_path,
+        logger::severity severity,
+        size_t segment_size = client_logger::default_segment_size,
+        client_logger::rotation_policy rotation = client_logger::rotation_policy()) &;
+
     logger_builder& add_console_stream(
         logger::severity severity) & override;
 
+    /** File streams added afterwards keep up to bytes of records in memory (0 - write every record through);
+     *  error and critical records are flushed immediately. Pair it with enable_crash_flush.
+     */
+    client_logger_builder& set_file_buffer_size(
+        size_t bytes) &;
+
+    /** Writes every record as one JSON object (time, severity, message, fields) instead of the format string
+     */
+    client_logger_builder& set_json_lines(
+        bool enabled) &;
+
+    /** Installs a fatal signal handler that drains buffered records of every client_logger with raw write()
+     */
+    client_logger_builder& enable_crash_flush() &;
+
     logger_builder& transform_with_configuration(
         std::string const &configuration_file_path,
         std::string const &configuration_path) & override;
@@ -3,40 +3,449 @@
 #include <algorithm>
 #include <utility>
 #include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
 #include "../include/client_logger.h"
+#include <json_writer.h>
 #include <not_implemented.h>
 
+#ifdef MP_OS_LGGR_WITH_ZLIB
+#include <zlib.h>
+#endif
 
-static std::mutex global_streams_mutex;
+#ifdef MP_OS_LGGR_WITH_ZSTD
+#include <zstd.h>
+#endif
 
-std::unordered_map<std::string, std::pair<size_t, std::ofstream>> client_logger::refcounted_stream::_global_streams;
+#include <csignal>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#endif
+
+
+static std::mutex registry_mutex;
+
+std::unordered_map<std::string, std::weak_ptr<client_logger::stream_entry>> client_logger::refcounted_stream::_registry;
+
+std::array<std::atomic<client_logger::stream_entry*>, 64> client_logger::_crash_slots{};
+
+namespace
+{
+    long long current_day() noexcept
+    {
+        return static_cast<long long>(std::time(nullptr)) / (24 * 60 * 60);
+    }
+
+    std::string rotation_timestamp()
+    {
+        std::time_t now = std::time(nullptr);
+        std::tm tm_buf{};
+
+        #ifdef _WIN32
+        gmtime_s(&tm_buf, &now);
+        #else
+        gmtime_r(&now, &tm_buf);
+        #endif
+
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y%m%d-%H%M%S", &tm_buf);
+        return buffer;
+    }
+
+    /** Truncates, like the std::ofstream it replaced, unless append is set
+     */
+    int open_log_file(const std::string& path, bool append = false)
+    {
+        #ifdef _WIN32
+        int fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | (append ? _O_APPEND : _O_TRUNC) | _O_BINARY,
+                       _S_IREAD | _S_IWRITE);
+        #else
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC) | O_CLOEXEC, 0644);
+        #endif
+        if (fd == -1)
+        {
+            throw std::runtime_error("Failed to open log file: " + path + ": " + std::strerror(errno));
+        }
+        return fd;
+    }
+
+    void close_log_file(int fd) noexcept
+    {
+        #ifdef _WIN32
+        _close(fd);
+        #else
+        ::close(fd);
+        #endif
+    }
+
+    /** Async-signal-safe
+     */
+    bool write_fully(int fd, const char* data, size_t size) noexcept
+    {
+        while (size != 0)
+        {
+            #ifdef _WIN32
+            auto written = _write(fd, data, static_cast<unsigned int>(size));
+            #else
+            auto written = ::write(fd, data, size);
+            #endif
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    constexpr int crash_signals[] = {
+        SIGSEGV, SIGFPE, SIGILL, SIGABRT,
+        #ifndef _WIN32
+        SIGBUS
+        #endif
+    };
+
+    #ifndef _WIN32
+    struct sigaction previous_actions[std::size(crash_signals)];
+    #endif
+
+    std::string rotated_name(const std::string& path, size_t rotation)
+    {
+        char sequence[16];
+        std::snprintf(sequence, sizeof(sequence), "-%06zu", rotation % 1000000);
+        return path + "." + rotation_timestamp() + sequence;
+    }
+
+    /** The timestamp and sequence number of a name rotated_name gave for base, followed by nothing, ".gz" or
+     *  ".zst"; nothing for any other name
+     */
+    std::optional<std::pair<std::string, size_t>> parse_rotated_name(const std::string& name, const std::string& base)
+    {
+        // base.YYYYMMDD-HHMMSS-NNNNNN
+        constexpr size_t timestamp_size = 15;
+        constexpr size_t sequence_size = 6;
+
+        if (!name.starts_with(base + "."))
+        {
+            return std::nullopt;
+        }
+        const std::string_view rest = std::string_view(name).substr(base.size() + 1);
+        if (rest.size() < timestamp_size + 1 + sequence_size)
+        {
+            return std::nullopt;
+        }
+
+        const auto suffix = rest.substr(timestamp_size + 1 + sequence_size);
+        if (!suffix.empty() && suffix != ".gz" && suffix != ".zst")
+        {
+            return std::nullopt;
+        }
+
+        const auto digits = [](std::string_view part) {
+            return std::all_of(part.begin(), part.end(), [](char c) { return c >= '0' && c <= '9'; });
+        };
+        const auto timestamp = rest.substr(0, timestamp_size);
+        if (!digits(timestamp.substr(0, 8)) || timestamp[8] != '-' || !digits(timestamp.substr(9)) ||
+            rest[timestamp_size] != '-' || !digits(rest.substr(timestamp_size + 1, sequence_size)))
+        {
+            return std::nullopt;
+        }
+
+        return std::pair(std::string(timestamp), std::stoul(std::string(rest.substr(timestamp_size + 1, sequence_size))));
+    }
+
+#ifdef MP_OS_LGGR_WITH_ZLIB
+    bool gzip_file(const std::filesystem::path& from, const std::filesystem::path& to)
+    {
+        std::ifstream in(from, std::ios::binary);
+        gzFile out = gzopen(to.string().c_str(), "wb");
+        if (!in.is_open() || out == nullptr)
+        {
+            if (out != nullptr) gzclose(out);
+            return false;
+        }
+
+        std::vector<char> buffer(1 << 16);
+        bool ok = true;
+        while (ok && (in.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || in.gcount() > 0))
+        {
+            ok = gzwrite(out, buffer.data(), static_cast<unsigned int>(in.gcount())) == in.gcount();
+        }
+
+        return gzclose(out) == Z_OK && ok;
+    }
+#endif
+
+#ifdef MP_OS_LGGR_WITH_ZSTD
+    bool zstd_file(const std::filesystem::path& from, const std::filesystem::path& to)
+    {
+        std::ifstream in(from, std::ios::binary);
+        std::ofstream out(to, std::ios::binary);
+        if (!in.is_open() || !out.is_open())
+        {
+            return false;
+        }
+
+        std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> ctx(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+        std::vector<char> in_buffer(ZSTD_CStreamInSize());
+        std::vector<char> out_buffer(ZSTD_CStreamOutSize());
+
+        bool last = false;
+        while (!last)
+        {
+            in.read(in_buffer.data(), static_cast<std::streamsize>(in_buffer.size()));
+            last = in.gcount() < static_cast<std::streamsize>(in_buffer.size());
+
+            ZSTD_inBuffer input{in_buffer.data(), static_cast<size_t>(in.gcount()), 0};
+            bool finished = false;
+            while (!finished)
+            {
+                ZSTD_outBuffer output{out_buffer.data(), out_buffer.size(), 0};
+                size_t remaining = ZSTD_compressStream2(ctx.get(), &output, &input, last ? ZSTD_e_end : ZSTD_e_continue);
+                if (ZSTD_isError(remaining))
+                {
+                    return false;
+                }
+                out.write(out_buffer.data(), static_cast<std::streamsize>(output.pos));
+                finished = last ? remaining == 0 : input.pos == input.size;
+            }
+        }
+
+        return out.good();
+    }
+#endif
+
+    /** Compresses rotated files and prunes old ones off the logging threads
+     */
+    class rotation_worker final
+    {
+        struct job
+        {
+            std::filesystem::path rotated;
+            std::filesystem::path base;
+            client_logger::rotation_policy policy;
+        };
+
+        std::mutex _mut;
+        std::condition_variable _cv;
+        std::deque<job> _jobs;
+        bool _stopped = false;
+
+        std::thread _worker;
+
+        rotation_worker() : _worker(&rotation_worker::work, this) {}
+
+        void work()
+        {
+            while (true)
+            {
+                job current;
+                {
+                    std::unique_lock lock(_mut);
+                    _cv.wait(lock, [this] { return _stopped || !_jobs.empty(); });
+
+                    if (_jobs.empty())
+                    {
+                        return;
+                    }
+
+                    current = std::move(_jobs.front());
+                    _jobs.pop_front();
+                }
+
+                try
+                {
+                    compress(current);
+                    prune(current);
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "Error processing rotated log file " << current.rotated << ": " << e.what() << std::endl;
+                }
+            }
+        }
+
+        static void compress(const job& current)
+        {
+            using compression = client_logger::rotation_policy::compression;
+
+            std::filesystem::path target;
+            bool ok = false;
+
+            switch (current.policy.compress)
+            {
+            case compression::none:
+                return;
+            case compression::gzip:
+                target = current.rotated.string() + ".gz";
+                #ifdef MP_OS_LGGR_WITH_ZLIB
+                ok = gzip_file(current.rotated, target);
+                #else
+                std::cerr << "Warning: gzip support is not compiled in, keeping " << current.rotated << " uncompressed" << std::endl;
+                return;
+                #endif
+                break;
+            case compression::zstd:
+                target = current.rotated.string() + ".zst";
+                #ifdef MP_OS_LGGR_WITH_ZSTD
+                ok = zstd_file(current.rotated, target);
+                #else
+                std::cerr << "Warning: zstd support is not compiled in, keeping " << current.rotated << " uncompressed" << std::endl;
+                return;
+                #endif
+                break;
+            }
+
+            std::error_code ec;
+            if (ok)
+            {
+                std::filesystem::remove(current.rotated, ec);
+            }
+            else
+            {
+                std::cerr << "Error compressing rotated log file: " << current.rotated << std::endl;
+                std::filesystem::remove(target, ec);
+            }
+        }
+
+        static void prune(const job& current)
+        {
+            if (current.policy.keep == 0)
+            {
+                return;
+            }
+
+            auto directory = current.base.parent_path();
+            if (directory.empty())
+            {
+                directory = ".";
+            }
+
+            const auto base = current.base.filename().string();
+
+            // Ordered by timestamp, then by sequence number within the second
+            std::vector<std::pair<std::pair<std::string, size_t>, std::filesystem::path>> rotated;
+            for (const auto& file : std::filesystem::directory_iterator(directory))
+            {
+                if (!file.is_regular_file())
+                {
+                    continue;
+                }
+                if (auto key = parse_rotated_name(file.path().filename().string(), base))
+                {
+                    rotated.emplace_back(std::move(*key), file.path());
+                }
+            }
+
+            if (rotated.size() <= current.policy.keep)
+            {
+                return;
+            }
+
+            std::sort(rotated.begin(), rotated.end());
+
+            std::error_code ec;
+            for (size_t i = 0; i < rotated.size() - current.policy.keep; ++i)
+            {
+                std::filesystem::remove(rotated[i].second, ec);
+            }
+        }
+
+    public:
+
+        static rotation_worker& instance()
+        {
+            static rotation_worker worker;
+            return worker;
+        }
+
+        void push(std::filesystem::path rotated, std::filesystem::path base, const client_logger::rotation_policy& policy)
+        {
+            {
+                std::lock_guard lock(_mut);
+                _jobs.push_back({std::move(rotated), std::move(base), policy});
+            }
+            _cv.notify_one();
+        }
+
+        ~rotation_worker()
+        {
+            {
+                std::lock_guard lock(_mut);
+                _stopped = true;
+            }
+            _cv.notify_one();
+            _worker.join();
+        }
+    };
+}
 
 
 logger& client_logger::log(
     const std::string &text,
     logger::severity severity) &
 {
+    return log(text, severity, std::span<const log_field>());
+}
+
+logger& client_logger::log(
+    const std::string &text,
+    logger::severity severity,
+    std::span<const log_field> fields) &
+{
+    if (!is_enabled(severity)) return *this;
+
     try {
 
         auto it = _output_streams.find(severity);
         if (it == _output_streams.end()) return *this;
 
 
-        std::string formatted = make_format(text, severity);
+        // JSON lines go into a per-thread buffer that keeps its capacity, so encoding does not allocate
+        thread_local std::string json_line;
+        std::string text_line;
+        if (_json_lines)
+        {
+            json_line.clear();
+            make_json_line(json_line, text, severity, fields);
+        }
+        else
+        {
+            text_line = make_format(text, severity);
+            append_fields(text_line, fields);
+        }
+        const std::string &formatted = _json_lines ? json_line : text_line;
 
 
         for (auto &stream : it->second.first)
         {
 
-            if (!stream._stream.first.empty() && stream._stream.second)
+            if (stream._entry)
             {
                 try {
-                    *stream._stream.second << formatted << std::endl;
-                    if (!stream._stream.second->good()) {
-                        std::cerr << "Error writing to log file: " << stream._stream.first << std::endl;
-                    }
+                    stream.write(formatted, severity >= logger::severity::error);
                 } catch (const std::exception& e) {
-                    std::cerr << "Exception writing to log file: " << stream._stream.first << ": " << e.what() << std::endl;
+                    std::cerr << "Exception writing to log file: " << stream.path() << ": " << e.what() << std::endl;
                 }
             }
         }
@@ -57,6 +466,34 @@ logger& client_logger::log(
     return *this;
 }
 
+void client_logger::make_json_line(std::string &line, const std::string &message, severity sev, std::span<const log_field> fields)
+{
+    std::time_t now = std::time(nullptr);
+    std::tm tm_buf{};
+
+    #ifdef _WIN32
+    gmtime_s(&tm_buf, &now);
+    #else
+    gmtime_r(&now, &tm_buf);
+    #endif
+
+    char timestamp[32];
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &tm_buf);
+
+    json_writer writer(line);
+    writer.begin_object()
+          .key("time").value(timestamp)
+          .key("severity").value(severity_to_string(sev))
+          .key("message").value(message);
+
+    for (const auto &field : fields)
+    {
+        writer.field(field);
+    }
+
+    writer.end_object();
+}
+
 std::string client_logger::make_format(const std::string &message, severity sev) const
 {
     try {
@@ -70,7 +507,7 @@ std::string client_logger::make_format(const std::string &message, severity sev)
         gmtime_s(&tm_buf, &now);
         tm = &tm_buf;
         #else
-        tm = std::gmtime(&now);
+        tm = gmtime_r(&now, &tm_buf);
         if (!tm) {
             throw std::runtime_error("Failed to convert time to GMT");
         }
@@ -117,215 +554,492 @@ std::string client_logger::make_format(const std::string &message, severity sev)
     }
 }
 
-void client_logger::refcounted_stream::open()
+std::shared_ptr<client_logger::stream_entry> client_logger::refcounted_stream::intern(
+    const std::string &path,
+    const rotation_policy &rotation,
+    size_t segment_size,
+    size_t buffer_size)
 {
-    
-    if (_stream.first.empty()) {
-        _stream.second = nullptr;
-        return;
-    }
+    std::lock_guard<std::mutex> lock(registry_mutex);
 
-    std::lock_guard<std::mutex> lock(global_streams_mutex);
-    
-    auto it = _global_streams.find(_stream.first);
-    if (it == _global_streams.end())
+    if (auto it = _registry.find(path); it != _registry.end())
     {
-        _global_streams[_stream.first] = std::make_pair(1, std::ofstream(_stream.first));
-        if (!_global_streams[_stream.first].second.is_open())
+        if (auto entry = it->second.lock())
         {
-            throw std::runtime_error("Failed to open log file: " + _stream.first);
+            if ((entry->segment_size == 0) != (segment_size == 0))
+            {
+                throw std::runtime_error("Log file is already open in a different mode: " + path);
+            }
+            return entry;
         }
-        _stream.second = &_global_streams[_stream.first].second;
+    }
+
+    std::erase_if(_registry, [](const auto &item) { return item.second.expired(); });
+
+    auto entry = std::make_shared<stream_entry>(path, std::hash<std::string>()(path));
+    if (segment_size != 0)
+    {
+        auto segment = std::make_unique<mapped_segment>();
+        segment->map(path, segment_size);
+        entry->segment_size = segment_size;
+        entry->segment = segment.get();
+        entry->segments.push_front(std::move(segment));
     }
     else
     {
-        ++it->second.first;
-        _stream.second = &it->second.second;
+        entry->fd = open_log_file(path);
+        entry->write_through = buffer_size == 0;
+        entry->buffer_size = buffer_size == 0 ? 4096 : buffer_size;
+        entry->buffer = std::make_unique<char[]>(entry->buffer_size);
+    }
+    entry->rotation = rotation;
+    entry->day = current_day();
+
+    if (segment_size != 0 || buffer_size != 0)
+    {
+        register_for_crash_flush(entry.get());
     }
+
+    _registry[path] = entry;
+    return entry;
 }
 
-client_logger::client_logger(
-    const std::unordered_map<logger::severity, std::pair<std::forward_list<refcounted_stream>, bool>> &streams,
-    std::string format) :
-    _output_streams(streams),
-    _format(std::move(format))
+const std::string &client_logger::refcounted_stream::path() const noexcept
 {
-    for (auto &[sev, streams_pair] : _output_streams)
+    static const std::string empty;
+    return _entry ? _entry->path : empty;
+}
+
+size_t client_logger::refcounted_stream::id() const noexcept
+{
+    return _entry ? _entry->id : 0;
+}
+
+void client_logger::refcounted_stream::write(const std::string &line, bool urgent)
+{
+    auto &entry = *_entry;
+    if (entry.segment_size != 0)
     {
-        for (auto &stream : streams_pair.first)
+        write_mapped(entry, line);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(entry.mut);
+
+    const auto &rotation = entry.rotation;
+    if (rotation.enabled() &&
+        ((rotation.max_size != 0 && entry.written != 0 && entry.written + line.size() + 1 > rotation.max_size) ||
+         (rotation.daily && current_day() != entry.day)))
+    {
+        rotate(entry);
+    }
+
+    const size_t length = line.size() + 1;
+    size_t used = entry.buffered.load(std::memory_order_relaxed);
+
+    if (used + length > entry.buffer_size)
+    {
+        flush_buffer(entry);
+        used = 0;
+    }
+
+    if (length > entry.buffer_size)
+    {
+        if (!write_fully(entry.fd, line.data(), line.size()) || !write_fully(entry.fd, "\n", 1))
         {
-            stream.open();
+            std::cerr << "Error writing to log file: " << entry.path << std::endl;
         }
     }
+    else
+    {
+        std::memcpy(entry.buffer.get() + used, line.data(), line.size());
+        entry.buffer[used + line.size()] = '\n';
+        entry.buffered.store(used + length, std::memory_order_release);
+    }
+
+    entry.written += length;
+
+    if (entry.write_through || urgent)
+    {
+        flush_buffer(entry);
+    }
 }
 
-client_logger::flag client_logger::char_to_flag(char c) noexcept
+void client_logger::refcounted_stream::flush_buffer(stream_entry &entry) noexcept
 {
-    switch (c)
+    const size_t used = entry.buffered.load(std::memory_order_relaxed);
+    if (used == 0)
     {
-    case 'd': return flag::DATE;
-    case 't': return flag::TIME;
-    case 's': return flag::SEVERITY;
-    case 'm': return flag::MESSAGE;
-    default:  return flag::NO_FLAG;
+        return;
+    }
+
+    // Reset only after the write: if the crash flush interrupts us, a record is duplicated rather than lost
+    bool ok = write_fully(entry.fd, entry.buffer.get(), used);
+    entry.buffered.store(0, std::memory_order_release);
+
+    if (!ok)
+    {
+        std::cerr << "Error writing to log file: " << entry.path << std::endl;
     }
 }
 
-client_logger::client_logger(const client_logger &other) : _output_streams(other._output_streams), _format(other._format)
+void client_logger::refcounted_stream::rotate(stream_entry &entry)
 {
-    
-    for (auto &[sev, streams_pair] : _output_streams)
+    // Only the rename happens on the logging thread, compression and pruning are left to the rotation worker
+    std::string rotated = rotated_name(entry.path, entry.rotations + 1);
+
+    flush_buffer(entry);
+    close_log_file(entry.fd);
+    entry.fd = -1;
+
+    // A file that could not be renamed still holds its records: go on appending to it and retry on the next write
+    std::error_code ec;
+    std::filesystem::rename(entry.path, rotated, ec);
+    if (ec)
+    {
+        std::cerr << "Error rotating log file " << entry.path << ": " << ec.message() << std::endl;
+        entry.fd = open_log_file(entry.path, true);
+        return;
+    }
+
+    entry.fd = open_log_file(entry.path);
+    ++entry.rotations;
+    entry.written = 0;
+    entry.day = current_day();
+
+    rotation_worker::instance().push(rotated, entry.path, entry.rotation);
+}
+
+void client_logger::refcounted_stream::write_mapped(stream_entry &entry, const std::string &line)
+{
+    const size_t length = line.size() + 1;
+
+    while (true)
     {
-        for (auto &stream : streams_pair.first)
+        auto *segment = entry.segment.load();
+
+        // Registering as a writer and re-checking the current segment pairs with roll_over storing the next segment
+        // and then waiting for writers: either the roll-over sees this writer, or this writer sees the new segment
+        segment->writers.fetch_add(1);
+        if (entry.segment.load() != segment)
+        {
+            segment->writers.fetch_sub(1);
+            continue;
+        }
+
+        const size_t offset = segment->offset.fetch_add(length);
+        if (offset + length <= segment->size)
+        {
+            std::memcpy(segment->data + offset, line.data(), line.size());
+            segment->data[offset + line.size()] = '\n';
+            segment->writers.fetch_sub(1);
+            return;
+        }
+
+        // Everything from the lowest failed reservation on is garbage and gets truncated away
+        size_t sealed = segment->sealed.load();
+        while (offset < sealed && !segment->sealed.compare_exchange_weak(sealed, offset))
         {
-    
-            if (!stream._stream.first.empty()) {
-                stream.open();
-            }
+        }
+        segment->writers.fetch_sub(1);
+
+        if (!roll_over(entry, segment, length))
+        {
+            std::cerr << "Error writing to log file: " << entry.path << std::endl;
+            return;
         }
     }
 }
 
-client_logger &client_logger::operator=(const client_logger &other)
+bool client_logger::refcounted_stream::roll_over(stream_entry &entry, mapped_segment *full, size_t length)
 {
-    if (this != &other)
+    std::lock_guard<std::mutex> lock(entry.mut);
+
+    if (entry.segment.load() != full)
     {
-        _output_streams = other._output_streams;
-        _format = other._format;
+        return true;
     }
-    return *this;
+
+    std::string rotated = rotated_name(entry.path, entry.rotations + 1);
+
+    // Mapping the path again would truncate the inode the full segment is still mapped from: keep it sealed,
+    // so that writes fail until a rename succeeds
+    std::error_code ec;
+    std::filesystem::rename(entry.path, rotated, ec);
+    if (ec)
+    {
+        std::cerr << "Error rotating log file " << entry.path << ": " << ec.message() << std::endl;
+        return false;
+    }
+    ++entry.rotations;
+
+    auto next = std::make_unique<mapped_segment>();
+    next->map(entry.path, std::max(entry.segment_size, length));
+
+    entry.segment.store(next.get());
+    // Sealed segments stay allocated until the file is closed: a late writer may still touch their writers counter
+    entry.segments.push_front(std::move(next));
+
+    full->unmap();
+
+    rotation_worker::instance().push(rotated, entry.path, entry.rotation);
+    return true;
 }
 
-client_logger::client_logger(client_logger &&other) noexcept : _output_streams(std::move(other._output_streams)),
-    _format(std::move(other._format))
+#ifndef _WIN32
+void client_logger::mapped_segment::map(const std::string &path, size_t min_size)
 {
+    const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t length = (min_size + page - 1) / page * page;
+
+    int file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file == -1)
+    {
+        throw std::runtime_error("Failed to open log file: " + path + ": " + std::strerror(errno));
+    }
+
+    // Real allocation rather than a sparse ftruncate: running out of disk fails here instead of SIGBUS'ing a writer
+    #ifdef __linux__
+    int error = posix_fallocate(file, 0, static_cast<off_t>(length));
+    #else
+    int error = ftruncate(file, static_cast<off_t>(length)) == 0 ? 0 : errno;
+    #endif
+
+    void *mapping = error == 0 ? mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0) : MAP_FAILED;
+    if (mapping == MAP_FAILED)
+    {
+        if (error == 0) error = errno;
+        ::close(file);
+        throw std::runtime_error("Failed to map log file: " + path + ": " + std::strerror(error));
+    }
+
+    data = static_cast<char *>(mapping);
+    size = length;
+    fd = file;
 }
 
-client_logger &client_logger::operator=(client_logger &&other) noexcept
+void client_logger::mapped_segment::unmap() noexcept
 {
-    if (this != &other)
+    while (writers.load() != 0)
     {
-        _output_streams = std::move(other._output_streams);
-        _format = std::move(other._format);
+        std::this_thread::yield();
     }
-    return *this;
+
+    const size_t used = std::min({offset.load(), sealed.load(), size});
+
+    munmap(data, size);
+    if (ftruncate(fd, static_cast<off_t>(used)) != 0)
+    {
+        std::cerr << "Error truncating memory-mapped log file: " << std::strerror(errno) << std::endl;
+    }
+    ::close(fd);
+
+    data = nullptr;
+    fd = -1;
+}
+#else
+void client_logger::mapped_segment::map(const std::string &path, size_t)
+{
+    throw std::runtime_error("Memory-mapped log files are not supported on this platform: " + path);
 }
 
-client_logger::~client_logger() noexcept = default;
+void client_logger::mapped_segment::unmap() noexcept
+{
+}
+#endif
 
-client_logger::refcounted_stream::refcounted_stream(const std::string &path) : _stream(path, nullptr)
+client_logger::stream_entry::~stream_entry()
 {
-    
-    if (path.empty()) {
-        return;
+    unregister_from_crash_flush(this);
+
+    if (auto *current = segment.load(); current != nullptr)
+    {
+        current->unmap();
     }
 
-    std::lock_guard<std::mutex> lock(global_streams_mutex);
-    
-    auto it = _global_streams.find(path);
-    if (it == _global_streams.end())
+    if (fd != -1)
     {
-        _global_streams[path] = std::make_pair(1, std::ofstream(path));
-        if (!_global_streams[path].second.is_open()) {
-            throw std::runtime_error("Failed to open log file: " + path);
-        }
-        _stream.second = &_global_streams[path].second;
+        refcounted_stream::flush_buffer(*this);
+        close_log_file(fd);
     }
-    else
+}
+
+void client_logger::register_for_crash_flush(stream_entry *entry) noexcept
+{
+    for (auto &slot : _crash_slots)
     {
-        ++it->second.first;
-        _stream.second = &it->second.second;
+        stream_entry *expected = nullptr;
+        if (slot.compare_exchange_strong(expected, entry))
+        {
+            return;
+        }
     }
+
+    std::cerr << "Warning: too many buffered log files, " << entry->path << " will not be flushed on a crash" << std::endl;
 }
 
-client_logger::refcounted_stream::refcounted_stream(const client_logger::refcounted_stream &oth) : _stream(oth._stream)
+void client_logger::unregister_from_crash_flush(stream_entry *entry) noexcept
 {
-    if (_stream.second != nullptr && !_stream.first.empty())
+    for (auto &slot : _crash_slots)
     {
-        std::lock_guard<std::mutex> lock(global_streams_mutex);
-        
-        auto it = _global_streams.find(_stream.first);
-        if (it == _global_streams.end())
+        stream_entry *expected = entry;
+        if (slot.compare_exchange_strong(expected, nullptr))
         {
-            _stream.second = nullptr;
-            throw std::runtime_error("Global stream not found for path: " + _stream.first);
+            return;
         }
-        ++it->second.first;
     }
 }
 
-client_logger::refcounted_stream &
-client_logger::refcounted_stream::operator=(const client_logger::refcounted_stream &oth)
+void client_logger::crash_flush(int signal) noexcept
 {
-    if (this != &oth)
+    for (auto &slot : _crash_slots)
     {
+        stream_entry *entry = slot.load(std::memory_order_acquire);
+        if (entry == nullptr)
         {
-            std::lock_guard<std::mutex> lock(global_streams_mutex);
-            
-            if (_stream.second != nullptr && !_stream.first.empty())
+            continue;
+        }
+
+        if (entry->segment_size != 0)
+        {
+            #ifndef _WIN32
+            // The mapped pages survive the process anyway, only the preallocated tail has to go
+            if (auto *current = entry->segment.load(); current != nullptr && current->data != nullptr)
             {
-                auto current_it = _global_streams.find(_stream.first);
-                if (current_it != _global_streams.end())
-                {
-                    if (--current_it->second.first == 0)
-                    {
-                        current_it->second.second.close();
-                        _global_streams.erase(current_it);
-                    }
-                }
+                const size_t used = std::min({current->offset.load(), current->sealed.load(), current->size});
+                [[maybe_unused]] int result = ftruncate(current->fd, static_cast<off_t>(used));
             }
+            #endif
+        }
+        else if (size_t used = entry->buffered.load(std::memory_order_acquire); used != 0)
+        {
+            write_fully(entry->fd, entry->buffer.get(), used);
+            entry->buffered.store(0, std::memory_order_release);
+        }
+    }
+
+    #ifndef _WIN32
+    for (size_t i = 0; i < std::size(crash_signals); ++i)
+    {
+        if (crash_signals[i] == signal)
+        {
+            sigaction(signal, &previous_actions[i], nullptr);
         }
+    }
+    #else
+    std::signal(signal, SIG_DFL);
+    #endif
 
-        _stream.first = oth._stream.first;
-        _stream.second = oth._stream.second;
+    // Delivered to the previous handler as soon as this one returns
+    std::raise(signal);
+}
+
+void client_logger::enable_crash_flush()
+{
+    static std::once_flag installed;
 
-        if (_stream.second != nullptr && !_stream.first.empty())
+    std::call_once(installed, [] {
+        for (size_t i = 0; i < std::size(crash_signals); ++i)
         {
-            std::lock_guard<std::mutex> lock(global_streams_mutex);
-            
-            auto new_it = _global_streams.find(_stream.first);
-            if (new_it != _global_streams.end())
-            {
-                ++new_it->second.first;
-            }
-            else
-            {
-                _stream.second = nullptr;
-                throw std::runtime_error("Global stream not found for path: " + _stream.first);
-            }
+            #ifndef _WIN32
+            struct sigaction action{};
+            action.sa_handler = &client_logger::crash_flush;
+            action.sa_flags = SA_ONSTACK;
+            sigemptyset(&action.sa_mask);
+            sigaction(crash_signals[i], &action, &previous_actions[i]);
+            #else
+            std::signal(crash_signals[i], &client_logger::crash_flush);
+            #endif
+        }
+    });
+}
+
+client_logger::client_logger(
+    const std::unordered_map<logger::severity, std::pair<std::forward_list<refcounted_stream>, bool>> &streams,
+    std::string format,
+    bool json_lines) :
+    _output_streams(streams),
+    _format(std::move(format)),
+    _json_lines(json_lines)
+{
+    update_enabled_severities();
+}
+
+void client_logger::update_enabled_severities() noexcept
+{
+    _enabled_severities = 0;
+    for (auto &[sev, streams_pair] : _output_streams)
+    {
+        if (streams_pair.second || !streams_pair.first.empty())
+        {
+            _enabled_severities |= severity_bit(sev);
         }
     }
+}
+
+client_logger::flag client_logger::char_to_flag(char c) noexcept
+{
+    switch (c)
+    {
+    case 'd': return flag::DATE;
+    case 't': return flag::TIME;
+    case 's': return flag::SEVERITY;
+    case 'm': return flag::MESSAGE;
+    default:  return flag::NO_FLAG;
+    }
+}
+
+client_logger::client_logger(const client_logger &other) : logger(other), _output_streams(other._output_streams), _format(other._format),
+    _json_lines(other._json_lines)
+{
+}
+
+client_logger &client_logger::operator=(const client_logger &other)
+{
+    if (this != &other)
+    {
+        logger::operator=(other);
+        _output_streams = other._output_streams;
+        _format = other._format;
+        _json_lines = other._json_lines;
+    }
     return *this;
 }
 
-client_logger::refcounted_stream::refcounted_stream(client_logger::refcounted_stream &&oth) noexcept : _stream(std::move(oth._stream))
+client_logger::client_logger(client_logger &&other) noexcept : logger(other), _output_streams(std::move(other._output_streams)),
+    _format(std::move(other._format)), _json_lines(other._json_lines)
 {
-    oth._stream = {oth._stream.first, nullptr};
 }
 
-client_logger::refcounted_stream &client_logger::refcounted_stream::operator=(client_logger::refcounted_stream &&oth) noexcept
+client_logger &client_logger::operator=(client_logger &&other) noexcept
 {
-    if (this != &oth) {
-        this->~refcounted_stream();
-        _stream = std::move(oth._stream);
-        oth._stream = {oth._stream.first, nullptr};
+    if (this != &other)
+    {
+        logger::operator=(other);
+        _output_streams = std::move(other._output_streams);
+        _format = std::move(other._format);
+        _json_lines = other._json_lines;
     }
     return *this;
 }
 
-client_logger::refcounted_stream::~refcounted_stream()
+client_logger::~client_logger() noexcept = default;
+
+client_logger::refcounted_stream::refcounted_stream(const std::string &path) : refcounted_stream(path, rotation_policy())
+{
+}
+
+client_logger::refcounted_stream::refcounted_stream(const std::string &path, rotation_policy rotation) :
+    refcounted_stream(path, rotation, 0, 0)
 {
-    if (!_stream.second || _stream.first.empty()) return;
+}
 
-    std::lock_guard<std::mutex> lock(global_streams_mutex);
+client_logger::refcounted_stream::refcounted_stream(const std::string &path, rotation_policy rotation, size_t segment_size, size_t buffer_size)
+{
     
-    auto it = _global_streams.find(_stream.first);
-    if (it != _global_streams.end())
-    {
-        if (--it->second.first == 0)
-        {
-            it->second.second.close();
-            _global_streams.erase(it);
-        }
+    if (path.empty()) {
+        return;
     }
-}
\ No newline at end of file
+
+    _entry = intern(path, rotation, segment_size, buffer_size);
+}
@@ -9,6 +9,14 @@ using namespace nlohmann;
 logger_builder& client_logger_builder::add_file_stream(
     const std::string &stream_file_path,
     logger::severity severity) &
+{
+    return add_file_stream(stream_file_path, severity, client_logger::rotation_policy());
+}
+
+logger_builder& client_logger_builder::add_file_stream(
+    const std::string &stream_file_path,
+    logger::severity severity,
+    client_logger::rotation_policy rotation) &
 {
     try {
         if (stream_file_path.empty())
@@ -29,28 +37,18 @@ logger_builder& client_logger_builder::add_file_stream(
         }
 
         auto &severity_entry = _output_streams[severity];
-        
-        
-        bool duplicate = false;
+
+        // The same file twice for one severity would get every line twice
+        const size_t id = std::hash<std::string>()(stream_file_path);
         for (const auto &stream : severity_entry.first)
         {
-            if (stream._stream.first == stream_file_path)
+            if (stream.id() == id && stream.path() == stream_file_path)
             {
-                
-                std::cerr << "Warning: File path '" << stream_file_path << "' already added for this severity level" << std::endl;
-                duplicate = true;
-                break;
+                std::cerr << "Warning: File path '" << stream_file_path << "' already added for this severity level, stream not added" << std::endl;
+                return *this;
             }
         }
-        
-        
-        // uncomment if want to disallow duplicates
-        // if (duplicate) {
-        //     return *this;
-        // }
-        
-        
-        
+
         {
             std::ofstream test_file(stream_file_path, std::ios::app);
             if (!test_file.is_open()) {
@@ -59,8 +57,7 @@ logger_builder& client_logger_builder::add_file_stream(
             }
         }
         
-        //comment if want to disallow duplicates
-        severity_entry.first.emplace_front(client_logger::refcounted_stream(stream_file_path));
+        severity_entry.first.emplace_front(client_logger::refcounted_stream(stream_file_path, rotation, 0, _file_buffer_size));
         return *this;
     } catch (const std::exception& e) {
         std::cerr << "Error adding file stream: " << e.what() << std::endl;
@@ -68,6 +65,69 @@ logger_builder& client_logger_builder::add_file_stream(
     }
 }
 
+logger_builder& client_logger_builder::add_mapped_stream(
+    const std::string &stream_file_path,
+    logger::severity severity,
+    size_t segment_size,
+    client_logger::rotation_policy rotation) &
+{
+#ifdef _WIN32
+    std::cerr << "Warning: memory-mapped log files are not supported on this platform, using a file stream for '"
+              << stream_file_path << "'" << std::endl;
+    return add_file_stream(stream_file_path, severity, rotation);
+#else
+    try {
+        if (stream_file_path.empty())
+        {
+            std::cerr << "Warning: File path is empty, stream not added" << std::endl;
+            return *this;
+        }
+
+        if (segment_size == 0)
+        {
+            std::cerr << "Warning: Zero segment size for '" << stream_file_path << "', using the default" << std::endl;
+            segment_size = client_logger::default_segment_size;
+        }
+
+        std::filesystem::path path(stream_file_path);
+        if (!path.parent_path().empty() && !std::filesystem::exists(path.parent_path()))
+        {
+            std::filesystem::create_directories(path.parent_path());
+        }
+
+        _output_streams[severity].first.emplace_front(client_logger::refcounted_stream(stream_file_path, rotation, segment_size));
+        return *this;
+    } catch (const std::exception& e) {
+        std::cerr << "Error adding memory-mapped stream: " << e.what() << std::endl;
+        return *this;
+    }
+#endif
+}
+
+client_logger_builder& client_logger_builder::set_file_buffer_size(
+    size_t bytes) &
+{
+    _file_buffer_size = bytes;
+    return *this;
+}
+
+client_logger_builder& client_logger_builder::set_json_lines(
+    bool enabled) &
+{
+    _json_lines = enabled;
+    return *this;
+}
+
+client_logger_builder& client_logger_builder::enable_crash_flush() &
+{
+    try {
+        client_logger::enable_crash_flush();
+    } catch (const std::exception& e) {
+        std::cerr << "Error installing crash flush: " << e.what() << std::endl;
+    }
+    return *this;
+}
+
 logger_builder& client_logger_builder::add_console_stream(
     logger::severity severity) &
 {
@@ -110,6 +170,27 @@ logger_builder& client_logger_builder::transform_with_configuration(
             _format = node["format"].get<std::string>();
         }
 
+        client_logger::rotation_policy default_rotation;
+        if (node.contains("rotation"))
+        {
+            default_rotation = parse_rotation(node["rotation"]);
+        }
+
+        if (node.contains("json_lines"))
+        {
+            set_json_lines(node["json_lines"].get<bool>());
+        }
+
+        if (node.contains("buffer_size"))
+        {
+            set_file_buffer_size(node["buffer_size"].get<size_t>());
+        }
+
+        if (node.contains("crash_flush") && node["crash_flush"].get<bool>())
+        {
+            enable_crash_flush();
+        }
+
         
         if (node.contains("severity"))
         {
@@ -139,9 +220,34 @@ logger_builder& client_logger_builder::transform_with_configuration(
                 
                 if (severity_config.contains("files") && severity_config["files"].is_array())
                 {
-                    for (const auto& file_path : severity_config["files"])
+                    for (const auto& file : severity_config["files"])
                     {
-                        add_file_stream(file_path.get<std::string>(), severity);
+                        if (file.is_object())
+                        {
+                            add_file_stream(file.at("path").get<std::string>(), severity,
+                                            file.contains("rotation") ? parse_rotation(file["rotation"]) : default_rotation);
+                        }
+                        else
+                        {
+                            add_file_stream(file.get<std::string>(), severity, default_rotation);
+                        }
+                    }
+                }
+
+                if (severity_config.contains("mapped") && severity_config["mapped"].is_array())
+                {
+                    for (const auto& file : severity_config["mapped"])
+                    {
+                        if (file.is_object())
+                        {
+                            add_mapped_stream(file.at("path").get<std::string>(), severity,
+                                              file.value("segment_size", client_logger::default_segment_size),
+                                              file.contains("rotation") ? parse_rotation(file["rotation"]) : default_rotation);
+                        }
+                        else
+                        {
+                            add_mapped_stream(file.get<std::string>(), severity, client_logger::default_segment_size, default_rotation);
+                        }
                     }
                 }
             }
@@ -173,7 +279,14 @@ logger_builder& client_logger_builder::transform_with_configuration(
                 else if (type == "file")
                 {
                     std::string path = stream["path"].get<std::string>();
-                    add_file_stream(path, severity);
+                    add_file_stream(path, severity,
+                                    stream.contains("rotation") ? parse_rotation(stream["rotation"]) : default_rotation);
+                }
+                else if (type == "mapped")
+                {
+                    add_mapped_stream(stream["path"].get<std::string>(), severity,
+                                      stream.value("segment_size", client_logger::default_segment_size),
+                                      stream.contains("rotation") ? parse_rotation(stream["rotation"]) : default_rotation);
                 }
                 else
                 {
@@ -191,11 +304,44 @@ logger_builder& client_logger_builder::transform_with_configuration(
     }
 }
 
+client_logger::rotation_policy client_logger_builder::parse_rotation(const json &j)
+{
+    client_logger::rotation_policy rotation;
+
+    if (j.contains("max_size"))
+    {
+        rotation.max_size = j["max_size"].get<size_t>();
+    }
+    if (j.contains("daily"))
+    {
+        rotation.daily = j["daily"].get<bool>();
+    }
+    if (j.contains("keep"))
+    {
+        rotation.keep = j["keep"].get<size_t>();
+    }
+    if (j.contains("compression"))
+    {
+        auto compression = j["compression"].get<std::string>();
+        if (compression == "none") rotation.compress = client_logger::rotation_policy::compression::none;
+        else if (compression == "gzip") rotation.compress = client_logger::rotation_policy::compression::gzip;
+        else if (compression == "zstd") rotation.compress = client_logger::rotation_policy::compression::zstd;
+        else
+        {
+            throw std::runtime_error("Unknown rotation compression: " + compression);
+        }
+    }
+
+    return rotation;
+}
+
 logger_builder& client_logger_builder::clear() &
 {
     try {
         _output_streams.clear();
         _format = "%m";
+        _file_buffer_size = 0;
+        _json_lines = false;
         return *this;
     } catch (const std::exception& e) {
         std::cerr << "Error clearing logger builder: " << e.what() << std::endl;
@@ -215,7 +361,7 @@ logger *client_logger_builder::build() const
         {
             std::cerr << "Warning: Empty format string, using default format \"%m\"" << std::endl;
 
-            return new client_logger(_output_streams, "%m");
+            return new client_logger(_output_streams, "%m", _json_lines);
         }
 
 
@@ -224,7 +370,7 @@ logger *client_logger_builder::build() const
             std::cerr << "Warning: Format string does not contain message placeholder (%m), messages will not be displayed" << std::endl;
         }
 
-        return new client_logger(_output_streams, _format);
+        return new client_logger(_output_streams, _format, _json_lines);
     }
     catch (const std::exception& e) {
         std::cerr << "Error building logger: " << e.what() << std::endl;
@@ -3,6 +3,514 @@
 #include "../include/client_logger_builder.h"
 
 #include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <csignal>
+#include <ctime>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+TEST(client_logger_tests, disabled_severity_skips_message_construction)
+{
+    client_logger_builder builder;
+    builder.add_console_stream(logger::severity::error);
+
+    std::unique_ptr<logger> log(builder.build());
+
+    EXPECT_TRUE(log->is_enabled(logger::severity::error));
+    EXPECT_FALSE(log->is_enabled(logger::severity::debug));
+
+    int built = 0;
+    log->debug([&built] { ++built; return std::string("never built"); });
+    log->error([&built] { ++built; return std::string("built once"); });
+
+    EXPECT_EQ(built, 1);
+}
+
+TEST(client_logger_tests, concurrent_writes_to_shared_file_are_serialised)
+{
+    constexpr int threads_count = 4;
+    constexpr int messages_count = 1000;
+    const std::string message = "a line that must never be interleaved with another one";
+
+    {
+        client_logger_builder builder;
+        builder.add_file_stream("shared_stream_test.txt", logger::severity::information);
+
+        std::unique_ptr<logger> first(builder.build());
+        std::unique_ptr<logger> second(builder.build());
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threads_count; ++i)
+        {
+            threads.emplace_back([&, i] {
+                client_logger copy(*static_cast<client_logger *>(i % 2 == 0 ? first.get() : second.get()));
+                for (int j = 0; j < messages_count; ++j)
+                {
+                    copy.information(message);
+                }
+            });
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    std::ifstream file("shared_stream_test.txt");
+    std::string line;
+    int lines = 0;
+    while (std::getline(file, line))
+    {
+        EXPECT_EQ(line, message);
+        ++lines;
+    }
+
+    EXPECT_EQ(lines, threads_count * messages_count);
+
+    file.close();
+    std::filesystem::remove("shared_stream_test.txt");
+}
+
+TEST(client_logger_tests, duplicate_file_stream_is_not_added)
+{
+    {
+        client_logger_builder builder;
+        builder.add_file_stream("duplicate_stream_test.txt", logger::severity::information);
+        builder.add_file_stream("duplicate_stream_test.txt", logger::severity::information);
+
+        std::unique_ptr<logger> log(builder.build());
+        log->information("written once");
+    }
+
+    std::ifstream file("duplicate_stream_test.txt");
+    std::string line;
+    int lines = 0;
+    while (std::getline(file, line))
+    {
+        EXPECT_EQ(line, "written once");
+        ++lines;
+    }
+    EXPECT_EQ(lines, 1);
+
+    file.close();
+    std::filesystem::remove("duplicate_stream_test.txt");
+}
+
+TEST(client_logger_tests, size_rotation_renames_full_file)
+{
+    std::filesystem::remove_all("rotation_test");
+    std::filesystem::create_directories("rotation_test");
+
+    client_logger::rotation_policy rotation;
+    rotation.max_size = 64;
+
+    {
+        client_logger_builder builder;
+        builder.add_file_stream("rotation_test/log.txt", logger::severity::information, rotation);
+
+        std::unique_ptr<logger> log(builder.build());
+        for (int i = 0; i < 10; ++i)
+        {
+            log->information("message number " + std::to_string(i));
+        }
+    }
+
+    size_t rotated = 0;
+    for (const auto& file : std::filesystem::directory_iterator("rotation_test"))
+    {
+        EXPECT_LE(file.file_size(), rotation.max_size);
+        if (file.path().filename() != "log.txt")
+        {
+            ++rotated;
+        }
+    }
+
+    EXPECT_GE(rotated, 2u);
+
+    std::filesystem::remove_all("rotation_test");
+}
+
+namespace
+{
+    /** Puts non-empty directories at the names the first rotation of path takes over the next minute, so that
+     *  renaming the file fails
+     */
+    void block_rotation(const std::string& path)
+    {
+        const std::time_t now = std::time(nullptr);
+        for (std::time_t second = now - 1; second < now + 60; ++second)
+        {
+            std::tm tm_buf{};
+            #ifdef _WIN32
+            gmtime_s(&tm_buf, &second);
+            #else
+            gmtime_r(&second, &tm_buf);
+            #endif
+
+            char timestamp[32];
+            std::strftime(timestamp, sizeof(timestamp), "%Y%m%d-%H%M%S", &tm_buf);
+            std::filesystem::create_directories(path + "." + timestamp + "-000001/occupied");
+        }
+    }
+}
+
+TEST(client_logger_tests, failed_rotation_keeps_appending)
+{
+    std::filesystem::remove_all("failed_rotation_test");
+    std::filesystem::create_directories("failed_rotation_test");
+    block_rotation("failed_rotation_test/log.txt");
+
+    client_logger::rotation_policy rotation;
+    rotation.max_size = 64;
+
+    constexpr int records = 10;
+    {
+        client_logger_builder builder;
+        builder.add_file_stream("failed_rotation_test/log.txt", logger::severity::information, rotation);
+
+        std::unique_ptr<logger> log(builder.build());
+        for (int i = 0; i < records; ++i)
+        {
+            log->information("record " + std::to_string(i));
+        }
+    }
+
+    std::ifstream file("failed_rotation_test/log.txt");
+    int lines = 0;
+    for (std::string line; std::getline(file, line); ++lines)
+    {
+        EXPECT_EQ(line, "record " + std::to_string(lines));
+    }
+    EXPECT_EQ(lines, records);
+
+    file.close();
+    std::filesystem::remove_all("failed_rotation_test");
+}
+
+TEST(client_logger_tests, pruning_removes_only_rotated_files)
+{
+    std::filesystem::remove_all("prune_test");
+    std::filesystem::create_directories("prune_test");
+
+    const std::vector<std::string> unrelated = {"log.txt.0-notes", "log.txt.config", "log.txt.20240101-000000-1.bak"};
+    for (const auto& name : unrelated)
+    {
+        std::ofstream("prune_test/" + name) << "not a rotated log";
+    }
+    // Older than anything the logger writes, so pruning removes it first
+    std::ofstream("prune_test/log.txt.20000101-000000-000000") << "old";
+
+    client_logger::rotation_policy rotation;
+    rotation.max_size = 64;
+    rotation.keep = 2;
+
+    {
+        client_logger_builder builder;
+        builder.add_file_stream("prune_test/log.txt", logger::severity::information, rotation);
+
+        std::unique_ptr<logger> log(builder.build());
+        for (int i = 0; i < 10; ++i)
+        {
+            log->information("message number " + std::to_string(i));
+        }
+    }
+
+    // Pruning runs on a background thread
+    const auto rotated_count = [] {
+        size_t count = 0;
+        for (const auto& file : std::filesystem::directory_iterator("prune_test"))
+        {
+            count += file.path().filename().string().starts_with("log.txt.2");
+        }
+        return count;
+    };
+    for (int i = 0; i < 200 && rotated_count() > rotation.keep + 1; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    for (const auto& name : unrelated)
+    {
+        EXPECT_TRUE(std::filesystem::exists("prune_test/" + name)) << name;
+    }
+    EXPECT_FALSE(std::filesystem::exists("prune_test/log.txt.20000101-000000-000000"));
+    // The two kept archives and the malformed name that merely shares the prefix
+    EXPECT_EQ(rotated_count(), rotation.keep + 1);
+
+    std::filesystem::remove_all("prune_test");
+}
+
+TEST(client_logger_tests, mapped_stream_rolls_over_without_losing_lines)
+{
+    constexpr int threads_count = 4;
+    constexpr int messages_count = 1000;
+    const std::string message = "a line written through the memory-mapped segment";
+
+    std::filesystem::remove_all("mapped_test");
+
+    {
+        client_logger_builder builder;
+        builder.add_mapped_stream("mapped_test/log.txt", logger::severity::information, 4096);
+
+        std::unique_ptr<logger> log(builder.build());
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threads_count; ++i)
+        {
+            threads.emplace_back([&] {
+                for (int j = 0; j < messages_count; ++j)
+                {
+                    log->information(message);
+                }
+            });
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    size_t segments = 0;
+    int lines = 0;
+    for (const auto& file : std::filesystem::directory_iterator("mapped_test"))
+    {
+        ++segments;
+
+        std::ifstream in(file.path());
+        std::string line;
+        while (std::getline(in, line))
+        {
+            EXPECT_EQ(line, message);
+            ++lines;
+        }
+    }
+
+    EXPECT_EQ(lines, threads_count * messages_count);
+    EXPECT_GT(segments, 1u);
+
+    std::filesystem::remove_all("mapped_test");
+}
+
+TEST(client_logger_tests, failed_roll_over_keeps_full_segment)
+{
+    std::filesystem::remove_all("failed_roll_over_test");
+    std::filesystem::create_directories("failed_roll_over_test");
+    block_rotation("failed_roll_over_test/log.txt");
+
+    constexpr size_t segment_size = 4096;
+    constexpr int records = 1000;
+    {
+        client_logger_builder builder;
+        builder.add_mapped_stream("failed_roll_over_test/log.txt", logger::severity::information, segment_size);
+
+        std::unique_ptr<logger> log(builder.build());
+        for (int i = 0; i < records; ++i)
+        {
+            log->information("record " + std::to_string(i));
+        }
+    }
+
+    // The records that fit in the segment survive; the rest could not be written anywhere
+    std::ifstream file("failed_roll_over_test/log.txt");
+    size_t size = 0;
+    int lines = 0;
+    for (std::string line; std::getline(file, line); ++lines)
+    {
+        EXPECT_EQ(line, "record " + std::to_string(lines));
+        size += line.size() + 1;
+    }
+    EXPECT_GT(lines, 0);
+    EXPECT_LT(lines, records);
+    EXPECT_GT(size + std::string("record 999\n").size(), segment_size);
+
+    file.close();
+    std::filesystem::remove_all("failed_roll_over_test");
+}
+
+TEST(client_logger_tests, rate_limited_site_reports_suppressed_messages)
+{
+    constexpr int burst_calls = 10;
+
+    {
+        client_logger_builder builder;
+        builder.add_file_stream("rate_limit_test.txt", logger::severity::error);
+        std::unique_ptr<logger> log(builder.build());
+
+        log_rate_limiter limiter(10);
+        for (int i = 0; i < burst_calls; ++i)
+        {
+            log->error(limiter, "out of memory");
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        log->error(limiter, [] { return std::string("out of memory"); });
+    }
+
+    std::ifstream file("rate_limit_test.txt");
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);)
+    {
+        lines.push_back(line);
+    }
+
+    ASSERT_GE(lines.size(), 3u);
+    EXPECT_EQ(lines.front(), "out of memory");
+    EXPECT_EQ(lines.back(), "out of memory");
+
+    int admitted = 0;
+    int suppressed = 0;
+    for (const auto &line : lines)
+    {
+        if (line == "out of memory")
+        {
+            ++admitted;
+        }
+        else
+        {
+            EXPECT_NE(line.find(" messages suppressed"), std::string::npos);
+            suppressed += std::stoi(line);
+        }
+    }
+    EXPECT_EQ(admitted + suppressed, burst_calls + 1);
+    EXPECT_GT(suppressed, 0);
+
+    file.close();
+    std::filesystem::remove("rate_limit_test.txt");
+}
+
+TEST(client_logger_tests, stalled_rate_limiter_admits_only_its_first_calls)
+{
+    // A rate that is not positive or refills slower than the intervals can count, with bursts whose span overflows
+    for (double per_second : {0.0, -1.0, 1e-12, 1e-300})
+    {
+        for (size_t burst : {size_t{1}, size_t{6}, size_t{1000000}, SIZE_MAX})
+        {
+            log_rate_limiter limiter(per_second, burst);
+
+            uint64_t suppressed = 0;
+            int admitted = 0;
+            for (int i = 0; i < 100; ++i)
+            {
+                admitted += limiter.try_acquire(suppressed);
+            }
+
+            EXPECT_GE(admitted, 1) << per_second << " per second, burst " << burst;
+            EXPECT_LE(admitted, 2) << per_second << " per second, burst " << burst;
+        }
+    }
+}
+
+TEST(client_logger_tests, sampling_keeps_requested_fraction)
+{
+    client_logger_builder builder;
+    builder.add_file_stream("sampling_test.txt", logger::severity::debug);
+    builder.add_file_stream("sampling_test.txt", logger::severity::trace);
+    std::unique_ptr<logger> log(builder.build());
+
+    log->set_sampling(logger::severity::debug, 0.25);
+    log->set_sampling(logger::severity::trace, 0);
+
+    int debug_built = 0;
+    int trace_built = 0;
+    for (int i = 0; i < 10000; ++i)
+    {
+        log->debug([&debug_built] { ++debug_built; return std::string(); });
+        log->trace([&trace_built] { ++trace_built; return std::string(); });
+    }
+
+    EXPECT_GT(debug_built, 2000);
+    EXPECT_LT(debug_built, 3000);
+    EXPECT_EQ(trace_built, 0);
+
+    log.reset();
+    std::filesystem::remove("sampling_test.txt");
+}
+
+TEST(client_logger_tests, json_lines_carry_typed_fields)
+{
+    {
+        client_logger_builder builder;
+        builder.add_file_stream("json_lines_test.txt", logger::severity::information);
+        builder.set_json_lines(true);
+        std::unique_ptr<logger> log(builder.build());
+
+        log->information("block \"allocated\"\n", {{"size", 4096u}, {"offset", -16}, {"ratio", 0.5},
+                                                    {"fit", "best"}, {"zeroed", true}});
+        log->information("plain");
+    }
+
+    std::ifstream file("json_lines_test.txt");
+    std::string first;
+    std::string second;
+    ASSERT_TRUE(std::getline(file, first));
+    ASSERT_TRUE(std::getline(file, second));
+
+    auto record = nlohmann::json::parse(first);
+    EXPECT_EQ(record["severity"], "INFORMATION");
+    EXPECT_EQ(record["message"], "block \"allocated\"\n");
+    EXPECT_EQ(record["size"], 4096u);
+    EXPECT_EQ(record["offset"], -16);
+    EXPECT_DOUBLE_EQ(record["ratio"].get<double>(), 0.5);
+    EXPECT_EQ(record["fit"], "best");
+    EXPECT_EQ(record["zeroed"], true);
+    EXPECT_TRUE(record.contains("time"));
+
+    EXPECT_EQ(nlohmann::json::parse(second)["message"], "plain");
+
+    file.close();
+    std::filesystem::remove("json_lines_test.txt");
+}
+
+TEST(client_logger_tests, crash_flush_saves_buffered_records)
+{
+#ifdef _WIN32
+    GTEST_SKIP() << "needs fork()";
+#else
+    constexpr int records = 10;
+    std::filesystem::remove("crash_flush_test.txt");
+
+    pid_t child = fork();
+    ASSERT_NE(child, -1);
+
+    if (child == 0)
+    {
+        client_logger_builder builder;
+        builder.set_file_buffer_size(1 << 16).enable_crash_flush();
+        builder.add_file_stream("crash_flush_test.txt", logger::severity::information);
+
+        logger *log = builder.build();
+        for (int i = 0; i < records; ++i)
+        {
+            log->information("record " + std::to_string(i));
+        }
+
+        std::abort();
+    }
+
+    int status = 0;
+    ASSERT_EQ(waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFSIGNALED(status));
+    EXPECT_EQ(WTERMSIG(status), SIGABRT);
+
+    std::ifstream file("crash_flush_test.txt");
+    int lines = 0;
+    for (std::string line; std::getline(file, line); ++lines)
+    {
+        EXPECT_EQ(line, "record " + std::to_string(lines));
+    }
+    EXPECT_EQ(lines, records);
+
+    file.close();
+    std::filesystem::remove("crash_flush_test.txt");
+#endif
+}
 
 int main(int argc, char *argv[])
 {
@@ -0,0 +1,175 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_JSON_WRITER_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_JSON_WRITER_H
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "log_field.h"
+
+/** Minimal streaming JSON encoder for log records. It appends to a caller-owned string, so a buffer that is
+ *  cleared and reused between records stops allocating once it has grown to the longest record.
+ *  It trusts the caller to produce a well-formed sequence of calls and does not validate UTF-8.
+ */
+class json_writer final
+{
+    std::string& _out;
+    bool _need_comma = false;
+
+    void separate()
+    {
+        if (_need_comma)
+        {
+            _out.push_back(',');
+        }
+        _need_comma = true;
+    }
+
+    template<class T>
+    json_writer& number(T number)
+    {
+        separate();
+        char buffer[32];
+        auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), number);
+        _out.append(buffer, end);
+        return *this;
+    }
+
+    void escaped(std::string_view text)
+    {
+        static constexpr char hex[] = "0123456789abcdef";
+
+        _out.push_back('"');
+
+        size_t plain = 0;
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            const auto c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+            {
+                continue;
+            }
+
+            _out.append(text.data() + plain, i - plain);
+            plain = i + 1;
+
+            switch (c)
+            {
+            case '"': _out.append("\\\""); break;
+            case '\\': _out.append("\\\\"); break;
+            case '\n': _out.append("\\n"); break;
+            case '\r': _out.append("\\r"); break;
+            case '\t': _out.append("\\t"); break;
+            default:
+                _out.append("\\u00");
+                _out.push_back(hex[c >> 4]);
+                _out.push_back(hex[c & 0xf]);
+                break;
+            }
+        }
+        _out.append(text.data() + plain, text.size() - plain);
+
+        _out.push_back('"');
+    }
+
+public:
+
+    explicit json_writer(std::string& out) noexcept : _out(out) {}
+
+    json_writer& begin_object()
+    {
+        separate();
+        _out.push_back('{');
+        _need_comma = false;
+        return *this;
+    }
+
+    json_writer& end_object()
+    {
+        _out.push_back('}');
+        _need_comma = true;
+        return *this;
+    }
+
+    json_writer& begin_array()
+    {
+        separate();
+        _out.push_back('[');
+        _need_comma = false;
+        return *this;
+    }
+
+    json_writer& end_array()
+    {
+        _out.push_back(']');
+        _need_comma = true;
+        return *this;
+    }
+
+    json_writer& key(std::string_view name)
+    {
+        separate();
+        escaped(name);
+        _out.push_back(':');
+        _need_comma = false;
+        return *this;
+    }
+
+    json_writer& value(std::string_view text)
+    {
+        separate();
+        escaped(text);
+        return *this;
+    }
+
+    json_writer& value(const char* text)
+    {
+        return value(std::string_view(text));
+    }
+
+    json_writer& value(bool flag)
+    {
+        separate();
+        _out.append(flag ? "true" : "false");
+        return *this;
+    }
+
+    json_writer& value(int64_t number)
+    {
+        return this->number(number);
+    }
+
+    json_writer& value(uint64_t number)
+    {
+        return this->number(number);
+    }
+
+    json_writer& value(int number)
+    {
+        return this->number(static_cast<int64_t>(number));
+    }
+
+    json_writer& value(double number)
+    {
+        if (!std::isfinite(number))
+        {
+            separate();
+            _out.append("null");
+            return *this;
+        }
+        return this->number(number);
+    }
+
+    json_writer& value(const log_field& field)
+    {
+        return std::visit([this](auto v) -> json_writer& { return value(v); }, field.value);
+    }
+
+    json_writer& field(const log_field& field)
+    {
+        return key(field.key).value(field);
+    }
+};
+
+#endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_JSON_WRITER_H
@@ -0,0 +1,38 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_FIELD_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_FIELD_H
+
+#include <concepts>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <variant>
+
+/** Typed key/value attached to a log record. Keys and string values are views: a field lives only for the call
+ *  it is passed to, e.g. log->information("allocated", {{"size", size}, {"fit", "best"}}).
+ */
+struct log_field
+{
+    std::string_view key;
+    std::variant<std::string_view, int64_t, uint64_t, double, bool> value;
+
+    log_field(std::string_view field_key, std::string_view field_value) noexcept : key(field_key), value(field_value) {}
+
+    log_field(std::string_view field_key, const char* field_value) noexcept : key(field_key), value(std::string_view(field_value)) {}
+
+    log_field(std::string_view field_key, const std::string& field_value) noexcept : key(field_key), value(std::string_view(field_value)) {}
+
+    log_field(std::string_view field_key, bool field_value) noexcept : key(field_key), value(field_value) {}
+
+    template<std::signed_integral T>
+    requires (!std::same_as<T, bool>)
+    log_field(std::string_view field_key, T field_value) noexcept : key(field_key), value(static_cast<int64_t>(field_value)) {}
+
+    template<std::unsigned_integral T>
+    requires (!std::same_as<T, bool>)
+    log_field(std::string_view field_key, T field_value) noexcept : key(field_key), value(static_cast<uint64_t>(field_value)) {}
+
+    template<std::floating_point T>
+    log_field(std::string_view field_key, T field_value) noexcept : key(field_key), value(static_cast<double>(field_value)) {}
+};
+
+#endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_FIELD_H
@@ -0,0 +1,97 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_RATE_LIMITER_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_RATE_LIMITER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+/** Token bucket for one noisy call site (keep it in a static local) or one message key (see for_key).
+ *  Implemented as GCRA over a single atomic "theoretical arrival time", so a suppressed call is a clock read,
+ *  a load and a relaxed increment of the suppressed counter. Suppressed calls are reported by the logger
+ *  as a "N messages suppressed" record in front of the next admitted one, i.e. at most once per token.
+ */
+class log_rate_limiter final
+{
+    // About 73 years: the interval and the burst tolerance saturate here, so arrival +- either cannot overflow
+    static constexpr int64_t max_nanoseconds = INT64_MAX / 4;
+
+    const int64_t _interval;
+    const int64_t _tolerance;
+
+    std::atomic<int64_t> _arrival = 0;
+    std::atomic<uint64_t> _suppressed = 0;
+
+    const std::string _key;
+
+    static int64_t saturated(double nanoseconds) noexcept
+    {
+        return nanoseconds < static_cast<double>(max_nanoseconds) ? static_cast<int64_t>(nanoseconds) : max_nanoseconds;
+    }
+
+    static int64_t now() noexcept
+    {
+#ifdef __linux__
+        // The coarse clock is several times cheaper than steady_clock; its tick (1-4 ms) is fine for log rates
+        timespec time;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &time);
+        return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+public:
+
+    /** per_second tokens are refilled continuously, up to burst of them are available at once.
+     *  The interval between tokens and the span of burst - 1 of them saturate at about 73 years each, so a rate
+     *  that is not positive, or as slow, admits at most two calls and then nothing for the life of the process
+     */
+    explicit log_rate_limiter(double per_second, size_t burst = 1, std::string key = {}) :
+        _interval(per_second > 0 ? saturated(1e9 / per_second) : max_nanoseconds),
+        _tolerance(saturated(static_cast<double>(_interval) * static_cast<double>(std::max<size_t>(burst, 1) - 1))),
+        _key(std::move(key))
+    {
+    }
+
+    log_rate_limiter(const log_rate_limiter&) = delete;
+    log_rate_limiter& operator=(const log_rate_limiter&) = delete;
+
+    /** On admission returns through suppressed the number of calls dropped since the previous admission
+     */
+    bool try_acquire(uint64_t& suppressed) noexcept
+    {
+        const int64_t current = now();
+        int64_t arrival = _arrival.load(std::memory_order_relaxed);
+
+        do
+        {
+            if (current < arrival - _tolerance)
+            {
+                _suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        while (!_arrival.compare_exchange_weak(arrival, std::max(arrival, current) + _interval, std::memory_order_relaxed));
+
+        suppressed = _suppressed.load(std::memory_order_relaxed) == 0 ? 0 : _suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    [[nodiscard]] std::string summary(uint64_t suppressed) const
+    {
+        return std::to_string(suppressed) + " messages suppressed" + (_key.empty() ? "" : " (" + _key + ")");
+    }
+
+    /** Process-wide limiter shared by every call site logging under the key; the first call fixes its rate
+     */
+    static log_rate_limiter& for_key(const std::string& key, double per_second, size_t burst = 1);
+};
+
+#endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_RATE_LIMITER_H
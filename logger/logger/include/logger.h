@@ -2,6 +2,19 @@
 #define MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOGGER_H
 
 #include <iostream>
+#include <string>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <utility>
+#include "log_field.h"
+#include "log_rate_limiter.h"
+#if __has_include(<format>)
+#include <format>
+#endif
 
 class logger
 {
@@ -20,6 +33,16 @@ public:
 
 public:
 
+    logger() noexcept = default;
+
+    /** Copies take the sampling the other logger has at the moment
+     */
+    logger(
+        logger const &other) noexcept;
+
+    logger& operator=(
+        logger const &other) noexcept;
+
     virtual ~logger() noexcept = default;
 
 public:
@@ -28,6 +51,109 @@ public:
         std::string const &message,
         logger::severity severity) & = 0;
 
+    /** Structured record. Loggers that understand fields render them natively (client_logger JSON lines,
+     *  server_logger payload); the default appends " key=value" pairs to the message text.
+     */
+    virtual logger& log(
+        std::string const &message,
+        logger::severity severity,
+        std::span<const log_field> fields) &;
+
+    logger& log(
+        std::string const &message,
+        logger::severity severity,
+        std::initializer_list<log_field> fields) &
+    {
+        return log(message, severity, std::span<const log_field>(fields.begin(), fields.size()));
+    }
+
+    /** Single branch, no allocation: call it (or the lazy overloads below) before building expensive messages
+     */
+    bool is_enabled(
+        logger::severity severity) const noexcept
+    {
+        return (_enabled_severities & severity_bit(severity)) != 0;
+    }
+
+    /** is_enabled plus sampling; used by the severity helpers, lazy, rate-limited and guardant overloads
+     *  (a direct log(message, severity) call is never sampled)
+     */
+    bool should_log(
+        logger::severity severity) noexcept
+    {
+        if (!is_enabled(severity))
+        {
+            return false;
+        }
+
+        const uint32_t threshold = _sampling[static_cast<size_t>(severity)].load(std::memory_order_relaxed);
+        return threshold == keep_all || sample_random() < threshold;
+    }
+
+    /** Keeps about the given fraction (0..1) of the severity's messages, meant for trace and debug
+     */
+    void set_sampling(
+        logger::severity severity,
+        double probability) noexcept;
+
+    /** Lazy logging: the callable producing the message is invoked only if the severity is enabled
+     */
+    template<std::invocable F>
+    logger& log(
+        logger::severity severity,
+        F &&make_message) &
+    {
+        if (should_log(severity))
+        {
+            log(std::string(std::forward<F>(make_message)()), severity);
+        }
+        return *this;
+    }
+
+#if __has_include(<format>)
+    template<class... Args>
+    logger& log(
+        logger::severity severity,
+        std::format_string<Args...> format,
+        Args &&...args) &
+    {
+        if (should_log(severity))
+        {
+            log(std::format(format, std::forward<Args>(args)...), severity);
+        }
+        return *this;
+    }
+#endif
+
+    /** Rate-limited logging: message is a string or a callable producing one, built only when admitted
+     */
+    template<class M>
+    requires std::invocable<M> || std::convertible_to<M, std::string const &>
+    logger& log(
+        log_rate_limiter &limiter,
+        logger::severity severity,
+        M &&message) &
+    {
+        uint64_t suppressed;
+        if (should_log(severity) && limiter.try_acquire(suppressed))
+        {
+            if (suppressed != 0)
+            {
+                log(limiter.summary(suppressed), severity);
+            }
+
+            if constexpr (std::invocable<M>)
+            {
+                log(std::string(std::forward<M>(message)()), severity);
+            }
+            else
+            {
+                log(message, severity);
+            }
+        }
+        return *this;
+    }
+
 public:
 
     logger& trace(
@@ -48,11 +174,153 @@ public:
     logger& critical(
         std::string const &message) &;
 
+    logger& trace(std::string const &message, std::initializer_list<log_field> fields) & { return with_fields(message, severity::trace, fields); }
+
+    logger& debug(std::string const &message, std::initializer_list<log_field> fields) & { return with_fields(message, severity::debug, fields); }
+
+    logger& information(std::string const &message, std::initializer_list<log_field> fields) & { return with_fields(message, severity::information, fields); }
+
+    logger& warning(std::string const &message, std::initializer_list<log_field> fields) & { return with_fields(message, severity::warning, fields); }
+
+    logger& error(std::string const &message, std::initializer_list<log_field> fields) & { return with_fields(message, severity::error, fields); }
+
+    logger& critical(std::string const &message, std::initializer_list<log_field> fields) & { return with_fields(message, severity::critical, fields); }
+
+    template<std::invocable F>
+    logger& trace(F &&make_message) & { return log(severity::trace, std::forward<F>(make_message)); }
+
+    template<std::invocable F>
+    logger& debug(F &&make_message) & { return log(severity::debug, std::forward<F>(make_message)); }
+
+    template<std::invocable F>
+    logger& information(F &&make_message) & { return log(severity::information, std::forward<F>(make_message)); }
+
+    template<std::invocable F>
+    logger& warning(F &&make_message) & { return log(severity::warning, std::forward<F>(make_message)); }
+
+    template<std::invocable F>
+    logger& error(F &&make_message) & { return log(severity::error, std::forward<F>(make_message)); }
+
+    template<std::invocable F>
+    logger& critical(F &&make_message) & { return log(severity::critical, std::forward<F>(make_message)); }
+
+    template<class M>
+    logger& trace(log_rate_limiter &limiter, M &&message) & { return log(limiter, severity::trace, std::forward<M>(message)); }
+
+    template<class M>
+    logger& debug(log_rate_limiter &limiter, M &&message) & { return log(limiter, severity::debug, std::forward<M>(message)); }
+
+    template<class M>
+    logger& information(log_rate_limiter &limiter, M &&message) & { return log(limiter, severity::information, std::forward<M>(message)); }
+
+    template<class M>
+    logger& warning(log_rate_limiter &limiter, M &&message) & { return log(limiter, severity::warning, std::forward<M>(message)); }
+
+    template<class M>
+    logger& error(log_rate_limiter &limiter, M &&message) & { return log(limiter, severity::error, std::forward<M>(message)); }
+
+    template<class M>
+    logger& critical(log_rate_limiter &limiter, M &&message) & { return log(limiter, severity::critical, std::forward<M>(message)); }
+
+#if __has_include(<format>)
+    // At least one argument is required, otherwise a plain string literal would be ambiguous with the eager overloads
+
+    template<class Arg, class... Args>
+    logger& trace(std::format_string<Arg, Args...> format, Arg &&arg, Args &&...args) &
+    {
+        return log(severity::trace, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<class Arg, class... Args>
+    logger& debug(std::format_string<Arg, Args...> format, Arg &&arg, Args &&...args) &
+    {
+        return log(severity::debug, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<class Arg, class... Args>
+    logger& information(std::format_string<Arg, Args...> format, Arg &&arg, Args &&...args) &
+    {
+        return log(severity::information, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<class Arg, class... Args>
+    logger& warning(std::format_string<Arg, Args...> format, Arg &&arg, Args &&...args) &
+    {
+        return log(severity::warning, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<class Arg, class... Args>
+    logger& error(std::format_string<Arg, Args...> format, Arg &&arg, Args &&...args) &
+    {
+        return log(severity::error, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<class Arg, class... Args>
+    logger& critical(std::format_string<Arg, Args...> format, Arg &&arg, Args &&...args) &
+    {
+        return log(severity::critical, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+#endif
+
+protected:
+
+    static constexpr unsigned int severity_bit(
+        logger::severity severity) noexcept
+    {
+        return 1u << static_cast<unsigned int>(severity);
+    }
+
+    static constexpr unsigned int all_severities = (1u << (static_cast<unsigned int>(severity::critical) + 1)) - 1;
+
+    /** Derived loggers narrow it down to the severities that actually have a listener
+     */
+    unsigned int _enabled_severities = all_severities;
+
+private:
+
+    static constexpr uint32_t keep_all = UINT32_MAX;
+
+    /** A message is kept if a 32-bit random number is below the threshold; keep_all keeps every one.
+     *  set_sampling may run while other threads log, so the thresholds are atomic.
+     */
+    std::array<std::atomic<uint32_t>, static_cast<size_t>(severity::critical) + 1> _sampling = sampling_keep_all();
+
+
+    logger& with_fields(
+        std::string const &message,
+        logger::severity severity,
+        std::initializer_list<log_field> fields) &
+    {
+        return should_log(severity) ? log(message, severity, fields) : *this;
+    }
+
+    static constexpr std::array<std::atomic<uint32_t>, static_cast<size_t>(severity::critical) + 1> sampling_keep_all() noexcept
+    {
+        static_assert(static_cast<size_t>(severity::critical) + 1 == 6, "one threshold per severity");
+        return {keep_all, keep_all, keep_all, keep_all, keep_all, keep_all};
+    }
+
+    static uint32_t sample_random() noexcept
+    {
+        // xorshift64, seeded per thread from the address of its state
+        thread_local uint64_t state = reinterpret_cast<uintptr_t>(&state) | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return static_cast<uint32_t>(state >> 32);
+    }
+
 protected:
 
     static std::string severity_to_string(
         logger::severity severity);
 
+    /** Text rendering of fields: " key=value" per field, appended in place
+     */
+    static void append_fields(
+        std::string &text,
+        std::span<const log_field> fields);
+
     static std::string current_datetime_to_string();
 
     static std::string current_date_to_string();
@@ -34,6 +34,129 @@ public:
     logger_guardant &critical_with_guard(
         std::string const &message) &;
 
+public:
+
+    /** Lazy overloads: the message is built only if a logger is attached and listens to the severity
+     */
+    template<std::invocable F>
+    logger_guardant &log_with_guard(
+        F &&make_message,
+        logger::severity severity) &
+    {
+        logger *got_logger = get_logger();
+        if (got_logger != nullptr && got_logger->should_log(severity))
+        {
+            got_logger->log(std::string(std::forward<F>(make_message)()), severity);
+        }
+
+        return *this;
+    }
+
+    template<std::invocable F>
+    logger_guardant &trace_with_guard(F &&make_message) & { return log_with_guard(std::forward<F>(make_message), logger::severity::trace); }
+
+    template<std::invocable F>
+    logger_guardant &debug_with_guard(F &&make_message) & { return log_with_guard(std::forward<F>(make_message), logger::severity::debug); }
+
+    template<std::invocable F>
+    logger_guardant &information_with_guard(F &&make_message) & { return log_with_guard(std::forward<F>(make_message), logger::severity::information); }
+
+    template<std::invocable F>
+    logger_guardant &warning_with_guard(F &&make_message) & { return log_with_guard(std::forward<F>(make_message), logger::severity::warning); }
+
+    template<std::invocable F>
+    logger_guardant &error_with_guard(F &&make_message) & { return log_with_guard(std::forward<F>(make_message), logger::severity::error); }
+
+    template<std::invocable F>
+    logger_guardant &critical_with_guard(F &&make_message) & { return log_with_guard(std::forward<F>(make_message), logger::severity::critical); }
+
+    /** Rate-limited overloads, message is a string or a callable producing one
+     */
+    template<class M>
+    logger_guardant &log_with_guard(
+        log_rate_limiter &limiter,
+        M &&message,
+        logger::severity severity) &
+    {
+        if (logger *got_logger = get_logger(); got_logger != nullptr)
+        {
+            got_logger->log(limiter, severity, std::forward<M>(message));
+        }
+
+        return *this;
+    }
+
+    template<class M>
+    logger_guardant &trace_with_guard(log_rate_limiter &limiter, M &&message) & { return log_with_guard(limiter, std::forward<M>(message), logger::severity::trace); }
+
+    template<class M>
+    logger_guardant &debug_with_guard(log_rate_limiter &limiter, M &&message) & { return log_with_guard(limiter, std::forward<M>(message), logger::severity::debug); }
+
+    template<class M>
+    logger_guardant &information_with_guard(log_rate_limiter &limiter, M &&message) & { return log_with_guard(limiter, std::forward<M>(message), logger::severity::information); }
+
+    template<class M>
+    logger_guardant &warning_with_guard(log_rate_limiter &limiter, M &&message) & { return log_with_guard(limiter, std::forward<M>(message), logger::severity::warning); }
+
+    template<class M>
+    logger_guardant &error_with_guard(log_rate_limiter &limiter, M &&message) & { return log_with_guard(limiter, std::forward<M>(message), logger::severity::error); }
+
+    template<class M>
+    logger_guardant &critical_with_guard(log_rate_limiter &limiter, M &&message) & { return log_with_guard(limiter, std::forward<M>(message), logger::severity::critical); }
+
+#if __has_include(<format>)
+    template<class... Args>
+    logger_guardant &format_with_guard(
+        logger::severity severity,
+        std::format_string<Args...> format,
+        Args &&...args) &
+    {
+        logger *got_logger = get_logger();
+        if (got_logger != nullptr && got_logger->should_log(severity))
+        {
+            got_logger->log(std::format(format, std::forward<Args>(args)...), severity);
+        }
+
+        return *this;
+    }
+
+    template<class Arg, class... Args>
+    logger_guardant &trace_with_guard(std::format_string<Arg, Args...> format, Arg &&arg, Args &&...args) &
+    {
+        return format_with_guard(logger::severity::trace, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<class Arg, class... Args>
+    logger_guardant &debug_with_guard(std::format_string<Arg, Args...> format, Arg &&arg, Args &&...args) &
+    {
+        return format_with_guard(logger::severity::debug, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<class Arg, class... Args>
+    logger_guardant &information_with_guard(std::format_string<Arg, Args...> format, Arg &&arg, Args &&...args) &
+    {
+        return format_with_guard(logger::severity::information, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<class Arg, class... Args>
+    logger_guardant &warning_with_guard(std::format_string<Arg, Args...> format, Arg &&arg, Args &&...args) &
+    {
+        return format_with_guard(logger::severity::warning, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<class Arg, class... Args>
+    logger_guardant &error_with_guard(std::format_string<Arg, Args...> format, Arg &&arg, Args &&...args) &
+    {
+        return format_with_guard(logger::severity::error, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<class Arg, class... Args>
+    logger_guardant &critical_with_guard(std::format_string<Arg, Args...> format, Arg &&arg, Args &&...args) &
+    {
+        return format_with_guard(logger::severity::critical, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+#endif
+
 protected:
 
     inline virtual logger *get_logger() const = 0;
@@ -0,0 +1,27 @@
+#include "../include/log_rate_limiter.h"
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+log_rate_limiter& log_rate_limiter::for_key(const std::string& key, double per_second, size_t burst)
+{
+    static std::shared_mutex registry_mutex;
+    static std::unordered_map<std::string, std::unique_ptr<log_rate_limiter>> registry;
+
+    {
+        std::shared_lock lock(registry_mutex);
+        if (auto it = registry.find(key); it != registry.end())
+        {
+            return *it->second;
+        }
+    }
+
+    std::unique_lock lock(registry_mutex);
+    auto& limiter = registry[key];
+    if (!limiter)
+    {
+        limiter = std::make_unique<log_rate_limiter>(per_second, burst, key);
+    }
+    return *limiter;
+}
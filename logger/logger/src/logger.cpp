@@ -1,41 +1,114 @@
 #include "../include/logger.h"
+#include <algorithm>
+#include <charconv>
 #include <iomanip>
 #include <sstream>
 
 logger & logger::trace(
     std::string const &message) &
 {
-    return log(message, logger::severity::trace);
+    return should_log(logger::severity::trace) ? log(message, logger::severity::trace) : *this;
 }
 
 logger &logger::debug(
     std::string const &message) &
 {
-    return log(message, logger::severity::debug);
+    return should_log(logger::severity::debug) ? log(message, logger::severity::debug) : *this;
 }
 
 logger &logger::information(
     std::string const &message) &
 {
-    return log(message, logger::severity::information);
+    return should_log(logger::severity::information) ? log(message, logger::severity::information) : *this;
 }
 
 logger &logger::warning(
     std::string const &message) &
 {
-    return log(message, logger::severity::warning);
+    return should_log(logger::severity::warning) ? log(message, logger::severity::warning) : *this;
 }
 
 logger & logger::error(
     std::string const &message) &
 {
-    return log(message, logger::severity::error);
+    return should_log(logger::severity::error) ? log(message, logger::severity::error) : *this;
 }
 
 logger &logger::critical(
     std::string const &message) &
 {
-    return log(message, logger::severity::critical);
+    return should_log(logger::severity::critical) ? log(message, logger::severity::critical) : *this;
+}
+
+logger &logger::log(
+    std::string const &message,
+    logger::severity severity,
+    std::span<const log_field> fields) &
+{
+    std::string text = message;
+    append_fields(text, fields);
+    return log(text, severity);
+}
+
+void logger::append_fields(
+    std::string &text,
+    std::span<const log_field> fields)
+{
+    for (const auto &field : fields)
+    {
+        text.push_back(' ');
+        text.append(field.key);
+        text.push_back('=');
+
+        std::visit([&text](auto value) {
+            using type = decltype(value);
+            if constexpr (std::is_same_v<type, std::string_view>)
+            {
+                text.append(value);
+            }
+            else if constexpr (std::is_same_v<type, bool>)
+            {
+                text.append(value ? "true" : "false");
+            }
+            else
+            {
+                char buffer[32];
+                auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                text.append(buffer, end);
+            }
+        }, field.value);
+    }
+}
+
+logger::logger(
+    logger const &other) noexcept
+    : _enabled_severities(other._enabled_severities)
+{
+    for (size_t i = 0; i < _sampling.size(); ++i)
+    {
+        _sampling[i].store(other._sampling[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+logger& logger::operator=(
+    logger const &other) noexcept
+{
+    _enabled_severities = other._enabled_severities;
+    for (size_t i = 0; i < _sampling.size(); ++i)
+    {
+        _sampling[i].store(other._sampling[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    return *this;
+}
+
+void logger::set_sampling(
+    logger::severity severity,
+    double probability) noexcept
+{
+    probability = std::clamp(probability, 0.0, 1.0);
+    const auto threshold = static_cast<uint64_t>(probability * static_cast<double>(uint64_t(1) << 32));
+    _sampling[static_cast<size_t>(severity)].store(static_cast<uint32_t>(std::min<uint64_t>(threshold, keep_all)),
+                                                   std::memory_order_relaxed);
 }
 
 std::string logger::severity_to_string(
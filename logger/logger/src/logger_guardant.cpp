@@ -5,7 +5,7 @@ logger_guardant &logger_guardant::log_with_guard(
     logger::severity severity) &
 {
     logger *got_logger = get_logger();
-    if (got_logger != nullptr)
+    if (got_logger != nullptr && got_logger->should_log(severity))
     {
         got_logger->log(message, severity);
     }
@@ -1,22 +1,22 @@
 #ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_SERVER_LOGGER_H
 #define MATH_PRACTICE_AND_OPERATING_SYSTEMS_SERVER_LOGGER_H
 
-#define CPPHTTPLIB_NO_COMPRESSION
 #include <logger.h>
 #include <unordered_map>
-#include <httplib.h>
+#include <memory>
 #include <string>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
 #include <map>
+#include "server_logger_transport.h"
 
 class server_logger_builder;
 class server_logger final:
     public logger
 {
 private:
-    httplib::Client _client;
+    std::unique_ptr<server_logger_transport> _transport;
     std::string _destination;
     std::string _format;
     std::unordered_map<logger::severity, std::pair<std::string, bool>> _streams;
@@ -46,10 +46,17 @@ public:
     
     server_logger &operator=(server_logger &&other) noexcept;
 
-    
+
+    using logger::log;
+
     [[nodiscard]] logger& log(
         const std::string &message,
         logger::severity severity) & override;
+
+    [[nodiscard]] logger& log(
+        const std::string &message,
+        logger::severity severity,
+        std::span<const log_field> fields) & override;
 };
 
 #endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_SERVER_LOGGER_H
\ No newline at end of file
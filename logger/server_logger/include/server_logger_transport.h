@@ -0,0 +1,30 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_SERVER_LOGGER_TRANSPORT_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_SERVER_LOGGER_TRANSPORT_H
+
+#include <memory>
+#include <string>
+
+/** Delivers serialized server_logger records to the collector. The scheme of the destination picks the transport:
+ *  "http://host:port" (default) - POST /log through httplib,
+ *  "unix:///path/to/socket" - one SOCK_SEQPACKET datagram per record,
+ *  "shm://name" - shm_log_ring created by the collector; the ring is single-producer, so only one process
+ *  may log to a name, its loggers share the ring under a mutex; a restarted collector's ring is picked up within
+ *  100 ms, immediately if the old one shut down cleanly.
+ *  Connections are established lazily, so a logger can be built before the collector is up.
+ */
+class server_logger_transport
+{
+public:
+
+    virtual ~server_logger_transport() noexcept = default;
+
+    /** Throws std::runtime_error if the record could not be delivered
+     */
+    virtual void send(const std::string& payload) = 0;
+
+    static std::unique_ptr<server_logger_transport> make(const std::string& destination);
+
+    static bool supports(const std::string& destination) noexcept;
+};
+
+#endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_SERVER_LOGGER_TRANSPORT_H
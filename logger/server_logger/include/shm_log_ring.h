@@ -0,0 +1,330 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_SHM_LOG_RING_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_SHM_LOG_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/** Single-producer single-consumer byte ring in POSIX shared memory, the wire format of "shm://name" destinations.
+ *  The collector creates the segment, server_logger opens it. Records are a 4-byte length followed by the payload,
+ *  padded to 8 bytes; a record that does not fit before the end of the buffer is preceded by a wrap marker.
+ *  head and tail count bytes ever written/read, so the free space is capacity - (head - tail).
+ *  A restarted collector creates a new segment under the same name; see abandoned() for how producers notice.
+ */
+class shm_log_ring final
+{
+public:
+
+    static constexpr uint64_t magic = 0x31474c534f504d; // "MPOSLG1"
+
+    static constexpr size_t default_capacity = 1 << 20;
+
+    struct header
+    {
+        uint64_t magic;
+        uint64_t capacity;
+        std::atomic<uint64_t> closed; // set by the collector before it unlinks the segment
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<uint64_t> tail;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring is shared between processes");
+
+private:
+
+    static constexpr uint32_t wrap_marker = UINT32_MAX;
+
+    header* _header = nullptr;
+    char* _data = nullptr;
+    size_t _mapped = 0;
+    uint64_t _capacity = 0; // the other side can write the header, so each side keeps its own copy
+    uint64_t _device = 0;
+    uint64_t _inode = 0;
+    std::string _name;
+    bool _owner = false;
+
+    static constexpr uint64_t record_size(size_t length) noexcept
+    {
+        return (sizeof(uint32_t) + length + 7) & ~uint64_t(7);
+    }
+
+    static std::string shm_name(const std::string& name)
+    {
+        return name.starts_with('/') ? name : "/" + name;
+    }
+
+#ifndef _WIN32
+    void map(int fd, size_t size)
+    {
+        struct stat status{};
+        void* mapping = fstat(fd, &status) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        int error = errno;
+        ::close(fd);
+
+        if (mapping == MAP_FAILED)
+        {
+            throw std::runtime_error("Failed to map shared memory " + _name + ": " + std::strerror(error));
+        }
+
+        _mapped = size;
+        _device = status.st_dev;
+        _inode = status.st_ino;
+        _header = static_cast<header*>(mapping);
+        _data = static_cast<char*>(mapping) + sizeof(header);
+    }
+#endif
+
+    shm_log_ring() = default;
+
+public:
+
+    /** Collector side: (re)creates the segment; capacity is rounded up to a power of two
+     */
+    static shm_log_ring create(const std::string& name, size_t capacity = default_capacity)
+    {
+        shm_log_ring ring;
+        ring._name = shm_name(name);
+
+#ifndef _WIN32
+        uint64_t rounded = 64;
+        while (rounded < capacity)
+        {
+            rounded <<= 1;
+        }
+
+        shm_unlink(ring._name.c_str());
+        int fd = shm_open(ring._name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd == -1 || ftruncate(fd, static_cast<off_t>(sizeof(header) + rounded)) != 0)
+        {
+            int error = errno;
+            if (fd != -1) ::close(fd);
+            throw std::runtime_error("Failed to create shared memory " + ring._name + ": " + std::strerror(error));
+        }
+
+        ring.map(fd, sizeof(header) + rounded);
+        ring._owner = true;
+
+        ring._capacity = rounded;
+        ring._header->capacity = rounded;
+        ring._header->head.store(0);
+        ring._header->tail.store(0);
+        std::atomic_thread_fence(std::memory_order_release);
+        ring._header->magic = magic;
+#else
+        throw std::runtime_error("Shared memory log rings are not supported on this platform: " + ring._name);
+#endif
+
+        return ring;
+    }
+
+    /** Producer side: attaches to a segment created by the collector
+     */
+    static shm_log_ring open(const std::string& name)
+    {
+        shm_log_ring ring;
+        ring._name = shm_name(name);
+
+#ifndef _WIN32
+        int fd = shm_open(ring._name.c_str(), O_RDWR, 0);
+        if (fd == -1)
+        {
+            throw std::runtime_error("Failed to open shared memory " + ring._name + ": " + std::strerror(errno));
+        }
+
+        off_t size = lseek(fd, 0, SEEK_END);
+        if (size < static_cast<off_t>(sizeof(header)))
+        {
+            ::close(fd);
+            throw std::runtime_error("Shared memory " + ring._name + " is not a log ring");
+        }
+
+        ring.map(fd, static_cast<size_t>(size));
+
+        ring._capacity = ring._header->capacity;
+        if (ring._header->magic != magic || sizeof(header) + ring._capacity != ring._mapped ||
+            ring._capacity < 64 || (ring._capacity & (ring._capacity - 1)) != 0)
+        {
+            throw std::runtime_error("Shared memory " + ring._name + " is not a log ring");
+        }
+#else
+        throw std::runtime_error("Shared memory log rings are not supported on this platform: " + ring._name);
+#endif
+
+        return ring;
+    }
+
+    shm_log_ring(const shm_log_ring&) = delete;
+    shm_log_ring& operator=(const shm_log_ring&) = delete;
+
+    shm_log_ring(shm_log_ring&& other) noexcept :
+        _header(std::exchange(other._header, nullptr)),
+        _data(std::exchange(other._data, nullptr)),
+        _mapped(std::exchange(other._mapped, 0)),
+        _capacity(std::exchange(other._capacity, 0)),
+        _device(std::exchange(other._device, 0)),
+        _inode(std::exchange(other._inode, 0)),
+        _name(std::move(other._name)),
+        _owner(std::exchange(other._owner, false))
+    {
+    }
+
+    shm_log_ring& operator=(shm_log_ring&&) = delete;
+
+    ~shm_log_ring() noexcept
+    {
+#ifndef _WIN32
+        if (_owner && _header != nullptr)
+        {
+            _header->closed.store(1, std::memory_order_release);
+        }
+        if (_header != nullptr)
+        {
+            munmap(_header, _mapped);
+        }
+        if (_owner)
+        {
+            shm_unlink(_name.c_str());
+        }
+#endif
+    }
+
+    /** Returns false without blocking if the ring is full or the record can never fit
+     */
+    bool push(std::string_view record) noexcept
+    {
+        const uint64_t capacity = _capacity;
+        const uint64_t size = record_size(record.size());
+        if (size > capacity / 2)
+        {
+            return false;
+        }
+
+        uint64_t head = _header->head.load(std::memory_order_relaxed);
+        const uint64_t tail = _header->tail.load(std::memory_order_acquire);
+
+        uint64_t position = head & (capacity - 1);
+        const uint64_t until_end = capacity - position;
+        const uint64_t needed = size <= until_end ? size : until_end + size;
+
+        if (head - tail + needed > capacity)
+        {
+            return false;
+        }
+
+        if (size > until_end)
+        {
+            std::memcpy(_data + position, &wrap_marker, sizeof(wrap_marker));
+            head += until_end;
+            position = 0;
+        }
+
+        const auto length = static_cast<uint32_t>(record.size());
+        std::memcpy(_data + position, &length, sizeof(length));
+        std::memcpy(_data + position + sizeof(length), record.data(), record.size());
+
+        _header->head.store(head + size, std::memory_order_release);
+        return true;
+    }
+
+    /** Returns false if the ring is empty. Throws std::runtime_error if the producer left a length or head no record
+     *  of push could have, after skipping everything written so far
+     */
+    bool pop(std::string& record)
+    {
+        const uint64_t capacity = _capacity;
+
+        uint64_t tail = _header->tail.load(std::memory_order_relaxed);
+        const uint64_t head = _header->head.load(std::memory_order_acquire);
+        if (tail == head)
+        {
+            return false;
+        }
+
+        const auto corrupted = [&]() {
+            _header->tail.store(head, std::memory_order_release);
+            return std::runtime_error("Shared memory ring " + _name + " is corrupted, unread records dropped");
+        };
+
+        if (head - tail > capacity || head - tail < sizeof(uint32_t))
+        {
+            throw corrupted();
+        }
+
+        uint64_t position = tail & (capacity - 1);
+        uint32_t length;
+        std::memcpy(&length, _data + position, sizeof(length));
+
+        if (length == wrap_marker)
+        {
+            if (capacity - position + sizeof(uint32_t) > head - tail)
+            {
+                throw corrupted();
+            }
+            tail += capacity - position;
+            position = 0;
+            std::memcpy(&length, _data, sizeof(length));
+        }
+
+        if (length > capacity / 2 || record_size(length) > head - tail || position + record_size(length) > capacity)
+        {
+            throw corrupted();
+        }
+
+        record.assign(_data + position + sizeof(length), length);
+
+        _header->tail.store(tail + record_size(length), std::memory_order_release);
+        return true;
+    }
+
+    /** Producer side: true once the collector has closed the segment; a single load, cheap enough for every record
+     */
+    [[nodiscard]] bool closed() const noexcept
+    {
+        return _header->closed.load(std::memory_order_acquire) != 0;
+    }
+
+    /** Producer side: true if the collector has closed the segment or the name no longer refers to it, as after
+     *  the collector crashed and was restarted. Looks the name up, so callers do it now and then rather than per record
+     */
+    [[nodiscard]] bool abandoned() const noexcept
+    {
+        if (closed())
+        {
+            return true;
+        }
+
+#ifndef _WIN32
+        int fd = shm_open(_name.c_str(), O_RDONLY, 0);
+        if (fd == -1)
+        {
+            return errno == ENOENT;
+        }
+
+        struct stat status{};
+        const bool replaced = fstat(fd, &status) != 0 || status.st_dev != _device || status.st_ino != _inode;
+        ::close(fd);
+        return replaced;
+#else
+        return false;
+#endif
+    }
+
+    [[nodiscard]] const std::string& name() const noexcept
+    {
+        return _name;
+    }
+};
+
+#endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_SHM_LOG_RING_H
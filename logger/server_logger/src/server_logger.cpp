@@ -1,7 +1,6 @@
 #include <not_implemented.h>
-#include <httplib.h>
 #include "../include/server_logger.h"
-#include <nlohmann/json.hpp>
+#include <json_writer.h>
 #include <regex>
 #include <fstream>
 #include <stdexcept>
@@ -68,16 +67,6 @@ namespace {
         return format.find('%') != std::string::npos;
     }
 
-    bool validate_url(const std::string& url) {
-
-        if (url.empty()) {
-            return false;
-        }
-        
-
-        return url.substr(0, 7) == "http://" || url.substr(0, 8) == "https://";
-    }
-    
 
     std::string convert_severity_for_server(const std::string& severity) {
         if (severity == "INFORMATION") {
@@ -96,6 +85,14 @@ logger& server_logger::log(
     const std::string &message,
     const logger::severity severity) &
 {
+    return log(message, severity, std::span<const log_field>());
+}
+
+logger& server_logger::log(
+    const std::string &message,
+    const logger::severity severity,
+    std::span<const log_field> fields) &
+{
 
     if (message.empty()) {
         std::cerr << "Warning: Empty log message" << std::endl;
@@ -119,50 +116,49 @@ logger& server_logger::log(
 
         std::string server_severity = convert_severity_for_server(severity_to_string(severity));
 
+        // The payload buffer keeps its capacity between records, so encoding it does not allocate
+        thread_local std::string payload;
+        payload.clear();
 
-        nlohmann::json payload;
-        try {
-            payload = {
-                {"pid", inner_getpid()},
-                {"severity", server_severity},
-                {"message", formatted},
-                {"streams", nlohmann::json::array()}
-            };
-        } catch (const nlohmann::json::exception& e) {
-            std::cerr << "Error creating JSON payload: " << e.what() << std::endl;
-            throw;
-        }
-
+        json_writer json(payload);
+        json.begin_object()
+            .key("pid").value(inner_getpid())
+            .key("severity").value(server_severity)
+            .key("message").value(formatted)
+            .key("streams").begin_array();
 
         if (const auto it = _streams.find(severity); it != _streams.end()) {
             const auto& [path, is_console] = it->second;
 
 
             if (is_console) {
-                payload["streams"].push_back({{"type", "console"}});
+                json.begin_object().key("type").value("console").end_object();
                 std::cout << formatted << std::endl;
             }
 
 
             if (!path.empty()) {
-                payload["streams"].push_back({
-                    {"type", "file"},
-                    {"path", path}
-                });
+                json.begin_object().key("type").value("file").key("path").value(path).end_object();
             }
         }
 
+        json.end_array();
 
-        try {
-            _client.set_connection_timeout(2);
-
-            if (auto res = _client.Post("/log", payload.dump(), "application/json"); !res) {
-                std::cerr << "HTTP error: " << httplib::to_string(res.error()) << std::endl;
-            } else if (res->status != 200) {
-                std::cerr << "Server error: Status " << res->status << ", Body: " << res->body << std::endl;
+        if (!fields.empty()) {
+            json.key("fields").begin_object();
+            for (const auto& field : fields) {
+                json.field(field);
             }
+            json.end_object();
+        }
+
+        json.end_object();
+
+
+        try {
+            _transport->send(payload);
         } catch (const std::exception& e) {
-            std::cerr << "Exception during HTTP request: " << e.what() << std::endl;
+            std::cerr << "Error sending log record to " << _destination << ": " << e.what() << std::endl;
         }
     } catch (const std::exception& e) {
         std::cerr << "Logger error: " << e.what() << std::endl;
@@ -175,28 +171,19 @@ logger& server_logger::log(
 server_logger::server_logger(const std::string& dest,
                              const std::string& format,
                              const std::unordered_map<logger::severity, std::pair<std::string, bool>> &streams)
-    : _client(dest.c_str()),
+    : _transport(server_logger_transport::make(dest)),
       _destination(dest),
       _format(format),
       _streams(streams)
 {
 
-    if (!validate_url(_destination)) {
+    if (!server_logger_transport::supports(_destination)) {
         std::cerr << "Warning: Invalid server URL format: " << _destination << std::endl;
     }
 
     if (!validate_format(_format)) {
         std::cerr << "Warning: Format string may not contain valid format specifiers" << std::endl;
     }
-
-
-    _client.set_connection_timeout(2);
-    _client.set_read_timeout(5);
-    
-
-    _client.set_default_headers({
-        {"User-Agent", "ServerLogger/1.0"}
-    });
 }
 
 int server_logger::inner_getpid()
@@ -209,39 +196,29 @@ int server_logger::inner_getpid()
 }
 
 server_logger::server_logger(const server_logger &other)
-    : _client(other._destination),
+    : logger(other),
+      _transport(server_logger_transport::make(other._destination)),
       _destination(other._destination),
       _format(other._format),
       _streams(other._streams)
 {
-
-    _client.set_connection_timeout(2);
-    _client.set_read_timeout(5);
-    _client.set_default_headers({
-        {"User-Agent", "ServerLogger/1.0"}
-    });
 }
 
 server_logger &server_logger::operator=(const server_logger &other)
 {
     if (this != &other) {
+        logger::operator=(other);
         _destination = other._destination;
-        _client = httplib::Client(_destination);
+        _transport = server_logger_transport::make(_destination);
         _format = other._format;
         _streams = other._streams;
-        
-
-        _client.set_connection_timeout(2);
-        _client.set_read_timeout(5);
-        _client.set_default_headers({
-            {"User-Agent", "ServerLogger/1.0"}
-        });
     }
     return *this;
 }
 
 server_logger::server_logger(server_logger &&other) noexcept
-    : _client(std::move(other._client)),
+    : logger(other),
+      _transport(std::move(other._transport)),
       _destination(std::move(other._destination)),
       _format(std::move(other._format)),
       _streams(std::move(other._streams))
@@ -252,8 +229,9 @@ server_logger::server_logger(server_logger &&other) noexcept
 server_logger &server_logger::operator=(server_logger &&other) noexcept
 {
     if (this != &other) {
+        logger::operator=(other);
         _destination = std::move(other._destination);
-        _client = std::move(other._client);
+        _transport = std::move(other._transport);
         _format = std::move(other._format);
         _streams = std::move(other._streams);
     }
@@ -10,17 +10,7 @@ namespace {
 
     bool is_valid_url(const std::string& url) {
 
-        if (url.empty()) {
-            return false;
-        }
-        
-
-        if (url.substr(0, 7) != "http://" && url.substr(0, 8) != "https://") {
-            return false;
-        }
-        
-
-        return true;
+        return server_logger_transport::supports(url);
     }
 
 
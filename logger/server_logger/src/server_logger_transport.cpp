@@ -0,0 +1,233 @@
+#define CPPHTTPLIB_NO_COMPRESSION
+#include <httplib.h>
+#include "../include/server_logger_transport.h"
+#include "../include/shm_log_ring.h"
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr std::string_view unix_scheme = "unix://";
+    constexpr std::string_view shm_scheme = "shm://";
+
+    class http_transport final : public server_logger_transport
+    {
+        httplib::Client _client;
+
+    public:
+
+        explicit http_transport(const std::string& destination) : _client(destination)
+        {
+            _client.set_connection_timeout(2);
+            _client.set_read_timeout(5);
+            _client.set_default_headers({
+                {"User-Agent", "ServerLogger/1.0"}
+            });
+        }
+
+        void send(const std::string& payload) override
+        {
+            auto res = _client.Post("/log", payload, "application/json");
+            if (!res)
+            {
+                throw std::runtime_error("HTTP error: " + httplib::to_string(res.error()));
+            }
+            if (res->status != 200)
+            {
+                throw std::runtime_error("Server error: Status " + std::to_string(res->status) + ", Body: " + res->body);
+            }
+        }
+    };
+
+#ifndef _WIN32
+    class unix_transport final : public server_logger_transport
+    {
+        std::string _path;
+        int _fd = -1;
+
+        void connect()
+        {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if (_path.size() >= sizeof(address.sun_path))
+            {
+                throw std::runtime_error("Unix socket path is too long: " + _path);
+            }
+            std::memcpy(address.sun_path, _path.c_str(), _path.size() + 1);
+
+            _fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+            if (_fd == -1 || ::connect(_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+            {
+                int error = errno;
+                disconnect();
+                throw std::runtime_error("Failed to connect to " + _path + ": " + std::strerror(error));
+            }
+        }
+
+        void disconnect() noexcept
+        {
+            if (_fd != -1)
+            {
+                ::close(_fd);
+                _fd = -1;
+            }
+        }
+
+    public:
+
+        explicit unix_transport(std::string path) : _path(std::move(path))
+        {
+        }
+
+        void send(const std::string& payload) override
+        {
+            // A collector restart leaves a dead socket behind: reconnect once before giving up on the record
+            for (int attempt = 0; attempt < 2; ++attempt)
+            {
+                if (_fd == -1)
+                {
+                    connect();
+                }
+
+                if (::send(_fd, payload.data(), payload.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(payload.size()))
+                {
+                    return;
+                }
+
+                int error = errno;
+                disconnect();
+                if (error != EPIPE && error != ECONNRESET && error != ENOTCONN)
+                {
+                    throw std::runtime_error("Failed to send to " + _path + ": " + std::strerror(error));
+                }
+            }
+
+            throw std::runtime_error("Collector closed the connection: " + _path);
+        }
+
+        ~unix_transport() noexcept override
+        {
+            disconnect();
+        }
+    };
+#endif
+
+    /** The ring has a single producer side, so all loggers of the process writing to one name share it
+     */
+    struct shared_ring
+    {
+        std::mutex mut;
+        std::optional<shm_log_ring> ring;
+        std::chrono::steady_clock::time_point checked;
+    };
+
+    std::mutex rings_mutex;
+    std::unordered_map<std::string, std::weak_ptr<shared_ring>> rings;
+
+    class shm_transport final : public server_logger_transport
+    {
+        static constexpr std::chrono::milliseconds check_interval{100};
+
+        std::string _name;
+        std::shared_ptr<shared_ring> _shared;
+
+    public:
+
+        explicit shm_transport(std::string name) : _name(std::move(name))
+        {
+            std::lock_guard lock(rings_mutex);
+
+            if (auto it = rings.find(_name); it != rings.end())
+            {
+                _shared = it->second.lock();
+            }
+
+            if (!_shared)
+            {
+                std::erase_if(rings, [](const auto& item) { return item.second.expired(); });
+                _shared = std::make_shared<shared_ring>();
+                rings[_name] = _shared;
+            }
+        }
+
+        void send(const std::string& payload) override
+        {
+            std::lock_guard lock(_shared->mut);
+
+            // A restarted collector recreates the segment: records pushed into the old mapping would never be read
+            const auto now = std::chrono::steady_clock::now();
+            if (_shared->ring && (_shared->ring->closed() ||
+                                  (now - _shared->checked > check_interval && _shared->ring->abandoned())))
+            {
+                _shared->ring.reset();
+            }
+
+            if (!_shared->ring)
+            {
+                _shared->ring.emplace(shm_log_ring::open(_name));
+            }
+            if (now - _shared->checked > check_interval)
+            {
+                _shared->checked = now;
+            }
+
+            // A full ring means the collector is behind: give it a moment before dropping the record
+            auto deadline = now + std::chrono::milliseconds(100);
+            while (!_shared->ring->push(payload))
+            {
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    // or that it is gone, in which case the record goes to its successor
+                    if (_shared->ring->abandoned())
+                    {
+                        _shared->ring.emplace(shm_log_ring::open(_name));
+                        _shared->checked = std::chrono::steady_clock::now();
+                        if (_shared->ring->push(payload))
+                        {
+                            return;
+                        }
+                    }
+                    throw std::runtime_error("Shared memory ring " + _name + " is full, record dropped");
+                }
+                std::this_thread::yield();
+            }
+        }
+    };
+}
+
+std::unique_ptr<server_logger_transport> server_logger_transport::make(const std::string& destination)
+{
+    if (destination.starts_with(unix_scheme))
+    {
+#ifndef _WIN32
+        return std::make_unique<unix_transport>(destination.substr(unix_scheme.size()));
+#else
+        throw std::runtime_error("Unix socket destinations are not supported on this platform: " + destination);
+#endif
+    }
+
+    if (destination.starts_with(shm_scheme))
+    {
+        return std::make_unique<shm_transport>(destination.substr(shm_scheme.size()));
+    }
+
+    return std::make_unique<http_transport>(destination);
+}
+
+bool server_logger_transport::supports(const std::string& destination) noexcept
+{
+    return destination.starts_with("http://") || destination.starts_with("https://") ||
+           (destination.starts_with(unix_scheme) && destination.size() > unix_scheme.size()) ||
+           (destination.starts_with(shm_scheme) && destination.size() > shm_scheme.size());
+}
@@ -4,62 +4,188 @@
 
 #include "server.h"
 #include <logger_builder.h>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <boost/asio/thread_pool.hpp>
-#include <boost/asio/post.hpp>
+#include <iterator>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 
 using json = nlohmann::json;
 
-server::server(uint16_t port)
+server::file_writer::file_writer(const std::string& path) : _stream(path, std::ios::app)
 {
+    if (!_stream.is_open())
+    {
+        throw std::runtime_error("Failed to open log file: " + path);
+    }
 
-    CROW_ROUTE(app, "/log")
-        .methods("POST"_method)
-        ([this](const crow::request& req) {
-            std::lock_guard<std::mutex> lock(_mut);
+    _worker = std::thread(&file_writer::work, this);
+}
 
-            try {
-                auto data = json::parse(req.body);
+void server::file_writer::push(std::string line)
+{
+    {
+        std::lock_guard lock(_mut);
+        _pending.push_back(std::move(line));
+    }
+    _cv.notify_one();
+}
+
+void server::file_writer::work()
+{
+    std::vector<std::string> batch;
 
-                std::cout << "=== Received full JSON ===" << std::endl;
-                std::cout << data.dump(2) << std::endl;
-                std::cout << "=== End JSON ===" << std::endl;
+    while (true)
+    {
+        {
+            std::unique_lock lock(_mut);
+            _cv.wait(lock, [this] { return _stopped || !_pending.empty(); });
 
+            if (_pending.empty() && _stopped)
+            {
+                return;
+            }
 
-                int pid = data["pid"];
-                std::string severity_str = data["severity"];
-                std::string message = data["message"];
-                auto streams = data["streams"];
+            batch.swap(_pending);
+        }
 
+        for (auto& line : batch)
+        {
+            _stream << line << '\n';
+        }
+        _stream.flush();
 
-                logger::severity sev;
-                if (severity_str == "TRACE") sev = logger::severity::trace;
-                else if (severity_str == "DEBUG") sev = logger::severity::debug;
-                else if (severity_str == "INFO") sev = logger::severity::information;
-                else if (severity_str == "WARNING") sev = logger::severity::warning;
-                else if (severity_str == "ERROR") sev = logger::severity::error;
-                else if (severity_str == "CRITICAL") sev = logger::severity::critical;
-                else return crow::response(400, "Invalid severity");
+        batch.clear();
+    }
+}
 
+server::file_writer::~file_writer() noexcept
+{
+    {
+        std::lock_guard lock(_mut);
+        _stopped = true;
+    }
+    _cv.notify_one();
+
+    if (_worker.joinable())
+    {
+        _worker.join();
+    }
+}
+
+server::file_writer& server::get_writer(const std::string& path)
+{
+    {
+        std::shared_lock lock(_writers_mut);
+        if (auto it = _writers.find(path); it != _writers.end())
+        {
+            return *it->second;
+        }
+    }
 
-                for (const auto& stream : streams)
+    std::unique_lock lock(_writers_mut);
+    auto& writer = _writers[path];
+    if (!writer)
+    {
+        writer = std::make_unique<file_writer>(path);
+    }
+    return *writer;
+}
+
+logger::severity server::parse_severity(const std::string& severity_str)
+{
+    if (severity_str == "TRACE") return logger::severity::trace;
+    if (severity_str == "DEBUG") return logger::severity::debug;
+    if (severity_str == "INFO" || severity_str == "INFORMATION") return logger::severity::information;
+    if (severity_str == "WARN" || severity_str == "WARNING") return logger::severity::warning;
+    if (severity_str == "ERROR") return logger::severity::error;
+    if (severity_str == "CRITICAL") return logger::severity::critical;
+
+    throw std::out_of_range("Invalid severity: " + severity_str);
+}
+
+void server::handle_record(const json& record)
+{
+    parse_severity(record.at("severity").get<std::string>());
+
+    const auto& message = record.at("message").get_ref<const std::string&>();
+
+    for (const auto& stream : record.at("streams"))
+    {
+        const auto& type = stream.at("type").get_ref<const std::string&>();
+        if (type == "file")
+        {
+            get_writer(stream.at("path").get<std::string>()).push(message);
+        }
+        else if (type == "console")
+        {
+            std::lock_guard lock(_console_mut);
+            std::cout << message << '\n';
+        }
+    }
+}
+
+server::server(uint16_t port, uint16_t concurrency) : _port(port), _concurrency(concurrency == 0 ? 1 : concurrency)
+{
+    app.loglevel(crow::LogLevel::Warning);
+
+    CROW_ROUTE(app, "/log")
+        .methods("POST"_method)
+        ([this](const crow::request& req) {
+            try
+            {
+                handle_record(json::parse(req.body));
+                return crow::response(200);
+            }
+            catch (const json::exception& e)
+            {
+                return crow::response(400, "JSON parse error: " + std::string(e.what()));
+            }
+            catch (const std::out_of_range& e)
+            {
+                return crow::response(400, e.what());
+            }
+            catch (const std::exception& e)
+            {
+                return crow::response(500, "Server error: " + std::string(e.what()));
+            }
+        });
+
+    CROW_ROUTE(app, "/log/batch")
+        .methods("POST"_method)
+        ([this](const crow::request& req) {
+            try
+            {
+                auto data = json::parse(req.body);
+                if (!data.is_array())
                 {
-                    std::string type = stream["type"];
-                    if (type == "file")
-                    {
+                    return crow::response(400, "Batch must be a JSON array of records");
+                }
 
-                         std::string path = stream["path"];
-                         std::ofstream file(path, std::ios::app);
-                         if (file) file << message << "\n";
+                size_t rejected = 0;
+                for (const auto& record : data)
+                {
+                    try
+                    {
+                        handle_record(record);
                     }
-                    else if (type == "console")
+                    catch (const json::exception&)
                     {
-                        std::cout << message << std::endl;
+                        ++rejected;
+                    }
+                    catch (const std::out_of_range&)
+                    {
+                        ++rejected;
                     }
                 }
 
-                return crow::response(200);
+                json result = {{"accepted", data.size() - rejected}, {"rejected", rejected}};
+                return crow::response(rejected == 0 ? 200 : 207, result.dump());
             }
             catch (const json::exception& e)
             {
@@ -70,7 +196,260 @@ server::server(uint16_t port)
                 return crow::response(500, "Server error: " + std::string(e.what()));
             }
         });
+}
 
+void server::run()
+{
+    app.port(_port).concurrency(_concurrency).run();
+}
+
+void server::wait_for_start()
+{
+    app.wait_for_server_start();
+}
+
+void server::stop()
+{
+    app.stop();
+}
+
+void server::handle_payload(const std::string& payload)
+{
+    try
+    {
+        handle_record(json::parse(payload));
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Rejected log record: " << e.what() << std::endl;
+    }
+}
+
+void server::listen_unix(const std::string& path)
+{
+#ifndef _WIN32
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error("Unix socket path is too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    ::unlink(path.c_str());
+
+    _unix_fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (_unix_fd == -1 ||
+        ::bind(_unix_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(_unix_fd, SOMAXCONN) != 0)
+    {
+        throw std::runtime_error("Failed to listen on " + path + ": " + std::strerror(errno));
+    }
+
+    _unix_path = path;
+
+    std::lock_guard lock(_connections_mut);
+    _listeners.emplace_back(&server::accept_unix, this);
+#else
+    throw std::runtime_error("Unix socket collection is not supported on this platform");
+#endif
+}
+
+void server::accept_unix()
+{
+#ifndef _WIN32
+    while (true)
+    {
+        int connection = ::accept4(_unix_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (connection == -1)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            return;
+        }
+
+        std::vector<std::thread> retired;
+        {
+            std::lock_guard lock(_connections_mut);
+            retired.swap(_retired);
+
+            if (!_transports_stopped)
+            {
+                _receivers.emplace(connection, std::thread(&server::receive_unix, this, connection));
+                connection = -1;
+            }
+        }
+
+        for (auto& receiver : retired)
+        {
+            receiver.join();
+        }
+
+        // Accepted after stop_transports: what the client has already sent is handled here
+        if (connection != -1)
+        {
+            ::shutdown(connection, SHUT_RD);
+            drain_unix(connection);
+            ::close(connection);
+        }
+    }
+#endif
+}
+
+void server::receive_unix(int connection)
+{
+#ifndef _WIN32
+    drain_unix(connection);
+
+    std::lock_guard lock(_connections_mut);
+    ::close(connection);
 
-    app.port(port).run();
-}
\ No newline at end of file
+    // Missing once stop_transports has taken the receivers to join them
+    if (auto it = _receivers.find(connection); it != _receivers.end())
+    {
+        _retired.push_back(std::move(it->second));
+        _receivers.erase(it);
+    }
+#endif
+}
+
+void server::drain_unix(int connection)
+{
+#ifndef _WIN32
+    std::string payload;
+
+    while (true)
+    {
+        // MSG_TRUNC with MSG_PEEK reports the size of the next datagram without consuming it
+        ssize_t size = ::recv(connection, nullptr, 0, MSG_PEEK | MSG_TRUNC);
+        if (size <= 0)
+        {
+            if (size == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+
+        payload.resize(static_cast<size_t>(size));
+        size = ::recv(connection, payload.data(), payload.size(), 0);
+        if (size <= 0)
+        {
+            return;
+        }
+        payload.resize(static_cast<size_t>(size));
+
+        handle_payload(payload);
+    }
+#endif
+}
+
+void server::listen_shm(const std::string& name, size_t capacity)
+{
+    auto ring = std::make_unique<shm_log_ring>(shm_log_ring::create(name, capacity));
+
+    std::lock_guard lock(_connections_mut);
+    _listeners.emplace_back(&server::drain_shm, this, std::move(ring));
+}
+
+void server::drain_shm(std::unique_ptr<shm_log_ring> ring)
+{
+    std::string payload;
+    size_t idle = 0;
+
+    while (true)
+    {
+        try
+        {
+            if (ring->pop(payload))
+            {
+                idle = 0;
+                handle_payload(payload);
+                continue;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Rejected log records: " << e.what() << std::endl;
+            continue;
+        }
+
+        if (_transports_stopped)
+        {
+            return;
+        }
+
+        // Spin briefly to keep latency low under load, then back off so an idle collector does not burn a core
+        if (++idle < 64)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+}
+
+void server::stop_transports()
+{
+    {
+        std::lock_guard lock(_connections_mut);
+        if (_transports_stopped.exchange(true))
+        {
+            return;
+        }
+
+#ifndef _WIN32
+        if (_unix_fd != -1)
+        {
+            ::shutdown(_unix_fd, SHUT_RDWR);
+        }
+        // Receivers still handle what is queued, then see the end of the connection
+        for (auto& [connection, receiver] : _receivers)
+        {
+            ::shutdown(connection, SHUT_RD);
+        }
+#endif
+    }
+
+    // No new listener threads can be started once _transports_stopped is set
+    for (auto& listener : _listeners)
+    {
+        listener.join();
+    }
+    _listeners.clear();
+
+    std::vector<std::thread> receivers;
+    {
+        std::lock_guard lock(_connections_mut);
+        for (auto& [connection, receiver] : _receivers)
+        {
+            receivers.push_back(std::move(receiver));
+        }
+        _receivers.clear();
+        std::move(_retired.begin(), _retired.end(), std::back_inserter(receivers));
+        _retired.clear();
+    }
+
+    for (auto& receiver : receivers)
+    {
+        receiver.join();
+    }
+
+#ifndef _WIN32
+    if (_unix_fd != -1)
+    {
+        ::close(_unix_fd);
+        ::unlink(_unix_path.c_str());
+        _unix_fd = -1;
+    }
+#endif
+}
+
+server::~server() noexcept
+{
+    stop_transports();
+}
@@ -10,26 +10,121 @@
 #include <logger.h>
 #include <mutex>
 #include <shared_mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <atomic>
 #include <nlohmann/json.hpp>
+#include <shm_log_ring.h>
 
 class server
 {
+    /** Owns one log file: the file stays open for the whole server lifetime,
+     *  handlers only enqueue lines and a dedicated thread writes them in batches.
+     */
+    class file_writer final
+    {
+        std::ofstream _stream;
+
+        std::mutex _mut;
+        std::condition_variable _cv;
+        std::vector<std::string> _pending;
+        bool _stopped = false;
+
+        std::thread _worker;
+
+        void work();
+
+    public:
+
+        explicit file_writer(const std::string& path);
+
+        file_writer(const file_writer&) = delete;
+        file_writer& operator=(const file_writer&) = delete;
+
+        void push(std::string line);
+
+        ~file_writer() noexcept;
+    };
+
     crow::SimpleApp app;
 
-    std::unordered_map<int, std::unordered_map<logger::severity, std::pair<std::string, bool>>> _streams;
+    uint16_t _port;
+    uint16_t _concurrency;
+
+    std::unordered_map<std::string, std::unique_ptr<file_writer>> _writers;
+
+    std::shared_mutex _writers_mut;
+
+    std::mutex _console_mut;
+
+    std::atomic<bool> _transports_stopped = false;
+
+    std::vector<std::thread> _listeners;
+
+    std::string _unix_path;
+    int _unix_fd = -1;
 
-    std::mutex  _mut;
+    std::mutex _connections_mut;
+    std::unordered_map<int, std::thread> _receivers; // by connection
+    std::vector<std::thread> _retired; // receivers that have closed their connection, joined by the next accept
+
+    file_writer& get_writer(const std::string& path);
+
+    void accept_unix();
+
+    /** Closes the connection once the client does or the transports stop
+     */
+    void receive_unix(int connection);
+
+    /** Handles records until the connection is closed or shut down for reading
+     */
+    void drain_unix(int connection);
+
+    void drain_shm(std::unique_ptr<shm_log_ring> ring);
+
+    /** Parses and dispatches one record received outside of HTTP, reporting malformed ones on stderr
+     */
+    void handle_payload(const std::string& payload);
+
+    /** Dispatches one record of the server_logger payload; throws json::exception on malformed input
+     */
+    void handle_record(const nlohmann::json& record);
+
+    static logger::severity parse_severity(const std::string& severity_str);
 
 public:
 
-    explicit server(uint16_t port = 9200);
+    explicit server(uint16_t port = 9200, uint16_t concurrency = std::thread::hardware_concurrency());
+
+    /** Blocks until stop() is called
+     */
+    void run();
+
+    void wait_for_start();
+
+    void stop();
+
+    /** Additionally collects records sent to "unix://path"; safe to call before run()
+     */
+    void listen_unix(const std::string& path);
+
+    /** Additionally collects records sent to "shm://name"; safe to call before run()
+     */
+    void listen_shm(const std::string& name, size_t capacity = shm_log_ring::default_capacity);
+
+    /** Stops the unix socket and shared memory listeners after draining what was already sent
+     */
+    void stop_transports();
 
     server(const server&) = delete;
     server& operator=(const server&) = delete;
     server(server&&) noexcept = delete;
     server& operator=(server&&) noexcept = delete;
-    ~server() noexcept = default;
+    ~server() noexcept;
 };
 
 
-#endif //MP_OS_SERVER_H
\ No newline at end of file
+#endif //MP_OS_SERVER_H
@@ -0,0 +1,106 @@
+#include "server.h"
+#define CPPHTTPLIB_NO_COMPRESSION
+#include <httplib.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// usage: mp_os_lggr_srvr_load_test [clients = 64] [requests per client = 2000] [records per request = 1]
+int main(int argc, char* argv[])
+{
+    const size_t clients = argc > 1 ? std::stoul(argv[1]) : 64;
+    const size_t requests = argc > 2 ? std::stoul(argv[2]) : 2000;
+    const size_t batch = argc > 3 ? std::max<size_t>(std::stoul(argv[3]), 1) : 1;
+
+    constexpr uint16_t port = 9301;
+
+    server s(port);
+    std::thread server_thread([&s] { s.run(); });
+    s.wait_for_start();
+
+    nlohmann::json record = {
+        {"pid", 0},
+        {"severity", "INFO"},
+        {"message", "load test message with some payload to make it look like a real log line"},
+        {"streams", {{{"type", "file"}, {"path", "load_test.log"}}}}
+    };
+
+    std::string body;
+    std::string path;
+    if (batch == 1)
+    {
+        body = record.dump();
+        path = "/log";
+    }
+    else
+    {
+        body = nlohmann::json(std::vector<nlohmann::json>(batch, record)).dump();
+        path = "/log/batch";
+    }
+
+    std::vector<std::vector<double>> latencies(clients);
+    std::vector<size_t> failures(clients, 0);
+    std::vector<std::thread> workers;
+    workers.reserve(clients);
+
+    auto started = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < clients; ++i)
+    {
+        workers.emplace_back([&, i] {
+            httplib::Client client("127.0.0.1", port);
+            client.set_keep_alive(true);
+            latencies[i].reserve(requests);
+
+            for (size_t j = 0; j < requests; ++j)
+            {
+                auto begin = std::chrono::steady_clock::now();
+                auto res = client.Post(path, body, "application/json");
+                auto end = std::chrono::steady_clock::now();
+
+                if (!res || res->status != 200)
+                {
+                    ++failures[i];
+                }
+                latencies[i].push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+            }
+        });
+    }
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    s.stop();
+    server_thread.join();
+
+    std::vector<double> all;
+    size_t failed = 0;
+    for (size_t i = 0; i < clients; ++i)
+    {
+        all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+        failed += failures[i];
+    }
+    std::sort(all.begin(), all.end());
+
+    auto percentile = [&all](double p) {
+        return all.empty() ? 0.0 : all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))];
+    };
+
+    std::cout << "clients:          " << clients << '\n'
+              << "requests:         " << all.size() << " (" << failed << " failed)\n"
+              << "records/request:  " << batch << '\n'
+              << "requests/s:       " << all.size() / elapsed << '\n'
+              << "records/s:        " << all.size() * batch / elapsed << '\n'
+              << "latency p50, us:  " << percentile(0.50) << '\n'
+              << "latency p99, us:  " << percentile(0.99) << '\n'
+              << "latency max, us:  " << (all.empty() ? 0.0 : all.back()) << std::endl;
+
+    return failed == 0 ? 0 : 1;
+}
@@ -1,8 +1,181 @@
 #include "server.h"
 #include <server_logger_builder.h>
+#include <gtest/gtest.h>
+#include <filesystem>
 
-int main()
+namespace
 {
+    std::vector<std::string> read_lines(const std::string& path)
+    {
+        std::vector<std::string> lines;
+        std::ifstream file(path);
+        for (std::string line; std::getline(file, line);)
+        {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    void log_through(const std::string& destination, const std::string& path, int count)
+    {
+        server_logger_builder builder;
+        builder.set_destination(destination);
+        builder.set_format("%m");
+        builder.add_file_stream(path, logger::severity::information);
+
+        std::unique_ptr<logger> log(builder.build());
+        for (int i = 0; i < count; ++i)
+        {
+            log->information("record " + std::to_string(i));
+        }
+    }
+}
+
+TEST(server_logger_tests, unix_socket_transport_delivers_records)
+{
+    std::filesystem::remove("unix_transport_test.log");
+
+    {
+        server s(9210);
+        s.listen_unix("/tmp/mp_os_lggr_test.sock");
+
+        log_through("unix:///tmp/mp_os_lggr_test.sock", "unix_transport_test.log", 100);
+    }
+
+    auto lines = read_lines("unix_transport_test.log");
+    ASSERT_EQ(lines.size(), 100);
+    EXPECT_EQ(lines.front(), "record 0");
+    EXPECT_EQ(lines.back(), "record 99");
+
+    std::filesystem::remove("unix_transport_test.log");
+}
+
+TEST(server_logger_tests, unix_socket_connections_are_closed_by_clients)
+{
+    const auto open_sockets = [] {
+        size_t count = 0;
+        for (const auto& descriptor : std::filesystem::directory_iterator("/proc/self/fd"))
+        {
+            std::error_code ec;
+            count += std::filesystem::read_symlink(descriptor.path(), ec).string().starts_with("socket:");
+        }
+        return count;
+    };
+
+    std::filesystem::remove("unix_connections_test.log");
+
+    {
+        server s(9212);
+        s.listen_unix("/tmp/mp_os_lggr_connections_test.sock");
+        const auto listening = open_sockets();
+
+        for (int i = 0; i < 50; ++i)
+        {
+            log_through("unix:///tmp/mp_os_lggr_connections_test.sock", "unix_connections_test.log", 1);
+        }
+
+        // The collector sees each logger disconnect on its own receiver thread
+        for (int i = 0; i < 200 && open_sockets() > listening; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        EXPECT_LE(open_sockets(), listening);
+    }
+
+    EXPECT_EQ(read_lines("unix_connections_test.log").size(), 50);
+
+    std::filesystem::remove("unix_connections_test.log");
+}
+
+TEST(server_logger_tests, shared_memory_transport_delivers_records)
+{
+    std::filesystem::remove("shm_transport_test.log");
+
+    {
+        server s(9211);
+        s.listen_shm("mp_os_lggr_test", 1 << 16);
+
+        // Small ring: the collector has to keep draining while the logger wraps around it
+        log_through("shm://mp_os_lggr_test", "shm_transport_test.log", 2000);
+    }
+
+    auto lines = read_lines("shm_transport_test.log");
+    ASSERT_EQ(lines.size(), 2000);
+    EXPECT_EQ(lines.front(), "record 0");
+    EXPECT_EQ(lines.back(), "record 1999");
+
+    std::filesystem::remove("shm_transport_test.log");
+}
+
+TEST(server_logger_tests, shared_memory_transport_follows_restarted_collector)
+{
+    std::filesystem::remove("shm_restart_test.log");
+
+    server_logger_builder builder;
+    builder.set_destination("shm://mp_os_lggr_restart_test");
+    builder.set_format("%m");
+    builder.add_file_stream("shm_restart_test.log", logger::severity::information);
+    std::unique_ptr<logger> log(builder.build());
+
+    for (int run = 0; run < 2; ++run)
+    {
+        server s(9213);
+        s.listen_shm("mp_os_lggr_restart_test", 1 << 16);
+
+        for (int i = 0; i < 10; ++i)
+        {
+            log->information("record " + std::to_string(run * 10 + i));
+        }
+    }
+
+    {
+        // A crashed collector leaves its segment mapped without marking it closed; its record is lost
+        auto crashed = shm_log_ring::create("mp_os_lggr_restart_test", 1 << 16);
+        log->information("record lost with the crashed collector");
+
+        server s(9214);
+        s.listen_shm("mp_os_lggr_restart_test", 1 << 16);
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        log->information("record 20");
+    }
+
+    auto lines = read_lines("shm_restart_test.log");
+    ASSERT_EQ(lines.size(), 21);
+    EXPECT_EQ(lines[10], "record 10");
+    EXPECT_EQ(lines.back(), "record 20");
+
+    std::filesystem::remove("shm_restart_test.log");
+}
+
+TEST(server_logger_tests, shared_memory_ring_rejects_corrupted_length)
+{
+    auto consumer = shm_log_ring::create("mp_os_lggr_corrupt_test", 4096);
+    auto producer = shm_log_ring::open("mp_os_lggr_corrupt_test");
+    ASSERT_TRUE(producer.push("first"));
+
+    // Overwrite the length of the record with one larger than the ring, as a misbehaving producer could
+    int fd = shm_open("/mp_os_lggr_corrupt_test", O_RDWR, 0);
+    ASSERT_NE(fd, -1);
+    void* mapping = mmap(nullptr, sizeof(shm_log_ring::header) + 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    ASSERT_NE(mapping, MAP_FAILED);
+    const uint32_t length = 1 << 20;
+    std::memcpy(static_cast<char*>(mapping) + sizeof(shm_log_ring::header), &length, sizeof(length));
+    munmap(mapping, sizeof(shm_log_ring::header) + 4096);
+
+    std::string record;
+    EXPECT_THROW(consumer.pop(record), std::runtime_error);
+    EXPECT_FALSE(consumer.pop(record));
+
+    ASSERT_TRUE(producer.push("second"));
+    ASSERT_TRUE(consumer.pop(record));
+    EXPECT_EQ(record, "second");
+}
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+
 
 
     server_logger_builder builder;
@@ -17,4 +190,6 @@ int main()
 
     log->trace("IT is a very long strange message !!!!!!!!!!%%%%%%%%\tzdtjhdjh").
 		information("bfldknbpxjxjvpxvjbpzjbpsjbpsjkgbpsejegpsjpegesjpvbejpvjzepvgjs");
+
+    return RUN_ALL_TESTS();
 }
\ No newline at end of file
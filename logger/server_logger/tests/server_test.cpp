@@ -2,8 +2,24 @@
 // Created by Des Caldnd on 3/27/2024.
 //
 #include "server.h"
+#include <string>
 
+// usage: serv_test [port = 9200] [concurrency = hardware threads] [unix socket path] [shared memory name]
 int main(int argc, char* argv[])
 {
-    server s;
-}
\ No newline at end of file
+    uint16_t port = argc > 1 ? static_cast<uint16_t>(std::stoul(argv[1])) : 9200;
+    uint16_t concurrency = argc > 2 ? static_cast<uint16_t>(std::stoul(argv[2])) : std::thread::hardware_concurrency();
+
+    server s(port, concurrency);
+
+    if (argc > 3 && argv[3][0] != '\0')
+    {
+        s.listen_unix(argv[3]);
+    }
+    if (argc > 4)
+    {
+        s.listen_shm(argv[4]);
+    }
+
+    s.run();
+}